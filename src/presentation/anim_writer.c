@@ -0,0 +1,667 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>   // deflate and crc32 for the APNG chunks
+#ifdef _OPENMP
+#include <omp.h>    // Frames of a batch are encoded in parallel
+#endif
+#include "anim_writer.h"
+
+#define ANIM_BATCH_FRAMES 32   // Frames buffered before a parallel encode pass
+#define LZW_HASH_SIZE 5003     // Prime table size for the LZW string dictionary
+#define LZW_MAX_CODE 4095      // GIF codes are at most 12 bits wide
+
+// Define a growable byte buffer holding one encoded frame
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+// Define the sub-rectangle of the canvas that changed since the previous frame
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} Rect;
+
+struct AnimWriter {
+    FILE* file;
+    AnimFormat format;
+    int width;
+    int height;
+    int delay_ms;
+
+    Color palette[256];            // Global palette shared by every frame
+    int palette_size;
+    unsigned char* color_lookup;   // 15-bit RGB -> palette index, built once
+
+    int batch_count;                      // Frames currently queued
+    unsigned char* batch_rgba;            // Queued RGBA frames
+    unsigned char* batch_indices;         // Slot 0 = last frame of the previous batch
+    ByteBuffer encoded[ANIM_BATCH_FRAMES];  // APNG frames keep 4 bytes in front for the fdAT sequence
+    ByteBuffer scanlines[ANIM_BATCH_FRAMES];  // APNG filtered rows; both are reused by every batch
+    Rect rects[ANIM_BATCH_FRAMES];
+    int delays[ANIM_BATCH_FRAMES];        // Display time of each queued frame in milliseconds
+
+    int frames_written;     // Frames already assembled into the file
+    unsigned int sequence;  // APNG fcTL/fdAT sequence number
+    long actl_offset;       // Where the APNG frame count is patched on close
+
+    z_stream* streams;      // One reusable deflate context per thread
+    int num_streams;
+    int failed;
+};
+
+// Function to make sure a byte buffer can take `extra` more bytes
+static int byte_buffer_reserve(ByteBuffer* buffer, size_t extra)
+{
+    if (buffer->length + extra <= buffer->capacity) {
+        return 0;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra) {
+        capacity *= 2;
+    }
+    unsigned char* grown = (unsigned char*) realloc(buffer->data, capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+// Function to append raw bytes to a byte buffer
+static int byte_buffer_append(ByteBuffer* buffer, const void* bytes, size_t count)
+{
+    if (byte_buffer_reserve(buffer, count) == -1) {
+        return -1;
+    }
+    memcpy(buffer->data + buffer->length, bytes, count);
+    buffer->length += count;
+    return 0;
+}
+
+// Function to build the global palette and the color lookup table once per run
+static int build_palette(AnimWriter* writer, const Color* colors, int num_colors)
+{
+    if (num_colors > 0 && num_colors <= 256) {
+        // Small color sets (background + paints) are kept exactly
+        for (int i = 0; i < num_colors; i++) {
+            writer->palette[i] = colors[i];
+        }
+        writer->palette_size = num_colors;
+    } else {
+        // Otherwise fall back to a uniform 6x6x6 color cube
+        int n = 0;
+        for (int r = 0; r < 6; r++)
+            for (int g = 0; g < 6; g++)
+                for (int b = 0; b < 6; b++) {
+                    Color c = { (unsigned char)(r * 51), (unsigned char)(g * 51), (unsigned char)(b * 51), 255 };
+                    writer->palette[n++] = c;
+                }
+        writer->palette_size = n;
+    }
+    for (int i = writer->palette_size; i < 256; i++) {
+        Color black = { 0, 0, 0, 255 };
+        writer->palette[i] = black;
+    }
+
+    // Map every 5-5-5 RGB bucket to its nearest palette entry
+    writer->color_lookup = (unsigned char*) malloc(32768);
+    if (writer->color_lookup == NULL) {
+        return -1;
+    }
+    for (int key = 0; key < 32768; key++) {
+        int r = ((key >> 10) & 31) * 255 / 31;
+        int g = ((key >> 5) & 31) * 255 / 31;
+        int b = (key & 31) * 255 / 31;
+        int best = 0, best_distance = 1 << 30;
+        for (int i = 0; i < writer->palette_size; i++) {
+            int dr = r - writer->palette[i].r;
+            int dg = g - writer->palette[i].g;
+            int db = b - writer->palette[i].b;
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = i;
+            }
+        }
+        writer->color_lookup[key] = (unsigned char)best;
+    }
+    return 0;
+}
+
+// Function to convert one RGBA frame to palette indices
+static void quantize_frame(const AnimWriter* writer, const unsigned char* rgba, unsigned char* indices)
+{
+    size_t num_pixels = (size_t)writer->width * writer->height;
+    for (size_t i = 0; i < num_pixels; i++) {
+        const unsigned char* p = rgba + i * 4;
+        indices[i] = writer->color_lookup[((p[0] >> 3) << 10) | ((p[1] >> 3) << 5) | (p[2] >> 3)];
+    }
+}
+
+// Function to find the smallest rectangle containing every pixel that changed
+static Rect changed_rect(const unsigned char* previous, const unsigned char* current, int width, int height)
+{
+    int top = 0, bottom = height - 1;
+    while (top < height && memcmp(previous + (size_t)top * width, current + (size_t)top * width, width) == 0) {
+        top++;
+    }
+    if (top == height) {
+        Rect unchanged = { 0, 0, 1, 1 };  // Formats need at least one pixel per frame
+        return unchanged;
+    }
+    while (bottom > top && memcmp(previous + (size_t)bottom * width, current + (size_t)bottom * width, width) == 0) {
+        bottom--;
+    }
+
+    int left = width - 1, right = 0;
+    for (int y = top; y <= bottom; y++) {
+        const unsigned char* a = previous + (size_t)y * width;
+        const unsigned char* b = current + (size_t)y * width;
+        int x = 0;
+        while (x < left && a[x] == b[x]) x++;
+        if (x < left) left = x;
+        x = width - 1;
+        while (x > right && a[x] == b[x]) x--;
+        if (x > right) right = x;
+    }
+    if (right < left) {
+        right = left;
+    }
+    Rect rect = { left, top, right - left + 1, bottom - top + 1 };
+    return rect;
+}
+
+// Define the state of the GIF LZW bit packer
+typedef struct {
+    ByteBuffer* out;
+    unsigned int bit_buffer;
+    int bit_count;
+    unsigned char block[255];  // GIF data sub-block being filled
+    int block_length;
+    int failed;
+} LzwPacker;
+
+// Function to emit the current sub-block with its length prefix
+static void lzw_flush_block(LzwPacker* packer)
+{
+    if (packer->block_length == 0) {
+        return;
+    }
+    unsigned char length = (unsigned char)packer->block_length;
+    if (byte_buffer_append(packer->out, &length, 1) == -1 ||
+        byte_buffer_append(packer->out, packer->block, packer->block_length) == -1) {
+        packer->failed = 1;
+    }
+    packer->block_length = 0;
+}
+
+// Function to write one variable-width code, least significant bit first
+static void lzw_write_code(LzwPacker* packer, int code, int code_size)
+{
+    packer->bit_buffer |= (unsigned int)code << packer->bit_count;
+    packer->bit_count += code_size;
+    while (packer->bit_count >= 8) {
+        packer->block[packer->block_length++] = (unsigned char)(packer->bit_buffer & 0xFF);
+        packer->bit_buffer >>= 8;
+        packer->bit_count -= 8;
+        if (packer->block_length == 255) {
+            lzw_flush_block(packer);
+        }
+    }
+}
+
+// Function to LZW-compress the pixels of one rectangle as GIF image data
+static int gif_encode_pixels(ByteBuffer* out, const unsigned char* indices, int stride, Rect rect)
+{
+    const int min_code_size = 8;
+    const int clear_code = 1 << min_code_size;
+    int keys[LZW_HASH_SIZE];
+    short codes[LZW_HASH_SIZE];
+    LzwPacker packer = { out, 0, 0, {0}, 0, 0 };
+
+    unsigned char code_size_byte = (unsigned char)min_code_size;
+    if (byte_buffer_append(out, &code_size_byte, 1) == -1) {
+        return -1;
+    }
+
+    memset(keys, -1, sizeof(keys));
+    int code_size = min_code_size + 1;
+    int max_code = clear_code + 1;
+    int current = -1;
+    lzw_write_code(&packer, clear_code, code_size);
+
+    for (int y = 0; y < rect.height; y++) {
+        const unsigned char* row = indices + (size_t)(rect.y + y) * stride + rect.x;
+        for (int x = 0; x < rect.width; x++) {
+            int value = row[x];
+            if (current < 0) {
+                current = value;
+                continue;
+            }
+
+            // Look for the string (current + value) in the dictionary
+            int key = (current << 8) | value;
+            int slot = key % LZW_HASH_SIZE;
+            while (keys[slot] != -1 && keys[slot] != key) {
+                slot = (slot + 1) % LZW_HASH_SIZE;
+            }
+            if (keys[slot] == key) {
+                current = codes[slot];
+                continue;
+            }
+
+            // Not found: emit the longest known string and add the new one
+            lzw_write_code(&packer, current, code_size);
+            keys[slot] = key;
+            codes[slot] = (short)++max_code;
+            if (max_code >= (1 << code_size) && code_size < 12) {
+                code_size++;
+            }
+            if (max_code == LZW_MAX_CODE) {
+                lzw_write_code(&packer, clear_code, code_size);
+                memset(keys, -1, sizeof(keys));
+                code_size = min_code_size + 1;
+                max_code = clear_code + 1;
+            }
+            current = value;
+        }
+    }
+
+    // The decoder adds one more entry when it reads the last code
+    lzw_write_code(&packer, current, code_size);
+    if (max_code + 1 >= (1 << code_size) && code_size < 12) {
+        code_size++;
+    }
+    lzw_write_code(&packer, clear_code + 1, code_size);
+    if (packer.bit_count > 0) {
+        packer.block[packer.block_length++] = (unsigned char)(packer.bit_buffer & 0xFF);
+    }
+    lzw_flush_block(&packer);
+
+    unsigned char terminator = 0;
+    if (packer.failed || byte_buffer_append(out, &terminator, 1) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+// Function to encode one GIF frame (control extension, descriptor and image data)
+static int gif_encode_frame(const AnimWriter* writer, ByteBuffer* out, const unsigned char* indices, Rect rect,
+                            int delay_ms)
+{
+    int delay = (delay_ms + 5) / 10;  // GIF delays are in hundredths of a second
+    unsigned char header[18] = {
+        0x21, 0xF9, 0x04, 0x04,              // Graphic control: keep previous pixels outside the rectangle
+        (unsigned char)(delay & 0xFF), (unsigned char)(delay >> 8), 0x00, 0x00,
+        0x2C,                                // Image descriptor
+        (unsigned char)(rect.x & 0xFF), (unsigned char)(rect.x >> 8),
+        (unsigned char)(rect.y & 0xFF), (unsigned char)(rect.y >> 8),
+        (unsigned char)(rect.width & 0xFF), (unsigned char)(rect.width >> 8),
+        (unsigned char)(rect.height & 0xFF), (unsigned char)(rect.height >> 8),
+        0x00                                 // No local color table
+    };
+    out->length = 0;
+    if (byte_buffer_append(out, header, sizeof(header)) == -1) {
+        return -1;
+    }
+    return gif_encode_pixels(out, indices, writer->width, rect);
+}
+
+// Function to deflate one APNG frame's filtered scanlines with this thread's stream. The data
+// starts 4 bytes into out, where write_frame puts the fdAT sequence number
+static int apng_encode_frame(const AnimWriter* writer, z_stream* stream, ByteBuffer* out, ByteBuffer* scanlines,
+                             const unsigned char* indices, Rect rect)
+{
+    size_t raw_length = (size_t)(rect.width + 1) * rect.height;
+    scanlines->length = 0;
+    if (byte_buffer_reserve(scanlines, raw_length) == -1) {
+        return -1;
+    }
+    unsigned char* raw = scanlines->data;
+    // Each scanline is prefixed with filter type 0 (none), the usual choice for indexed images
+    for (int y = 0; y < rect.height; y++) {
+        unsigned char* line = raw + (size_t)y * (rect.width + 1);
+        line[0] = 0;
+        memcpy(line + 1, indices + (size_t)(rect.y + y) * writer->width + rect.x, rect.width);
+    }
+
+    out->length = 0;
+    if (deflateReset(stream) != Z_OK || byte_buffer_reserve(out, 4 + deflateBound(stream, raw_length)) == -1) {
+        return -1;
+    }
+    stream->next_in = raw;
+    stream->avail_in = (uInt)raw_length;
+    stream->next_out = out->data + 4;
+    stream->avail_out = (uInt)(out->capacity - 4);
+    int status = deflate(stream, Z_FINISH);
+    out->length = out->capacity - stream->avail_out;
+    return status == Z_STREAM_END ? 0 : -1;
+}
+
+// Function to write a 32-bit big-endian value
+static void put_u32(unsigned char* p, unsigned int value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+// Function to append bytes to the file; a short write (a full disk) marks the writer as failed
+static void write_bytes(AnimWriter* writer, const void* data, size_t length)
+{
+    if (!writer->failed && fwrite(data, 1, length, writer->file) != length) {
+        printf("Error: Could not write the animation file\n");
+        writer->failed = 1;
+    }
+}
+
+// Function to write one PNG chunk (length, type, data, CRC)
+static void png_write_chunk(AnimWriter* writer, const char* type, const unsigned char* data, unsigned int length)
+{
+    unsigned char header[8];
+    unsigned char footer[4];
+    put_u32(header, length);
+    memcpy(header + 4, type, 4);
+    uLong crc = crc32(0L, (const Bytef*)type, 4);
+    if (length > 0) {
+        crc = crc32(crc, data, length);
+    }
+    put_u32(footer, (unsigned int)crc);
+    write_bytes(writer, header, 8);
+    if (length > 0) {
+        write_bytes(writer, data, length);
+    }
+    write_bytes(writer, footer, 4);
+}
+
+// Function to write the file header, global palette and looping information
+static void write_header(AnimWriter* writer)
+{
+    if (writer->format == ANIM_GIF) {
+        unsigned char screen[13] = {
+            'G', 'I', 'F', '8', '9', 'a',
+            (unsigned char)(writer->width & 0xFF), (unsigned char)(writer->width >> 8),
+            (unsigned char)(writer->height & 0xFF), (unsigned char)(writer->height >> 8),
+            0xF7, 0x00, 0x00                 // Global color table of 256 entries
+        };
+        write_bytes(writer, screen, sizeof(screen));
+        for (int i = 0; i < 256; i++) {
+            unsigned char rgb[3] = { writer->palette[i].r, writer->palette[i].g, writer->palette[i].b };
+            write_bytes(writer, rgb, 3);
+        }
+        static const unsigned char loop[19] = {
+            0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+            0x03, 0x01, 0x00, 0x00, 0x00     // Loop forever
+        };
+        write_bytes(writer, loop, sizeof(loop));
+        return;
+    }
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    write_bytes(writer, signature, 8);
+
+    unsigned char ihdr[13];
+    put_u32(ihdr, writer->width);
+    put_u32(ihdr + 4, writer->height);
+    ihdr[8] = 8;   // Bit depth
+    ihdr[9] = 3;   // Indexed color, using the global palette
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    png_write_chunk(writer, "IHDR", ihdr, sizeof(ihdr));
+
+    // The frame count is not known yet; it is patched in anim_writer_close
+    unsigned char actl[8];
+    put_u32(actl, 0);
+    put_u32(actl + 4, 0);  // Loop forever
+    writer->actl_offset = ftell(writer->file);
+    png_write_chunk(writer, "acTL", actl, sizeof(actl));
+
+    unsigned char plte[768];
+    for (int i = 0; i < writer->palette_size; i++) {
+        plte[i * 3] = writer->palette[i].r;
+        plte[i * 3 + 1] = writer->palette[i].g;
+        plte[i * 3 + 2] = writer->palette[i].b;
+    }
+    png_write_chunk(writer, "PLTE", plte, writer->palette_size * 3);
+}
+
+// Function to append one encoded frame to the file, in frame order
+static void write_frame(AnimWriter* writer, ByteBuffer* encoded, Rect rect, int delay_ms)
+{
+    if (writer->format == ANIM_GIF) {
+        write_bytes(writer, encoded->data, encoded->length);
+        return;
+    }
+
+    unsigned char fctl[26];
+    put_u32(fctl, writer->sequence++);
+    put_u32(fctl + 4, rect.width);
+    put_u32(fctl + 8, rect.height);
+    put_u32(fctl + 12, rect.x);
+    put_u32(fctl + 16, rect.y);
+    fctl[20] = (unsigned char)(delay_ms >> 8);
+    fctl[21] = (unsigned char)delay_ms;
+    fctl[22] = 1000 >> 8;  // Delay denominator: milliseconds
+    fctl[23] = 1000 & 0xFF;
+    fctl[24] = 0;          // APNG_DISPOSE_OP_NONE: keep pixels outside the rectangle
+    fctl[25] = 0;          // APNG_BLEND_OP_SOURCE
+    png_write_chunk(writer, "fcTL", fctl, sizeof(fctl));
+
+    if (writer->frames_written == 0) {
+        png_write_chunk(writer, "IDAT", encoded->data + 4, (unsigned int)encoded->length - 4);
+        return;
+    }
+
+    // Later frames carry their own sequence number in front of the compressed data
+    put_u32(encoded->data, writer->sequence++);
+    png_write_chunk(writer, "fdAT", encoded->data, (unsigned int)encoded->length);
+}
+
+// Function to encode the queued batch in parallel and assemble it in order
+static int flush_batch(AnimWriter* writer)
+{
+    int count = writer->batch_count;
+    size_t frame_pixels = (size_t)writer->width * writer->height;
+    int failed = 0;
+
+    // Map every queued frame to the global palette
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; i++) {
+        quantize_frame(writer, writer->batch_rgba + i * frame_pixels * 4,
+                       writer->batch_indices + (i + 1) * frame_pixels);
+    }
+
+    // Diff against the previous frame and compress only the changed rectangle
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (int i = 0; i < count; i++) {
+        const unsigned char* previous = writer->batch_indices + i * frame_pixels;
+        const unsigned char* current = writer->batch_indices + (i + 1) * frame_pixels;
+        Rect rect = { 0, 0, writer->width, writer->height };
+        if (writer->frames_written + i > 0) {
+            rect = changed_rect(previous, current, writer->width, writer->height);
+        }
+        writer->rects[i] = rect;
+
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        int status;
+        if (writer->format == ANIM_GIF) {
+            status = gif_encode_frame(writer, &writer->encoded[i], current, rect, writer->delays[i]);
+        } else {
+            status = apng_encode_frame(writer, &writer->streams[thread], &writer->encoded[i], &writer->scanlines[i],
+                                       current, rect);
+        }
+        failed |= (status != 0);
+    }
+    if (failed) {
+        printf("Error: Could not encode animation frames\n");
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        write_frame(writer, &writer->encoded[i], writer->rects[i], writer->delays[i]);
+        writer->frames_written++;
+    }
+
+    // Keep the last frame so the next batch can diff against it
+    memcpy(writer->batch_indices, writer->batch_indices + count * frame_pixels, frame_pixels);
+    writer->batch_count = 0;
+    return writer->failed ? -1 : 0;
+}
+
+// Function to release everything owned by the writer
+static void free_writer(AnimWriter* writer)
+{
+    for (int i = 0; i < writer->num_streams; i++) {
+        deflateEnd(&writer->streams[i]);
+    }
+    for (int i = 0; i < ANIM_BATCH_FRAMES; i++) {
+        free(writer->encoded[i].data);
+        free(writer->scanlines[i].data);
+    }
+    free(writer->streams);
+    free(writer->color_lookup);
+    free(writer->batch_rgba);
+    free(writer->batch_indices);
+    free(writer);
+}
+
+// Function to open an animation file and prepare the shared encoder state
+AnimWriter* anim_writer_open(const char* filename, AnimFormat format, int width, int height,
+                             const Color* colors, int num_colors, int delay_ms)
+{
+    AnimWriter* writer = (AnimWriter*) calloc(1, sizeof(AnimWriter));
+    if (writer == NULL) {
+        printf("Error: Could not allocate animation writer\n");
+        return NULL;
+    }
+    writer->format = format;
+    writer->width = width;
+    writer->height = height;
+    writer->delay_ms = delay_ms;
+
+    size_t frame_pixels = (size_t)width * height;
+    writer->batch_rgba = (unsigned char*) malloc(frame_pixels * 4 * ANIM_BATCH_FRAMES);
+    writer->batch_indices = (unsigned char*) malloc(frame_pixels * (ANIM_BATCH_FRAMES + 1));
+    if (writer->batch_rgba == NULL || writer->batch_indices == NULL || build_palette(writer, colors, num_colors) == -1) {
+        printf("Error: Could not allocate animation frame buffers\n");
+        free_writer(writer);
+        return NULL;
+    }
+
+    if (format == ANIM_APNG) {
+        writer->num_streams = 1;
+#ifdef _OPENMP
+        writer->num_streams = omp_get_max_threads();
+#endif
+        writer->streams = (z_stream*) calloc(writer->num_streams, sizeof(z_stream));
+        if (writer->streams == NULL) {
+            writer->num_streams = 0;
+            free_writer(writer);
+            return NULL;
+        }
+        for (int i = 0; i < writer->num_streams; i++) {
+            if (deflateInit(&writer->streams[i], Z_DEFAULT_COMPRESSION) != Z_OK) {
+                printf("Error: Could not initialize deflate stream\n");
+                writer->num_streams = i;
+                free_writer(writer);
+                return NULL;
+            }
+        }
+    }
+
+    // Every batch slot is sized for a whole changed canvas up front, so encoding never allocates:
+    // LZW spends at most 12 bits a pixel, deflate stays within its bound of the filtered rows
+    size_t raw_length = (size_t)(width + 1) * height;
+    for (int i = 0; i < ANIM_BATCH_FRAMES; i++) {
+        size_t encoded_bound = (format == ANIM_GIF) ? frame_pixels * 2 + 4096
+                                                    : 4 + deflateBound(&writer->streams[0], raw_length);
+        if (byte_buffer_reserve(&writer->encoded[i], encoded_bound) == -1 ||
+            (format == ANIM_APNG && byte_buffer_reserve(&writer->scanlines[i], raw_length) == -1)) {
+            printf("Error: Could not allocate animation frame buffers\n");
+            free_writer(writer);
+            return NULL;
+        }
+    }
+
+    writer->file = fopen(filename, "wb");
+    if (writer->file == NULL) {
+        printf("Error: Could not open file %s for writing\n", filename);
+        free_writer(writer);
+        return NULL;
+    }
+    write_header(writer);
+    if (writer->failed) {
+        fclose(writer->file);
+        free_writer(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+// Function to queue one frame, encoding the batch once it is full
+int anim_writer_add_frame(AnimWriter* writer, const unsigned char* rgba)
+{
+    return anim_writer_add_frame_timed(writer, rgba, writer->delay_ms);
+}
+
+// Function to queue one frame with its own display time
+int anim_writer_add_frame_timed(AnimWriter* writer, const unsigned char* rgba, int delay_ms)
+{
+    size_t frame_bytes = (size_t)writer->width * writer->height * 4;
+    memcpy(writer->batch_rgba + writer->batch_count * frame_bytes, rgba, frame_bytes);
+    // Both formats store the delay in 16 bits (GIF in hundredths of a second, APNG in milliseconds)
+    writer->delays[writer->batch_count] = delay_ms < 0 ? 0 : delay_ms > 65535 ? 65535 : delay_ms;
+    writer->batch_count++;
+    if (writer->batch_count == ANIM_BATCH_FRAMES) {
+        return flush_batch(writer);
+    }
+    return 0;
+}
+
+// Function to encode the remaining frames and finish the animation file
+int anim_writer_close(AnimWriter* writer)
+{
+    int status = 0;
+    if (writer->batch_count > 0 && flush_batch(writer) == -1) {
+        status = -1;
+    }
+
+    if (writer->format == ANIM_GIF) {
+        static const unsigned char trailer = 0x3B;
+        write_bytes(writer, &trailer, 1);  // GIF trailer
+    } else {
+        png_write_chunk(writer, "IEND", NULL, 0);
+
+        // Now that the frame count is known, rewrite the acTL chunk in place
+        unsigned char actl[8];
+        put_u32(actl, writer->frames_written);
+        put_u32(actl + 4, 0);
+        if (fseek(writer->file, writer->actl_offset, SEEK_SET) != 0) {
+            printf("Error: Could not patch the APNG frame count\n");
+            writer->failed = 1;
+        }
+        png_write_chunk(writer, "acTL", actl, sizeof(actl));
+    }
+
+    // Buffered bytes only reach the disk here, so a full disk may only show up on close
+    if (fclose(writer->file) != 0) {
+        printf("Error: Could not finish the animation file\n");
+        writer->failed = 1;
+    }
+    if (writer->failed) {
+        status = -1;
+    }
+    free_writer(writer);
+    return status;
+}
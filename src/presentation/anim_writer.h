@@ -0,0 +1,30 @@
+#ifndef ANIM_WRITER_H
+#define ANIM_WRITER_H
+
+#include "raster.h"
+
+// Animation container formats the writer can produce
+typedef enum {
+    ANIM_GIF,   // GIF89a with LZW-compressed frames
+    ANIM_APNG   // Animated PNG with deflate-compressed frames
+} AnimFormat;
+
+// Opaque writer state (palette, frame batch, per-thread encoders)
+typedef struct AnimWriter AnimWriter;
+
+// Open an animation file. The global palette is computed once from the given colors
+// (exactly when there are at most 256 of them, otherwise a uniform color cube is used).
+AnimWriter* anim_writer_open(const char* filename, AnimFormat format, int width, int height,
+                             const Color* colors, int num_colors, int delay_ms);
+
+// Queue one RGBA frame (width * height * 4 bytes). Frames are encoded in parallel
+// batches and written to the file in the order they were added.
+int anim_writer_add_frame(AnimWriter* writer, const unsigned char* rgba);
+
+// Queue one RGBA frame that stays on screen for delay_ms instead of the writer's default delay
+int anim_writer_add_frame_timed(AnimWriter* writer, const unsigned char* rgba, int delay_ms);
+
+// Encode any queued frames, finish the file and release the writer
+int anim_writer_close(AnimWriter* writer);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 64
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+// Function to prepare an empty arena
+void arena_init(Arena* arena, size_t block_size)
+{
+    arena->blocks = NULL;
+    arena->spare = NULL;
+    arena->block_size = block_size < 4096 ? 4096 : block_size;
+    arena->total = 0;
+}
+
+// Function to take a block of at least size bytes: a spare one when it is big enough, else a new one
+static ArenaBlock* arena_new_block(Arena* arena, size_t size)
+{
+    for (ArenaBlock** link = &arena->spare; *link; link = &(*link)->next) {
+        if ((*link)->size >= size) {
+            ArenaBlock* block = *link;
+            *link = block->next;
+            block->used = 0;
+            return block;
+        }
+    }
+    ArenaBlock* block = (ArenaBlock*) aligned_alloc(ARENA_ALIGN, ARENA_HEADER + size);
+    if (block == NULL) {
+        printf("Error: Could not allocate an arena block of %zu bytes\n", size);
+        return NULL;
+    }
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+// Function to hand out zeroed, 64-byte aligned memory from the current block, adding a block when
+// it is full (big requests get a block of their own size)
+void* arena_alloc(Arena* arena, size_t bytes)
+{
+    bytes = (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    ArenaBlock* block = arena->blocks;
+    if (block == NULL || block->size - block->used < bytes) {
+        block = arena_new_block(arena, bytes > arena->block_size ? bytes : arena->block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    char* memory = (char*)block + ARENA_HEADER + block->used;
+    block->used += bytes;
+    arena->total += bytes;
+    memset(memory, 0, bytes);
+    return memory;
+}
+
+// Function to remember the current position
+ArenaMark arena_mark(const Arena* arena)
+{
+    ArenaMark mark = { arena->blocks, arena->blocks ? arena->blocks->used : 0, arena->total };
+    return mark;
+}
+
+// Function to give back everything handed out since a mark, keeping newer blocks as spares
+void arena_rewind(Arena* arena, ArenaMark mark)
+{
+    while (arena->blocks != mark.block) {
+        ArenaBlock* block = arena->blocks;
+        arena->blocks = block->next;
+        block->next = arena->spare;
+        arena->spare = block;
+    }
+    if (arena->blocks) {
+        arena->blocks->used = mark.used;
+    }
+    arena->total = mark.total;
+}
+
+// Function to release every block
+void arena_free(Arena* arena)
+{
+    ArenaBlock* lists[2] = { arena->blocks, arena->spare };
+    for (int l = 0; l < 2; l++) {
+        while (lists[l]) {
+            ArenaBlock* next = lists[l]->next;
+            free(lists[l]);
+            lists[l] = next;
+        }
+    }
+    arena->blocks = arena->spare = NULL;
+    arena->total = 0;
+}
+
+#ifdef MORPH_COUNT_ALLOCATIONS
+// Test hook: the linker sends this program's calls to the allocator through these wrappers
+static long long heap_allocations = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void* __real_aligned_alloc(size_t alignment, size_t size);
+
+// Function to count a malloc
+void* __wrap_malloc(size_t size)
+{
+    __atomic_add_fetch(&heap_allocations, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+// Function to count a calloc
+void* __wrap_calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&heap_allocations, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+// Function to count a realloc
+void* __wrap_realloc(void* pointer, size_t size)
+{
+    __atomic_add_fetch(&heap_allocations, 1, __ATOMIC_RELAXED);
+    return __real_realloc(pointer, size);
+}
+
+// Function to count an aligned_alloc
+void* __wrap_aligned_alloc(size_t alignment, size_t size)
+{
+    __atomic_add_fetch(&heap_allocations, 1, __ATOMIC_RELAXED);
+    return __real_aligned_alloc(alignment, size);
+}
+
+// Function to read the allocation count
+long long arena_heap_allocations(void)
+{
+    return __atomic_load_n(&heap_allocations, __ATOMIC_RELAXED);
+}
+#else
+// Function to report that allocations are not counted in this build
+long long arena_heap_allocations(void)
+{
+    return -1;
+}
+#endif
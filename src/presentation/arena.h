@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Define one block of an arena; the memory handed out follows the header
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+} ArenaBlock;
+
+// Define a bump allocator owned by one run: plan tables, geometry and per-frame scratch are carved
+// out of a few large blocks and released together. Allocation takes no lock and never returns
+// memory to the heap on its own, so nothing in the frame loop touches malloc. Not shared
+// between threads
+typedef struct {
+    ArenaBlock* blocks;     // newest block first
+    ArenaBlock* spare;      // blocks given back by a rewind, used again before new ones
+    size_t block_size;      // size of the blocks added when the current one is full
+    size_t total;           // bytes handed out so far
+} Arena;
+
+// Define a point an arena can be rewound to
+typedef struct {
+    ArenaBlock* block;
+    size_t used;
+    size_t total;
+} ArenaMark;
+
+// Prepare an empty arena whose blocks hold at least block_size bytes
+void arena_init(Arena* arena, size_t block_size);
+
+// Hand out bytes aligned to 64 (a cache line), zeroed. Returns NULL when out of memory
+void* arena_alloc(Arena* arena, size_t bytes);
+
+// Remember the current position
+ArenaMark arena_mark(const Arena* arena);
+
+// Give back everything handed out since the mark; the blocks are kept for reuse
+void arena_rewind(Arena* arena, ArenaMark mark);
+
+// Release every block
+void arena_free(Arena* arena);
+
+// Heap allocations (malloc, calloc, realloc, aligned_alloc) made by this program's own code so
+// far. They are only counted in builds made with -DMORPH_COUNT_ALLOCATIONS and linked with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=aligned_alloc; otherwise returns -1
+long long arena_heap_allocations(void);
+
+#endif
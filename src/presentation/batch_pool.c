@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "batch_pool.h"
+
+// Where a job is in its life
+typedef enum {
+    JOB_PENDING,      // inputs not read yet
+    JOB_LOADING,      // a thread is reading the inputs
+    JOB_READY,        // inputs in memory, frames being handed out
+    JOB_DONE          // finished (or failed) and released
+} JobState;
+
+// Define the pool's view of one job
+typedef struct {
+    JobState state;
+    int num_frames;
+    int next_frame;       // first frame not handed out yet
+    int frames_done;
+    int failed;
+} JobSlot;
+
+// Define the state shared by the pool threads
+typedef struct {
+    void** jobs;
+    JobSlot* slots;
+    int num_jobs;
+    const BatchCallbacks* callbacks;
+    int window;
+    int claim_frames;
+
+    int next_load;        // next job whose inputs should be read
+    int resident;         // jobs loading or ready, bounded by window
+    int first_open;       // every job before this one has all its frames handed out
+    int jobs_done;
+    int jobs_failed;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} BatchPool;
+
+// Function to retire a job whose last frame (or load) has completed; called without the lock
+static void finish_job(BatchPool* pool, int j)
+{
+    JobSlot* slot = &pool->slots[j];
+    pool->callbacks->finish(pool->jobs[j], slot->failed);
+
+    pthread_mutex_lock(&pool->lock);
+    slot->state = JOB_DONE;
+    pool->resident--;
+    pool->jobs_done++;
+    pool->jobs_failed += slot->failed;
+    pthread_cond_broadcast(&pool->changed);  // Room to load the next job, or everything is done
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Pool thread: loads upcoming jobs while there is room, otherwise renders the earliest open frames
+static void* batch_worker(void* arg)
+{
+    BatchPool* pool = (BatchPool*) arg;
+    const BatchCallbacks* callbacks = pool->callbacks;
+    void* worker = callbacks->worker_init ? callbacks->worker_init() : NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->jobs_done < pool->num_jobs) {
+        // Prefetch: read the next inputs as soon as the window has room
+        if (pool->next_load < pool->num_jobs && pool->resident < pool->window) {
+            int j = pool->next_load++;
+            JobSlot* slot = &pool->slots[j];
+            slot->state = JOB_LOADING;
+            pool->resident++;
+            pthread_mutex_unlock(&pool->lock);
+
+            int num_frames = callbacks->load(pool->jobs[j]);
+
+            pthread_mutex_lock(&pool->lock);
+            if (num_frames <= 0) {
+                slot->failed = (num_frames < 0);
+                pthread_mutex_unlock(&pool->lock);
+                finish_job(pool, j);
+                pthread_mutex_lock(&pool->lock);
+                continue;
+            }
+            slot->num_frames = num_frames;
+            slot->state = JOB_READY;
+            pthread_cond_broadcast(&pool->changed);
+            continue;
+        }
+
+        // Otherwise take a block of frames from the earliest job that still has some
+        while (pool->first_open < pool->num_jobs &&
+               pool->slots[pool->first_open].state == JOB_DONE) {
+            pool->first_open++;
+        }
+        int j = -1;
+        for (int k = pool->first_open; k < pool->next_load; k++) {
+            JobSlot* slot = &pool->slots[k];
+            if (slot->state == JOB_READY && slot->next_frame < slot->num_frames) {
+                j = k;
+                break;
+            }
+        }
+        if (j == -1) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+            continue;
+        }
+        JobSlot* slot = &pool->slots[j];
+        int first = slot->next_frame;
+        int count = slot->num_frames - first < pool->claim_frames ? slot->num_frames - first : pool->claim_frames;
+        slot->next_frame += count;
+        int skip = slot->failed;  // A failed job only drains its remaining frames
+        pthread_mutex_unlock(&pool->lock);
+
+        int failed = 0;
+        for (int frame = first; frame < first + count && !skip && !failed; frame++) {
+            failed = (callbacks->render(pool->jobs[j], frame, worker) == -1);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        slot->failed |= failed;
+        slot->frames_done += count;
+        if (slot->frames_done == slot->num_frames) {
+            pthread_mutex_unlock(&pool->lock);
+            finish_job(pool, j);
+            pthread_mutex_lock(&pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (callbacks->worker_free) {
+        callbacks->worker_free(worker);
+    }
+    return NULL;
+}
+
+// Function to run a batch of jobs on a shared pool of threads
+int batch_pool_run(void** jobs, int num_jobs, const BatchCallbacks* callbacks, int num_threads,
+                   int window, int claim_frames)
+{
+    if (num_jobs == 0) {
+        return 0;
+    }
+    BatchPool pool = { 0 };
+    pool.jobs = jobs;
+    pool.num_jobs = num_jobs;
+    pool.callbacks = callbacks;
+    pool.window = window < 1 ? 1 : window;
+    pool.claim_frames = claim_frames < 1 ? 1 : claim_frames;
+    pool.slots = (JobSlot*) calloc(num_jobs, sizeof(JobSlot));
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    pthread_t* threads = (pthread_t*) calloc(num_threads, sizeof(pthread_t));
+    if (pool.slots == NULL || threads == NULL) {
+        printf("Error: Could not allocate the batch pool\n");
+        free(pool.slots);
+        free(threads);
+        return -1;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+
+    int started = 0;
+    for (; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, batch_worker, &pool) != 0) {
+            printf("Error: Could not start batch thread %d\n", started);
+            break;
+        }
+    }
+    // Running threads finish every job between them, even if some could not start
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.changed);
+    free(pool.slots);
+    free(threads);
+    return started == 0 ? -1 : pool.jobs_failed;
+}
@@ -0,0 +1,21 @@
+#ifndef BATCH_POOL_H
+#define BATCH_POOL_H
+
+// Define what the pool does with a job; every callback runs on a pool thread
+typedef struct {
+    int (*load)(void* job);                              // read the inputs, returns the frame count or -1
+    int (*render)(void* job, int frame, void* worker);   // produce one frame, returns 0 or -1
+    void (*finish)(void* job, int failed);               // release the inputs after the last frame
+    void* (*worker_init)(void);                          // per-thread scratch state (may return NULL)
+    void (*worker_free)(void* worker);
+} BatchCallbacks;
+
+// Run every job on one shared pool of num_threads threads. Frames of all jobs are handed out in
+// blocks of claim_frames, earliest job first, so small jobs do not leave threads idle. The inputs
+// of upcoming jobs are loaded while earlier jobs render, but at most `window` jobs hold their
+// inputs at once; further loading waits until a job finishes (backpressure on memory).
+// Returns the number of failed jobs, or -1 if the pool could not start
+int batch_pool_run(void** jobs, int num_jobs, const BatchCallbacks* callbacks, int num_threads,
+                   int window, int claim_frames);
+
+#endif
@@ -1,115 +1,397 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
 #include <math.h>
 #include <sys/stat.h>
+#include <sys/time.h>  //time execution
 #include <errno.h>
+#include "easing.h"  // timing functions baked into a per-frame t table
+#include "svg_scan.h"     // viewBox of the source
+#include "svg_outline.h"  // <path>/<polygon>/<circle> outlines sampled into points
+#include "morph_mesh.h"   // compatible triangulation with grid point location
+#include "morph_engine.h" // per-point interpolation of the mesh vertices
+#include "point_index.h"  // nearest-point pairing of source and target
+#include "svg_format.h"   // quantized coordinate output
+#include "frame_writer.h" // frames written while the next ones are computed
+#include "logger.h"       // leveled messages and the progress reporter
 
-// Function to interpolate between two float values (Ease-In/Ease-Out)
-float ease_in_out(float t) {
-    return t < 0.5 ? 2 * t * t : -1 + (4 - 2 * t) * t;
-}
+#define NUMBER_TEXT 33   // room for one formatted coordinate and its separator
 
-// Linear interpolation between two points
-void linear_interpolation(float x1, float y1, float x2, float y2, float t, float* result_x, float* result_y) {
-    *result_x = (1 - t) * x1 + t * x2;
-    *result_y = (1 - t) * y1 + t * y2;
-}
+// Morphs chef.svg into donut.svg (the C version of src/python/chef-to-donut.py): both drawings are
+// sampled into the same number of points, one triangulation connects the points of both, and every
+// frame moves the triangle corners, carrying whatever lies inside each triangle along with it
 
-// Function to load the path data (d attribute) from an SVG file
-char* load_svg_path(const char* filename) {
-    xmlDoc *doc = xmlReadFile(filename, NULL, 0);
-    if (doc == NULL) {
-        printf("Error: Could not parse file %s\n", filename);
-        return NULL;
+// Function to reduce a point list to target_length points picked evenly by index, like the Python
+// version's downsampling (the first and last points stay)
+void downsample_points(const float* xy, int length, int target_length, float* out)
+{
+    for (int i = 0; i < target_length; i++) {
+        int j = target_length > 1 ? (int) lround((double)i * (length - 1) / (target_length - 1)) : 0;
+        out[2 * i] = xy[2 * j];
+        out[2 * i + 1] = xy[2 * j + 1];
     }
+}
 
-    xmlNode *root_element = xmlDocGetRootElement(doc);
-    xmlNode *node = root_element->children;
-
-    // Find the <path> element and get the "d" attribute (path data)
-    while (node) {
-        if (node->type == XML_ELEMENT_NODE && xmlStrcmp(node->name, (const xmlChar *)"path") == 0) {
-            xmlChar* path_data = xmlGetProp(node, (const xmlChar *)"d");
-            char *path_copy = strdup((char*)path_data); // Make a copy of the path data
-            xmlFree(path_data);
-            xmlFreeDoc(doc);
-            return path_copy;
+// Function to append "M x,y x,y x,y Z" for every triangle of the mesh at the frame's vertex positions
+int format_wireframe(char* out, size_t size, const MorphMesh* mesh, const float* points_x, const float* points_y,
+                     const CoordFormat* format)
+{
+    size_t length = 0;
+    for (int t = 0; t < mesh->num_triangles; t++) {
+        const int* v = mesh->triangles + 3 * t;
+        float xs[3] = { points_x[v[0]], points_x[v[1]], points_x[v[2]] };
+        float ys[3] = { points_y[v[0]], points_y[v[1]], points_y[v[2]] };
+        if (size - length < 4) {
+            return -1;
         }
-        node = node->next;
+        out[length++] = 'M';
+        int written = format_points(out + length, size - length, xs, ys, 3, format);
+        if (written < 0 || size - (length + written) < 2) {
+            return -1;
+        }
+        length += written;
+        out[length++] = 'Z';
     }
-
-    xmlFreeDoc(doc);
-    return NULL;
+    out[length] = '\0';
+    return (int)length;
 }
 
-// Function to write the interpolated path to an SVG file
-void write_svg_path(const char* interpolated_path, int frame_number) {
-    char filename[100];
-    sprintf(filename, "chef_to_donut/frame_%03d.svg", frame_number);  // Zero-padded to 3 digits
-
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("Error: Could not open file %s for writing: %s\n", filename, strerror(errno));
-        return;
+// Function to append one shape of the detail outlines, carried through the mesh, as path data:
+// "M" before every subpath and "Z" after it
+int format_detail_shape(char* out, size_t size, const SvgOutlines* detail, int shape, const MorphMesh* mesh,
+                        const int* bound_triangle, const float* bound_weights, const float* points_x,
+                        const float* points_y, float* xs, float* ys, const CoordFormat* format)
+{
+    size_t length = 0;
+    int first = detail->shape_start[shape], last = detail->shape_start[shape + 1];
+    for (int begin = first; begin < last;) {
+        int end = begin + 1;
+        while (end < last && !detail->move[end]) {
+            end++;
+        }
+        for (int i = begin; i < end; i++) {
+            morph_mesh_place(mesh, points_x, points_y, bound_triangle[i], bound_weights + 3 * i,
+                             &xs[i - begin], &ys[i - begin]);
+        }
+        if (size - length < 4) {
+            return -1;
+        }
+        out[length++] = 'M';
+        int written = format_points(out + length, size - length, xs, ys, end - begin, format);
+        if (written < 0 || size - (length + written) < 2) {
+            return -1;
+        }
+        length += written;
+        out[length++] = 'Z';
+        begin = end;
     }
+    out[length] = '\0';
+    return (int)length;
+}
 
-    fprintf(file, "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n");
-    fprintf(file, "  <path d='%s' fill='blue' />\n", interpolated_path);
-    fprintf(file, "</svg>\n");
+// Function to check the last frame against the target: every mesh vertex at its target position,
+// and every detail point inside the frame around the target
+int check_last_frame(const MorphMesh* mesh, const float* points_x, const float* points_y, const SvgOutlines* detail,
+                     const int* bound_triangle, const float* bound_weights)
+{
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        float x = (float)mesh->target_xy[2 * i], y = (float)mesh->target_xy[2 * i + 1];
+        if (fabsf(points_x[i] - x) > 1e-4f * (1.0f + fabsf(x)) || fabsf(points_y[i] - y) > 1e-4f * (1.0f + fabsf(y))) {
+            return -1;
+        }
+    }
+    const double* corner = mesh->target_xy + 2 * mesh->num_points;
+    float min_x = (float)fmin(fmin(corner[0], corner[2]), fmin(corner[4], corner[6]));
+    float max_x = (float)fmax(fmax(corner[0], corner[2]), fmax(corner[4], corner[6]));
+    float min_y = (float)fmin(fmin(corner[1], corner[3]), fmin(corner[5], corner[7]));
+    float max_y = (float)fmax(fmax(corner[1], corner[3]), fmax(corner[5], corner[7]));
+    float slack = 1e-4f * (1.0f + fmaxf(max_x - min_x, max_y - min_y));
+    for (int i = 0; i < detail->num_points; i++) {
+        float x, y;
+        morph_mesh_place(mesh, points_x, points_y, bound_triangle[i], bound_weights + 3 * i, &x, &y);
+        if (!(x >= min_x - slack && x <= max_x + slack && y >= min_y - slack && y <= max_y + slack)) {
+            return -1;
+        }
+    }
+    return 0;
+}
 
-    fclose(file);
-    printf("Frame %d written successfully to %s\n", frame_number, filename);  // Debug message
+// Function to print the command line options
+void print_usage(const char* program)
+{
+    printf("Usage: %s [--source FILE] [--target FILE] [--samples N] [--frames N] [--ease F] [--precision N]\n",
+           program);
+    printf("       [--grid STEP] [--detail N] [--match index|nearest] [--out DIR] [--log-level L] [--progress S]\n");
+    printf("       [timing function]\n");
+    printf("  --source FILE  SVG to start from (default ../../svg/chef.svg)\n");
+    printf("  --target FILE  SVG to end with (default ../../svg/donut.svg)\n");
+    printf("  --samples N    points sampled along every <path>, <polygon> and <circle> (default 50)\n");
+    printf("  --frames N     number of frames (default 101)\n");
+    printf("  --ease F       timing function applied to t (default quad-in-out)\n");
+    easing_print_help();
+    printf("  --precision N  decimals kept for coordinates\n");
+    printf("  --grid STEP    snap coordinates to multiples of STEP\n");
+    printf("  --detail N     draw the source shapes (N points each) carried by the mesh instead of the\n");
+    printf("                 triangles themselves\n");
+    printf("  --match M      how points are paired: by their order along the shapes (index, default) or each\n");
+    printf("                 source point with its own nearest target point (nearest)\n");
+    printf("  --out DIR      output directory (default chef_to_donut)\n");
+    printf("  --log-level L  error, warning, info (default) or debug, which adds one line per written frame\n");
+    printf("  --progress S   report frames/s, bytes written and the ETA on stderr every S seconds (default 1,\n");
+    printf("                 0 for the final summary only)\n");
 }
 
-// Function to interpolate between two SVG paths
-char* morph_paths(const char* chef_path, const char* donut_path, float t) {
-    // TODO: Parse the paths and normalize them (i.e., make sure both paths have the same number of points)
-    // Then apply interpolation between corresponding points.
+int main(int argc, char** argv) {
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);  // record the wall-clock start time
 
-    // For now, return the chef path for simplicity
-    if (t == 0.0f) {
-        return strdup(chef_path);  // Return chef path at t=0
-    } else if (t == 1.0f) {
-        return strdup(donut_path);  // Return donut path at t=1
-    } else {
-        // Linear interpolation between chef_path and donut_path (actual implementation needed here)
-        return strdup(chef_path);  // Temporary: just returning chef_path
+    // Ease in and out (quadratic) unless another timing function is given
+    Easing easing = { EASE_POLY_IN_OUT, { 2 }, 0 };
+    const char* source_svg = "../../svg/chef.svg";
+    const char* target_svg = "../../svg/donut.svg";
+    const char* directory = "chef_to_donut";
+    int samples = 50;       // Same sampling as the Python version
+    int num_frames = 101;
+    int detail = 0;
+    int match_nearest = 0;
+    int decimals = -1;
+    float grid = 0.0f;
+    LogLevel log_level = LOG_INFO;
+    float progress_seconds = 1.0f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            source_svg = argv[++i];
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            target_svg = argv[++i];
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            num_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--detail") == 0 && i + 1 < argc) {
+            detail = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            decimals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--match") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "nearest") == 0) {
+                match_nearest = 1;
+            } else if (strcmp(argv[i], "index") != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (log_parse_level(argv[++i], &log_level) == -1) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            progress_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--ease") == 0 && i + 1 < argc) {
+            if (easing_parse(argv[++i], &easing) == -1) {
+                return -1;
+            }
+        } else if (argv[i][0] != '-' && easing_parse(argv[i], &easing) == 0) {
+            // A bare timing function, as the first version of this program took it
+        } else {
+            print_usage(argv[0]);
+            return -1;
+        }
     }
-}
+    CoordFormat coord_format;
+    if (samples < 3 || num_frames < 2 || detail < 0 || progress_seconds < 0.0f ||
+        coord_format_init(&coord_format, decimals, grid) == -1) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    log_set_level(log_level);
 
-int main() {
-    // Load the path data from chef.svg and donut.svg
-    char* chef_path = load_svg_path("../../svg/chef.svg");
-    char* donut_path = load_svg_path("../../svg/donut.svg");
+    // Sample both drawings and bring them to the same number of points
+    SvgOutlines source, target;
+    if (svg_outlines_load(source_svg, samples, &source) == -1) {
+        return -1;
+    }
+    if (svg_outlines_load(target_svg, samples, &target) == -1) {
+        svg_outlines_free(&source);
+        return -1;
+    }
+    int num_points = source.num_points < target.num_points ? source.num_points : target.num_points;
+    float* source_xy = (float*) malloc((size_t)num_points * 2 * sizeof(float));
+    float* target_xy = (float*) malloc((size_t)num_points * 2 * sizeof(float));
+    if (source_xy == NULL || target_xy == NULL) {
+        printf("Error: Could not allocate %d points\n", num_points);
+        return -1;
+    }
+    downsample_points(source.xy, source.num_points, num_points, source_xy);
+    if (match_nearest) {
+        // Every source point takes a target point of its own, near ones first
+        int* match = (int*) malloc(((size_t)num_points + 1) * sizeof(int));
+        if (match == NULL || point_match_unique(source_xy, num_points, target.xy, target.num_points, match) == -1) {
+            free(match);
+            return -1;
+        }
+        for (int i = 0; i < num_points; i++) {
+            target_xy[2 * i] = target.xy[2 * match[i]];
+            target_xy[2 * i + 1] = target.xy[2 * match[i] + 1];
+        }
+        free(match);
+    } else {
+        downsample_points(target.xy, target.num_points, num_points, target_xy);
+    }
 
-    if (chef_path == NULL || donut_path == NULL) {
-        printf("Error: Failed to load SVG paths.\n");
+    // One triangulation for both point sets; its corners move in a straight line from source to target
+    MorphMesh* mesh = morph_mesh_create(num_points, source_xy, target_xy);
+    float* vertex_xy = mesh ? (float*) malloc((size_t)mesh->num_vertices * 4 * sizeof(float)) : NULL;
+    if (vertex_xy == NULL) {
         return -1;
     }
+    for (int i = 0; i < 2 * mesh->num_vertices; i++) {
+        vertex_xy[i] = (float)mesh->source_xy[i];
+        vertex_xy[2 * mesh->num_vertices + i] = (float)mesh->target_xy[i];
+    }
+    MorphPlan* plan = morph_plan_create(mesh->num_vertices, vertex_xy, NULL, vertex_xy + 2 * mesh->num_vertices);
+    free(vertex_xy);
+    if (plan == NULL) {
+        return -1;
+    }
+    printf("Mesh: %d points, 4 frame corners, %d Steiner points, %d triangles, %d duplicate points\n", num_points,
+           mesh->num_vertices - num_points - 4, mesh->num_triangles, mesh->num_duplicates);
+    if (mesh->num_folded > 0 || mesh->num_triangles == 0) {
+        // An inside-out triangle would mirror its interior, so it is never drawn
+        printf("Error: The points of %s and %s leave no triangles that stay the right way round\n", source_svg,
+               target_svg);
+        return -1;
+    }
+
+    // Detail outlines are bound once to the triangle under each of their points
+    SvgOutlines shapes;
+    int* bound_triangle = NULL;
+    float* bound_weights = NULL;
+    memset(&shapes, 0, sizeof(SvgOutlines));
+    if (detail > 0) {
+        if (svg_outlines_load(source_svg, detail, &shapes) == -1) {
+            return -1;
+        }
+        bound_triangle = (int*) malloc(shapes.num_points * sizeof(int));
+        bound_weights = (float*) malloc((size_t)shapes.num_points * 3 * sizeof(float));
+        if (bound_triangle == NULL || bound_weights == NULL || mesh->num_triangles == 0) {
+            printf("Error: Could not bind %d detail points to the mesh\n", shapes.num_points);
+            return -1;
+        }
+        int outside = 0;
+        for (int i = 0; i < shapes.num_points; i++) {
+            bound_triangle[i] = morph_mesh_locate(mesh, shapes.xy[2 * i], shapes.xy[2 * i + 1], bound_weights + 3 * i);
+            outside += bound_triangle[i] < 0;
+        }
+        if (outside > 0) {
+            printf("Error: %d of %d detail points lie outside the mesh\n", outside, shapes.num_points);
+            return -1;
+        }
+    }
+
+    // Frames use the source's coordinate system
+    char view_box[128] = "";
+    SvgFile file;
+    size_t offset = 0;
+    SvgSpan tag;
+    if (svg_file_map(source_svg, &file) == 0) {
+        char value[100];
+        if (svg_find_element(&file, "svg", &offset, &tag) == 0 && svg_attribute_copy(&tag, "viewBox", value, sizeof(value)) == 0) {
+            snprintf(view_box, sizeof(view_box), " viewBox='%s'", value);
+        }
+        svg_file_unmap(&file);
+    }
 
     // Create the output directory if it doesn't exist
     struct stat st = {0};
-    if (stat("chef_to_donut", &st) == -1) {
-        if (mkdir("chef_to_donut", 0700) != 0) {
-            printf("Error creating directory 'chef_to_donut': %s\n", strerror(errno));
+    if (stat(directory, &st) == -1) {
+        if (mkdir(directory, 0700) != 0) {
+            printf("Error creating directory '%s': %s\n", directory, strerror(errno));
             return -1;
         }
     }
 
-    // Generate 101 frames (from frame 0 to frame 100)
-    for (int frame = 0; frame <= 100; frame++) {
-        float t = frame / 100.0f;  // Interpolation factor between 0 and 1
-        char* interpolated_path = morph_paths(chef_path, donut_path, t);  // Morph using linear interpolation
-        write_svg_path(interpolated_path, frame);  // Write the result to a new SVG file
-        free(interpolated_path);
+    // Remap t for all frames once instead of easing it on every call
+    float* frame_times = easing_bake(&easing, num_frames);
+    Polygon shape = { 0 };
+    float* points_x = polygon_init(&shape, NULL, mesh->num_vertices) == 0 ? shape.x : NULL;
+    float* points_y = shape.y;
+    float* detail_x = (float*) malloc(((size_t)shapes.num_points + 1) * 2 * sizeof(float));
+    float* detail_y = detail_x ? detail_x + shapes.num_points + 1 : NULL;
+    size_t text_size = (detail > 0 ? (size_t)shapes.num_points * 2 * NUMBER_TEXT + (size_t)shapes.num_points * 2
+                                   : (size_t)mesh->num_triangles * (6 * NUMBER_TEXT + 2)) + 512;
+    char* text = (char*) malloc(text_size);
+    char* document = (char*) malloc(text_size + 1024);
+    FrameWriter* writer = frame_writer_open(FRAME_OUTPUT_SVG, NULL, 0, 1, 16, 1);
+    Progress* progress = progress_start("chef_to_donut", num_frames, (int)(progress_seconds * 1000.0f + 0.5f));
+    if (frame_times == NULL || points_x == NULL || detail_x == NULL || text == NULL || document == NULL ||
+        writer == NULL || progress == NULL) {
+        printf("Error: Could not allocate the frame buffers\n");
+        return -1;
+    }
+    frame_writer_track(writer, progress);
+
+    int status = 0;
+    for (int frame = 0; frame < num_frames && status == 0; frame++) {
+        morph_plan_evaluate_polygon(plan, frame_times[frame], &shape);
+        int length = snprintf(document, text_size + 1024,
+                              "<svg xmlns='http://www.w3.org/2000/svg' version='1.1' width='800' height='800'%s>\n",
+                              view_box);
+        if (detail == 0) {
+            // The triangulation itself, like the Python version draws it
+            status = format_wireframe(text, text_size, mesh, points_x, points_y, &coord_format) < 0 ? -1 : 0;
+            length += snprintf(document + length, text_size + 1024 - length,
+                               "  <path d='%s' fill='none' stroke='black' stroke-width='1' "
+                               "vector-effect='non-scaling-stroke' />\n", text);
+        }
+        for (int shape = 0; shape < shapes.num_shapes && status == 0; shape++) {
+            // Every outline point follows the triangle it lies in
+            status = format_detail_shape(text, text_size, &shapes, shape, mesh, bound_triangle, bound_weights,
+                                         points_x, points_y, detail_x, detail_y, &coord_format) < 0 ? -1 : 0;
+            length += snprintf(document + length, text_size + 1024 - length,
+                               "  <path d='%s' fill='black' fill-rule='evenodd' />\n", text);
+        }
+        length += snprintf(document + length, text_size + 1024 - length, "</svg>\n");
+        if (status == -1 || length >= (int)(text_size + 1024)) {
+            printf("Error: Frame %d does not fit the SVG buffer\n", frame);
+            status = -1;
+            break;
+        }
+
+        char filename[FRAME_NAME_SIZE + 1];  // One byte more than the writer takes: a cut name is refused
+        snprintf(filename, sizeof(filename), "%s/frame_%03d.svg", directory, frame);
+        status = frame_writer_submit(writer, filename, document, length);
+        progress_add(progress, 1, 0);
+    }
+    if (frame_writer_close(writer) == -1) {
+        status = -1;
+    }
+    progress_finish(progress);
+    if (status == 0 && check_last_frame(mesh, points_x, points_y, &shapes, bound_triangle, bound_weights) == -1) {
+        printf("Error: The last frame does not match the target drawing %s\n", target_svg);
+        status = -1;
     }
 
     // Clean up
-    free(chef_path);
-    free(donut_path);
+    free(frame_times);
+    polygon_free(&shape);
+    free(detail_x);
+    free(text);
+    free(document);
+    free(bound_triangle);
+    free(bound_weights);
+    free(source_xy);
+    free(target_xy);
+    morph_plan_destroy(plan);
+    morph_mesh_destroy(mesh);
+    svg_outlines_free(&source);
+    svg_outlines_free(&target);
+    svg_outlines_free(&shapes);
 
-    return 0;
+    gettimeofday(&end_time, NULL);  // Record the wall-clock end time
+    double time_taken = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_usec - start_time.tv_usec) / 1e6;
+    printf("Execution Time: %.3f seconds\n", time_taken);
+    return status;
 }
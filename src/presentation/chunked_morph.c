@@ -0,0 +1,504 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "chunked_morph.h"
+#include "svg_scan.h"
+
+#define CHUNK_NUMBER_LENGTH 33   // A formatted coordinate plus its separator
+#define CHUNK_GZIP_BUFFER 65536  // Compressed bytes gathered before each write
+
+// Define where one frame's text goes: a file, written plain or through the morph's deflate stream
+typedef struct {
+    FILE* file;
+    GzipContext* gz;
+    long long written;      // bytes that reached the file
+} FrameSink;
+
+// Define the source outline while it is being paired: a points list or a sampled circle
+typedef struct {
+    SvgPointReader reader;
+    long long count;        // points in the list, 0 for a circle
+    long long index;        // index of the point in x, y (-1 before the first)
+    float x, y;
+    float cx, cy, r;
+    // A shorter list is resampled by length, as morph_outline_resample does in memory
+    int resample;           // 1 when the list is shorter than the morph and has a perimeter
+    double perimeter;
+    double length;          // length of the edges sampled so far
+    long long extra;        // points added on top of the list's own
+    long long edge;         // edge being sampled (-1 before the first)
+    long long written;      // points given out so far
+    long long on_edge;      // points the current edge gets, starting at its first vertex
+    long long step;         // next of those points
+    float first_x, first_y; // the closing edge ends at the first vertex
+    float from_x, from_y, dx, dy;
+} OutlineSource;
+
+// Function to find the first <polygon> with a points list in a mapped file
+static int find_polygon_points(const SvgFile* file, SvgSpan* points)
+{
+    size_t offset = 0;
+    SvgSpan tag;
+    while (svg_find_element(file, "polygon", &offset, &tag) == 0) {
+        if (svg_attribute(&tag, "points", points) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Function to move a points reader forward to point `wanted`; the pairing only ever moves forward
+static int advance_to(OutlineSource* source, long long wanted)
+{
+    while (source->index < wanted) {
+        if (svg_points_next(&source->reader, &source->x, &source->y) != 1) {
+            printf("Error: Points list ended before point %lld\n", wanted);
+            return -1;
+        }
+        source->index++;
+    }
+    return 0;
+}
+
+// Function to measure a points list's closed perimeter ahead of pairing, so a shorter list can get
+// its extra points by length. The list is read through a copy of the reader and again while pairing
+static int start_resample(OutlineSource* source, long long num_points)
+{
+    SvgPointReader reader = source->reader;
+    float first_x = 0.0f, first_y = 0.0f, x = 0.0f, y = 0.0f;
+    double perimeter = 0.0;
+    for (long long i = 0; i < source->count; i++) {
+        float last_x = x, last_y = y;
+        if (svg_points_next(&reader, &x, &y) != 1) {
+            printf("Error: Points list ended before point %lld\n", i);
+            return -1;
+        }
+        if (i == 0) {
+            first_x = x;
+            first_y = y;
+        } else {
+            perimeter += hypot(x - last_x, y - last_y);
+        }
+    }
+    perimeter += hypot(first_x - x, first_y - y);
+    source->resample = (source->count < num_points && perimeter > 0.0);
+    source->perimeter = perimeter;
+    source->extra = num_points - source->count;
+    source->edge = -1;
+    return 0;
+}
+
+// Function to give the next point of a resampled list: every vertex is kept and each edge of the
+// closed outline gets a share of the extra points in proportion to its length
+static int next_resampled(OutlineSource* source, float* x, float* y)
+{
+    while (source->step == source->on_edge) {
+        if (++source->edge == source->count) {
+            printf("Error: Resampling ran past the end of the outline\n");
+            return -1;
+        }
+        if (source->edge == 0) {
+            if (advance_to(source, 0) == -1) {
+                return -1;
+            }
+            source->first_x = source->x;
+            source->first_y = source->y;
+        }
+        source->from_x = source->x;
+        source->from_y = source->y;
+        float to_x = source->first_x, to_y = source->first_y;
+        if (source->edge + 1 < source->count) {
+            if (advance_to(source, source->edge + 1) == -1) {
+                return -1;
+            }
+            to_x = source->x;
+            to_y = source->y;
+        }
+        source->dx = to_x - source->from_x;
+        source->dy = to_y - source->from_y;
+        source->length += hypot(source->dx, source->dy);
+        long long end = source->edge + 1 + llround(source->extra * (source->length / source->perimeter));
+        source->on_edge = end - source->written;
+        source->step = 0;
+    }
+    *x = source->from_x + source->dx * source->step / source->on_edge;
+    *y = source->from_y + source->dy * source->step / source->on_edge;
+    source->step++;
+    source->written++;
+    return 0;
+}
+
+// Function to give point i of an outline with num_points points: a sampled circle, the list itself,
+// or the shorter list resampled by length (picked by index when it has no length at all)
+static int outline_point(OutlineSource* source, long long i, long long num_points, float* point)
+{
+    if (source->count == 0) {
+        float angle = (2 * M_PI / num_points) * i;
+        point[0] = source->cx + source->r * cos(angle);
+        point[1] = source->cy + source->r * sin(angle);
+        return 0;
+    }
+    if (source->resample) {
+        return next_resampled(source, &point[0], &point[1]);
+    }
+    if (advance_to(source, i * source->count / num_points) == -1) {
+        return -1;
+    }
+    point[0] = source->x;
+    point[1] = source->y;
+    return 0;
+}
+
+// Function to write the paired points in blocks through an unlinked spill file, then map it
+static int spill_pairs(ChunkedMorph* morph, OutlineSource* source, OutlineSource* target,
+                       const char* spill_dir)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/.chunked-XXXXXX", spill_dir);
+    int fd = mkstemp(path);
+    if (fd == -1) {
+        printf("Error: Could not create a spill file in %s\n", spill_dir);
+        return -1;
+    }
+    unlink(path);  // The data lives only as long as the descriptor and the mapping
+
+    long long count = morph->num_points;
+    float* block = (float*) malloc((size_t)morph->chunk_points * 4 * sizeof(float));
+    if (block == NULL) {
+        printf("Error: Could not allocate the spill buffer\n");
+        close(fd);
+        return -1;
+    }
+    int status = 0;
+    for (long long base = 0; base < count && status == 0; base += morph->chunk_points) {
+        int n = (count - base < morph->chunk_points) ? (int)(count - base) : morph->chunk_points;
+        for (int j = 0; j < n && status == 0; j++) {
+            long long i = base + j;
+            float* pair = &block[4 * j];
+            status = outline_point(source, i, count, &pair[0]);
+            if (status == 0) {
+                status = outline_point(target, i, count, &pair[2]);
+            }
+        }
+        size_t bytes = (size_t)n * 4 * sizeof(float);
+        if (status == 0 && write(fd, block, bytes) != (ssize_t)bytes) {
+            printf("Error: Could not write the spill file\n");
+            status = -1;
+        }
+    }
+    free(block);
+
+    if (status == 0) {
+        morph->mapped_bytes = (size_t)count * 4 * sizeof(float);
+        void* data = mmap(NULL, morph->mapped_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            printf("Error: Could not map the spill file\n");
+            status = -1;
+        } else {
+            madvise(data, morph->mapped_bytes, MADV_SEQUENTIAL);  // Every frame walks it front to back
+            morph->pairs = (const float*) data;
+        }
+    }
+    close(fd);
+    return status;
+}
+
+// Function to pair two outlines and prepare the chunk buffers
+int chunked_morph_open(ChunkedMorph* morph, const char* source_svg, const char* target_svg,
+                       const char* spill_dir, int chunk_points, float simplify_tolerance, float path_tolerance)
+{
+    memset(morph, 0, sizeof(ChunkedMorph));
+    morph->gzip_level = -1;
+    if (chunk_points < 1) {
+        printf("Error: A chunk needs at least 1 point\n");
+        return -1;
+    }
+    morph->chunk_points = chunk_points;
+    morph->simplify_tolerance = simplify_tolerance;
+    simplify_scratch_init(&morph->scratch);
+    morph->path_tolerance = path_tolerance;
+    curve_fitter_init(&morph->fitter);
+
+    SvgFile source_file, target_file;
+    if (svg_file_map(source_svg, &source_file) == -1) {
+        return -1;
+    }
+    if (svg_file_map(target_svg, &target_file) == -1) {
+        svg_file_unmap(&source_file);
+        return -1;
+    }
+
+    int status = 0;
+    OutlineSource source = { 0 }, target = { 0 };
+    source.index = target.index = -1;
+    SvgSpan points, tag;
+    size_t offset = 0;
+    if (find_polygon_points(&source_file, &points) == 0) {
+        morph->source_element = "polygon";
+        source.count = svg_count_points(&points);
+        svg_points_begin(&points, &source.reader);
+    } else if (svg_find_element(&source_file, "circle", &offset, &tag) == 0 &&
+               svg_attribute_float(&tag, "cx", &source.cx) == 0 && svg_attribute_float(&tag, "cy", &source.cy) == 0 &&
+               svg_attribute_float(&tag, "r", &source.r) == 0) {
+        morph->source_element = "circle";
+    } else {
+        printf("Error: %s has no <polygon> with points and no <circle>\n", source_svg);
+        status = -1;
+    }
+    if (status == 0 && find_polygon_points(&target_file, &points) == -1) {
+        printf("Error: %s has no <polygon> with points\n", target_svg);
+        status = -1;
+    }
+    if (status == 0) {
+        target.count = svg_count_points(&points);
+        svg_points_begin(&points, &target.reader);
+        int empty_source = (strcmp(morph->source_element, "polygon") == 0 && source.count < 1);
+        if (empty_source || target.count < 1) {
+            printf("Error: Both outlines need a valid, non-empty points list\n");
+            status = -1;
+        }
+    }
+
+    if (status == 0) {
+        morph->num_points = source.count > target.count ? source.count : target.count;
+        if ((source.count > 0 && start_resample(&source, morph->num_points) == -1) ||
+            start_resample(&target, morph->num_points) == -1) {
+            status = -1;
+        } else {
+            status = spill_pairs(morph, &source, &target, spill_dir);
+        }
+    }
+    svg_file_unmap(&source_file);
+    svg_file_unmap(&target_file);
+    if (status == -1) {
+        chunked_morph_close(morph);
+        return -1;
+    }
+
+    // A path chunk starts at the previous chunk's last point and takes up to 6 numbers per point
+    morph->xs = (float*) malloc((chunk_points + 1) * sizeof(float));
+    morph->ys = (float*) malloc((chunk_points + 1) * sizeof(float));
+    morph->text_size = (size_t)(chunk_points + 1) * (path_tolerance > 0.0f ? 6 : 2) * CHUNK_NUMBER_LENGTH + 16;
+    morph->text = (char*) malloc(morph->text_size);
+    morph->chunk_hints = (int*) malloc((chunk_points + 1) * sizeof(int));
+    if (!morph->xs || !morph->ys || !morph->text || !morph->chunk_hints) {
+        printf("Error: Could not allocate chunks of %d points\n", chunk_points);
+        chunked_morph_close(morph);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to run deflate over some text (or finish the member) and write what comes out
+static int sink_deflate(FrameSink* sink, const char* data, size_t length, int flush)
+{
+    z_stream* stream = &sink->gz->stream;
+    stream->next_in = (Bytef*) data;
+    stream->avail_in = (uInt)length;
+    for (;;) {
+        stream->next_out = sink->gz->out;
+        stream->avail_out = (uInt)sink->gz->capacity;
+        int result = deflate(stream, flush);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            printf("Error: Compression failed\n");
+            return -1;
+        }
+        size_t produced = sink->gz->capacity - stream->avail_out;
+        if (fwrite(sink->gz->out, 1, produced, sink->file) != produced) {
+            return -1;
+        }
+        sink->written += produced;
+        // Done once the input is used up and, when finishing, the trailer is out
+        if (flush == Z_FINISH ? result == Z_STREAM_END : stream->avail_out > 0) {
+            return 0;
+        }
+    }
+}
+
+// Function to append text to a frame file
+static int sink_write(FrameSink* sink, const char* data, size_t length)
+{
+    if (sink->gz) {
+        return sink_deflate(sink, data, length, Z_NO_FLUSH);
+    }
+    if (fwrite(data, 1, length, sink->file) != length) {
+        return -1;
+    }
+    sink->written += length;
+    return 0;
+}
+
+// Function to set up the deflate stream for a frame: created on the first .svgz frame, reset after
+static int start_gzip(ChunkedMorph* morph, int level)
+{
+    if (morph->gzip_level != level) {
+        gzip_context_free(&morph->gzip);
+        morph->gzip_level = -1;
+        if (gzip_context_init(&morph->gzip, level) == -1) {
+            return -1;
+        }
+        morph->gzip.out = (unsigned char*) malloc(CHUNK_GZIP_BUFFER);
+        if (morph->gzip.out == NULL) {
+            printf("Error: Could not allocate the compression buffer\n");
+            return -1;
+        }
+        morph->gzip.capacity = CHUNK_GZIP_BUFFER;
+        morph->gzip_level = level;
+    }
+    deflateReset(&morph->gzip.stream);  // Keeps the window and hash tables allocated
+    return 0;
+}
+
+// Function to fit one chunk of the outline with curves and format it as path data. The run starts
+// at point index first_key; the previous frame's breaks inside it seed the fit, and the breaks of
+// this fit are kept for the next frame
+static int format_path_chunk(ChunkedMorph* morph, long long first_key, int count, int* next_break, int start,
+                             int close, const CoordFormat* format)
+{
+    int num_hints = 0;
+    while (*next_break < morph->num_breaks && morph->breaks[*next_break] < first_key + count - 1) {
+        long long key = morph->breaks[(*next_break)++];
+        if (key > first_key) {
+            morph->chunk_hints[num_hints++] = (int)(key - first_key);
+        }
+    }
+    int pieces = curve_fit_run(&morph->fitter, morph->xs, morph->ys, count, morph->path_tolerance,
+                               morph->chunk_hints, num_hints);
+    if (pieces == -1) {
+        return -1;
+    }
+    if (morph->num_next_breaks + pieces > morph->next_capacity) {
+        int capacity = (morph->num_next_breaks + pieces) * 2;
+        long long* grown = (long long*) realloc(morph->next_breaks, capacity * sizeof(long long));
+        if (grown == NULL) {
+            printf("Error: Could not allocate curve breaks\n");
+            return -1;
+        }
+        morph->next_breaks = grown;
+        morph->next_capacity = capacity;
+    }
+    for (int k = 0; k + 1 < pieces; k++) {
+        morph->next_breaks[morph->num_next_breaks++] = first_key + morph->fitter.segments[k].end;
+    }
+    float first_point[2] = { morph->xs[0], morph->ys[0] };
+    return curve_format_path(&morph->fitter, morph->text, morph->text_size, start ? first_point : NULL, close,
+                             format);
+}
+
+// Function to write one frame, chunk by chunk
+int chunked_morph_write_frame(ChunkedMorph* morph, float t, const CoordFormat* format,
+                              const char* paint_attributes, const char* filename, int level)
+{
+    FrameSink sink = { NULL, NULL, 0 };
+    if (level >= 0) {
+        if (start_gzip(morph, level) == -1) {
+            return -1;
+        }
+        sink.gz = &morph->gzip;
+    }
+    // Written under a hidden temporary name and renamed once complete, like the frame writer's
+    // files, so an interrupted run leaves no partial frame and a linked file is replaced, not truncated
+    char temporary[FRAME_NAME_SIZE + 8];
+    if (frame_temporary_path(filename, temporary, sizeof(temporary)) == -1) {
+        return -1;
+    }
+    sink.file = fopen(temporary, "wb");
+    if (sink.file == NULL) {
+        printf("Error: Could not open file %s for writing\n", temporary);
+        return -1;
+    }
+
+    int as_path = (morph->path_tolerance > 0.0f);
+    const char* header = as_path ? "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n"
+                                   "  <path d='"
+                                 : "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n"
+                                   "  <polygon points='";
+    int status = sink_write(&sink, header, strlen(header));
+    int next_break = 0;
+    morph->num_next_breaks = 0;
+    for (long long base = 0; base < morph->num_points && status == 0; base += morph->chunk_points) {
+        long long remaining = morph->num_points - base;
+        int n = remaining < morph->chunk_points ? (int)remaining : morph->chunk_points;
+        // A path chunk is fitted from the previous chunk's last point, so the curve has no gaps
+        int carry = (as_path && base > 0);
+        float* xs = morph->xs + carry;
+        float* ys = morph->ys + carry;
+        const float* pair = morph->pairs + 4 * base;
+        for (int j = 0; j < n; j++, pair += 4) {
+            xs[j] = (1 - t) * pair[0] + t * pair[2];  // Straight path: exact at both ends
+            ys[j] = (1 - t) * pair[1] + t * pair[3];
+        }
+        // Simplified as an open run: its end points join the neighbouring chunks unchanged
+        if (morph->simplify_tolerance > 0.0f &&
+            (n = simplify_outline(&morph->scratch, xs, ys, n, 0, morph->simplify_tolerance)) == -1) {
+            status = -1;
+            break;
+        }
+        int length;
+        if (as_path) {
+            length = format_path_chunk(morph, base - carry, n + carry, &next_break, base == 0,
+                                       base + morph->chunk_points >= morph->num_points, format);
+            morph->xs[0] = xs[n - 1];
+            morph->ys[0] = ys[n - 1];
+        } else if (base == 0) {
+            length = format_points(morph->text, morph->text_size, xs, ys, n, format);
+        } else {
+            length = format_points_continued(morph->text, morph->text_size, xs, ys, n, format);
+        }
+        status = (length < 0) ? -1 : sink_write(&sink, morph->text, length);
+    }
+    if (as_path) {
+        // This frame's breaks seed the next frame
+        long long* swap = morph->breaks;
+        int capacity = morph->breaks_capacity;
+        morph->breaks = morph->next_breaks;
+        morph->breaks_capacity = morph->next_capacity;
+        morph->num_breaks = morph->num_next_breaks;
+        morph->next_breaks = swap;
+        morph->next_capacity = capacity;
+    }
+    if (status == 0) {
+        char footer[320];
+        int length = snprintf(footer, sizeof(footer), "' %s />\n</svg>\n", paint_attributes);
+        status = sink_write(&sink, footer, length);
+    }
+
+    if (status == 0 && sink.gz) {
+        status = sink_deflate(&sink, NULL, 0, Z_FINISH);
+    }
+    int closed = (fclose(sink.file) == 0) ? 0 : -1;
+    if (status == -1 || closed == -1) {
+        printf("Error: Could not write file %s\n", filename);
+        unlink(temporary);
+        return -1;
+    }
+    if (rename(temporary, filename) == -1) {
+        printf("Error: Could not move %s into place\n", filename);
+        unlink(temporary);
+        return -1;
+    }
+    morph->frame_bytes = sink.written;
+    return 0;
+}
+
+// Function to release the mapping and the chunk buffers
+void chunked_morph_close(ChunkedMorph* morph)
+{
+    if (morph->pairs) {
+        munmap((void*) morph->pairs, morph->mapped_bytes);
+    }
+    free(morph->xs);
+    free(morph->ys);
+    free(morph->text);
+    simplify_scratch_free(&morph->scratch);
+    curve_fitter_free(&morph->fitter);
+    free(morph->chunk_hints);
+    free(morph->breaks);
+    free(morph->next_breaks);
+    gzip_context_free(&morph->gzip);
+    memset(morph, 0, sizeof(ChunkedMorph));
+    morph->gzip_level = -1;
+}
@@ -0,0 +1,56 @@
+#ifndef CHUNKED_MORPH_H
+#define CHUNKED_MORPH_H
+
+#include <stddef.h>
+#include "svg_format.h"
+#include "simplify.h"
+#include "curve_fit.h"
+#include "frame_writer.h"   // GzipContext
+
+// Define an out-of-core morph between two outlines of any size. The paired source and target
+// points are spilled once to an unlinked file and mapped; frames are then evaluated, formatted
+// and written one chunk of points at a time, so memory stays bounded by the chunk size
+typedef struct {
+    long long num_points;        // points of the morphed outline
+    const float* pairs;          // num_points x {source x, source y, target x, target y}, mapped
+    size_t mapped_bytes;
+    const char* source_element;  // "polygon" or "circle", for reading the source paint
+    int chunk_points;
+    float* xs;                   // one chunk of evaluated points, after the last point of the previous chunk
+    float* ys;
+    char* text;                  // one chunk of formatted points
+    size_t text_size;
+    float simplify_tolerance;    // 0 writes every point
+    SimplifyScratch scratch;
+    float path_tolerance;        // above 0 writes a <path> of fitted curves instead of a <polygon>
+    CurveFitter fitter;
+    int* chunk_hints;            // the previous breaks that fall inside the current chunk
+    long long* breaks;           // where the previous frame's curve pieces ended, by point index
+    int num_breaks;
+    int breaks_capacity;
+    long long* next_breaks;      // the current frame's piece ends
+    int num_next_breaks;
+    int next_capacity;
+    GzipContext gzip;            // one deflate stream, reset for every .svgz frame
+    int gzip_level;              // level gzip was set up with, -1 before the first .svgz frame
+    long long frame_bytes;       // size of the last frame file written
+} ChunkedMorph;
+
+// Pair the first <polygon> (or <circle>, sampled to the target's size) of source_svg with the first
+// <polygon> of target_svg, resampling the shorter outline by length (as morph_outline_resample does),
+// and spill the pairs into spill_dir.
+// With a simplify_tolerance above 0 every chunk is simplified before it is written; chunk end
+// points are kept, so the whole outline stays within the tolerance. With a path_tolerance above 0
+// every chunk is fitted with cubic Béziers, starting from where the previous frame broke its curve.
+// Returns 0 on success and -1 on failure
+int chunked_morph_open(ChunkedMorph* morph, const char* source_svg, const char* target_svg,
+                       const char* spill_dir, int chunk_points, float simplify_tolerance, float path_tolerance);
+
+// Write the frame at factor t to filename, gzip-compressed at level 0-9 or plain when level is -1
+int chunked_morph_write_frame(ChunkedMorph* morph, float t, const CoordFormat* format,
+                              const char* paint_attributes, const char* filename, int level);
+
+// Unmap the pairs and release the chunk buffers
+void chunked_morph_close(ChunkedMorph* morph);
+
+#endif
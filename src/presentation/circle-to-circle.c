@@ -4,6 +4,8 @@
 #include <sys/types.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <string.h>
+#include "svg_format.h"  // quantized coordinate output
 
 //Extracting small_circle.svg to large_circle.svg and morphing
 // Define a structure to represent a Circle with its center and radius
@@ -29,7 +31,7 @@ void morph(Circle* start, Circle* end, float t, Circle* result)
 }
 
 // Function to generate an SVG file for the given circle, saving to cir folder
-void write_svg(Circle* circle, int frame_number) 
+void write_svg(Circle* circle, int frame_number, const CoordFormat* coord_format) 
 {
     char filename[100];
     // Generate filenames for each frame in the output_5 folder
@@ -44,7 +46,11 @@ void write_svg(Circle* circle, int frame_number)
 
     // Write the SVG content for the circle
     fprintf(file, "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n");
-    fprintf(file, "  <circle cx='%f' cy='%f' r='%f' fill='blue' />\n", circle->cx, circle->cy, circle->r);
+    char cx[32], cy[32], r[32];
+    format_number(cx, circle->cx, coord_format);
+    format_number(cy, circle->cy, coord_format);
+    format_number(r, circle->r, coord_format);
+    fprintf(file, "  <circle cx='%s' cy='%s' r='%s' fill='blue' />\n", cx, cy, r);
     fprintf(file, "</svg>\n");
 
     // Close the file after writing
@@ -111,8 +117,26 @@ int load_svg(const char* filename, Circle* circle)
     return 0;
 }
 
-int main() 
+int main(int argc, char** argv) 
 {
+    // Optional coordinate quantization: --precision N and/or --grid STEP
+    int decimals = -1;
+    float grid = 0.0f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            decimals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--precision N] [--grid STEP]\n", argv[0]);
+            return -1;
+        }
+    }
+    CoordFormat coord_format;
+    if (coord_format_init(&coord_format, decimals, grid) == -1) {
+        return -1;
+    }
+
     // Create the output_5 folder if it does not exist
     struct stat st = {0};
     if (stat("circle_to_circle", &st) == -1) {
@@ -142,7 +166,7 @@ int main()
         morph(&small_circle, &big_circle, t, &result);
 
         // Generate the corresponding SVG file for the current frame
-        write_svg(&result, (int)(t * 100));
+        write_svg(&result, (int)(t * 100), &coord_format);
     }
 
     return 0;
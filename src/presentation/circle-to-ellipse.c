@@ -3,6 +3,8 @@
 #include <sys/stat.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <string.h>
+#include "svg_format.h"  // quantized coordinate output
 
 // Define a structure to represent an Ellipse with center and two radii
 typedef struct {
@@ -26,7 +28,7 @@ void morph_circle_to_ellipse(Ellipse* start, Ellipse* end, float t, Ellipse* res
 }
 
 // Function to generate an SVG file for the ellipse
-void write_svg_ellipse(Ellipse* ellipse, int frame_number) {
+void write_svg_ellipse(Ellipse* ellipse, int frame_number, const CoordFormat* coord_format) {
     char filename[100];
     sprintf(filename, "circle_to_ellipse/frame_%d.svg", frame_number);
 
@@ -37,7 +39,12 @@ void write_svg_ellipse(Ellipse* ellipse, int frame_number) {
     }
 
     fprintf(file, "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n");
-    fprintf(file, "  <ellipse cx='%f' cy='%f' rx='%f' ry='%f' fill='blue' />\n", ellipse->cx, ellipse->cy, ellipse->rx, ellipse->ry);
+    char cx[32], cy[32], rx[32], ry[32];
+    format_number(cx, ellipse->cx, coord_format);
+    format_number(cy, ellipse->cy, coord_format);
+    format_number(rx, ellipse->rx, coord_format);
+    format_number(ry, ellipse->ry, coord_format);
+    fprintf(file, "  <ellipse cx='%s' cy='%s' rx='%s' ry='%s' fill='blue' />\n", cx, cy, rx, ry);
     fprintf(file, "</svg>\n");
 
     fclose(file);
@@ -96,7 +103,25 @@ int load_svg(const char* filename, Ellipse* ellipse) {
     return 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Optional coordinate quantization: --precision N and/or --grid STEP
+    int decimals = -1;
+    float grid = 0.0f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            decimals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--precision N] [--grid STEP]\n", argv[0]);
+            return -1;
+        }
+    }
+    CoordFormat coord_format;
+    if (coord_format_init(&coord_format, decimals, grid) == -1) {
+        return -1;
+    }
+
     // Create output directory if it doesn't exist
     struct stat st = {0};
     if (stat("circle_to_ellipse", &st) == -1) {
@@ -118,7 +143,7 @@ int main() {
     // Morph from circle to ellipse over 100 frames
     for (float t = 0.0; t <= 1.0; t += 0.01) {
         morph_circle_to_ellipse(&circle, &ellipse, t, &result);
-        write_svg_ellipse(&result, (int)(t * 100));
+        write_svg_ellipse(&result, (int)(t * 100), &coord_format);
     }
 
     return 0;
@@ -1,190 +1,1048 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
-#include <libxml/parser.h> //xml reads file library
-#include <libxml/tree.h> // extracts the points from the svg
 #include <math.h>
 #include <string.h>
 #include <time.h>  
 #include <sys/time.h>  //time execution
+#include <unistd.h>    // sysconf for the default writer thread count
+#include "morph_engine.h"   // SVG loading and the Bézier morph plan
+#include "paint.h"          // fill/stroke/opacity interpolated in linear light
+#include "easing.h"         // timing functions baked into a per-frame t table
+#include "svg_format.h"     // quantized coordinate output
+#include "raster.h"       // draws frames into pixels for the animation writers
+#include "anim_writer.h"  // GIF/APNG output straight from the frame loop
+#include "stream_writer.h" // Y4M/raw RGBA video stream for encoder pipelines
+#include "frame_writer.h"  // SVG/SVGZ frames written by background threads
+#include "run_cache.h"     // reuses the frames of identical earlier runs
+#include "chunked_morph.h" // bounded-memory mode for outlines with millions of points
+#include "shard.h"         // splits the frame range across processes, and merges the parts
+#include "simplify.h"      // drops vertices that stay within a distance tolerance
+#include "curve_fit.h"     // cubic Bézier <path> output instead of dense polygon points
+#include "arena.h"         // run-lifetime storage, so the frame loop never allocates
+#include "pipeline.h"      // serializes and writes frames on their own threads while the next is computed
+#include "logger.h"        // leveled, per-thread buffered messages and the progress reporter
+
+#define MAX_KEYFRAMES 32  // Keeps at least two palette samples per timeline segment
+
+// Define one computed frame on its way to the serialize stage: its outline and blended paint
+typedef struct {
+    int frame;
+    int num_points;
+    float paint[PAINT_NUM_CHANNELS];
+    float points[];         // num_points x coordinates, then num_points y coordinates
+} FrameItem;
+
+// Define one finished SVG document on its way to the write stage
+typedef struct {
+    int frame;
+    int length;
+    char document[];
+} FrameDocument;
+
+// Define what the serialize and write stages share over a run
+typedef struct {
+    FrameWriter* writer;
+    ShardManifest* manifest;    // NULL unless the run is a shard
+    const char* directory;
+    const char* extension;
+    const CoordFormat* coord_format;
+    float path_tolerance;       // > 0 writes a <path> of fitted curves instead of a <polygon>
+    int max_points;
+    size_t points_text_size;
+    size_t document_size;
+} FrameStages;
+
+// Define the scratch state of one serialize thread
+typedef struct {
+    CurveFitter fitter;     // each frame's fit starts from the previous frame's pieces
+    char* points_text;
+} FrameSerializer;
 
 // Function prototypes for functions defined later
-int extract_circle_info(const char* svg_file, float* cx, float* cy, float* r);
-int extract_triangle_info(const char* svg_file, float triangle[3][2]);
-float bezier_point(float p0, float p1, float p2, float t);
-void write_svg(char* interpolated_points, int frame_number);
-
-// Function to extract circle attributes (cx, cy, r) from an SVG file
-int extract_circle_info(const char* svg_file, float* cx, float* cy, float* r)
- {
-    xmlDoc *doc = xmlReadFile(svg_file, NULL, 0);  // Load the SVG file as an XML document
-    if (doc == NULL) {
-        printf("Error: Could not parse file %s\n", svg_file);
-        return -1;  // Return -1 if file loading fails
-    }
-
-    // Access the root element and iterate to find <circle>
-    xmlNode *root_element = xmlDocGetRootElement(doc);
-    xmlNode *node = root_element->children;
-    while (node) {
-        if (node->type == XML_ELEMENT_NODE && xmlStrcmp(node->name, (const xmlChar *)"circle") == 0) {
-            // Extract 'cx', 'cy', and 'r' attributes from <circle>
-            xmlChar* cx_str = xmlGetProp(node, (const xmlChar *)"cx");
-            xmlChar* cy_str = xmlGetProp(node, (const xmlChar *)"cy");
-            xmlChar* r_str = xmlGetProp(node, (const xmlChar *)"r");
-
-            if (cx_str && cy_str && r_str) {  // If all attributes are present
-                *cx = atof((const char *)cx_str);  // Convert cx to float and assign
-                *cy = atof((const char *)cy_str);  // Convert cy to float and assign
-                *r = atof((const char *)r_str);    // Convert r to float and assign
-
-                // Free allocated memory for attribute strings
-                xmlFree(cx_str);
-                xmlFree(cy_str);
-                xmlFree(r_str);
-                xmlFreeDoc(doc);  // Free the document after parsing
-                return 0;  // Successfully extracted attributes
-            }
-        }
-        node = node->next;  // Move to the next node
-    }
-
-    xmlFreeDoc(doc);  // Free the document if no <circle> is found
-    return -1;  // Return -1 if circle information could not be extracted
+void* frame_serializer_create(void* context);
+void frame_serializer_free(void* worker);
+int serialize_svg(void* context, void* worker, const void* item, void* out);
+int write_svg(void* context, const void* out);
+int build_run_key(RunKey* key, const char* source_svg, const char* target_svg, int total_frames, int num_points,
+                  const Easing* easing, const CoordFormat* coord_format, FrameOutput frame_output, int level,
+                  float adaptive_tolerance, int delay_ms, float simplify_tolerance, float path_tolerance,
+                  char** keyframes, const float* key_times, int num_keys);
+MorphTimeline* load_keyframe_timeline(Arena* arena, char** keyframes, const float* key_times, int num_keys,
+                                      int min_points, PaintSet* segment_paints);
+int write_timeline(const char* path, const int* selected, int num_selected, int total_frames,
+                   const float* frame_times, int delay_ms);
+int run_chunked_morph(const char* source_svg, const char* target_svg, int total_frames, int chunk_points,
+                      const Easing* easing, const CoordFormat* coord_format, FrameOutput frame_output, int level,
+                      float simplify_tolerance, float path_tolerance, int progress_ms);
+void print_execution_time(const struct timeval* start);
+void print_usage(const char* program);
+
+// Function to set up one serialize thread: a curve fitter and a text buffer sized for the
+// largest frame, so serializing never allocates
+void* frame_serializer_create(void* context)
+{
+    const FrameStages* stages = (const FrameStages*) context;
+    FrameSerializer* serializer = (FrameSerializer*) malloc(sizeof(FrameSerializer));
+    if (serializer == NULL) {
+        return NULL;
+    }
+    curve_fitter_init(&serializer->fitter);
+    serializer->points_text = (char*) malloc(stages->points_text_size);
+    if (serializer->points_text == NULL ||
+        (stages->path_tolerance > 0.0f && curve_fitter_reserve(&serializer->fitter, stages->max_points) == -1)) {
+        frame_serializer_free(serializer);
+        return NULL;
+    }
+    return serializer;
+}
+
+// Function to release a serialize thread's scratch state
+void frame_serializer_free(void* worker)
+{
+    FrameSerializer* serializer = (FrameSerializer*) worker;
+    curve_fitter_free(&serializer->fitter);
+    free(serializer->points_text);
+    free(serializer);
 }
 
-// Function to extract triangle points from an SVG file's <polygon> element
-int extract_triangle_info(const char* svg_file, float triangle[3][2]) 
+// Function to turn a computed frame into its SVG document (a polygon, or a path with fitted curves)
+int serialize_svg(void* context, void* worker, const void* item, void* out)
 {
-    xmlDoc *doc = xmlReadFile(svg_file, NULL, 0);  // Load the SVG file as an XML document
-    if (doc == NULL) {
-        printf("Error: Could not parse file %s\n", svg_file);
+    const FrameStages* stages = (const FrameStages*) context;
+    FrameSerializer* serializer = (FrameSerializer*) worker;
+    const FrameItem* frame = (const FrameItem*) item;
+    FrameDocument* result = (FrameDocument*) out;
+    const float* points_x = frame->points;
+    const float* points_y = frame->points + frame->num_points;
+    int as_path = stages->path_tolerance > 0.0f;
+
+    float start[2] = { points_x[0], points_y[0] };
+    if (as_path
+            ? (curve_fit_outline(&serializer->fitter, points_x, points_y, frame->num_points,
+                                 stages->path_tolerance) == -1 ||
+               curve_format_path(&serializer->fitter, serializer->points_text, stages->points_text_size, start, 1,
+                                 stages->coord_format) == -1)
+            : format_points(serializer->points_text, stages->points_text_size, points_x, points_y,
+                            frame->num_points, stages->coord_format) == -1) {
+        printf("Error: Points of frame %d do not fit the SVG buffer\n", frame->frame);
         return -1;
     }
 
-    // Aaccess the root element and find <polygon> representing a triangle
-    xmlNode *root_element = xmlDocGetRootElement(doc);
-    xmlNode *node = root_element->children;
-    while (node) {
-        if (node->type == XML_ELEMENT_NODE && xmlStrcmp(node->name, (const xmlChar *)"polygon") == 0) {
-            xmlChar* points_str = xmlGetProp(node, (const xmlChar *)"points");
+    // The paint attributes read the item's blended channels in place
+    PaintSet paint = { 1, 1, { 0 } };
+    for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+        paint.channels[c] = (float*) &frame->paint[c];
+    }
+    char paint_attributes[256];
+    paint_format_attributes(&paint, 0, paint_attributes, sizeof(paint_attributes));
 
-            if (points_str) {  //Extract 'points' attribute containing triangle vertices
-                sscanf((const char *)points_str, "%f,%f %f,%f %f,%f",
-                       &triangle[0][0], &triangle[0][1],  // Vertex 1
-                       &triangle[1][0], &triangle[1][1],  // Vertex 2
-                       &triangle[2][0], &triangle[2][1]); // Vertex 3
+	//We write the template to make this an svg and write in the polygon points within the child nodes
+    const char* layout = as_path ? "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n"
+                                   "  <path d='%s' %s />\n"
+                                   "</svg>\n"
+                                 : "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n"
+                                   "  <polygon points='%s' %s />\n"
+                                   "</svg>\n";
+    int length = snprintf(result->document, stages->document_size, layout, serializer->points_text,
+                          paint_attributes);
+    if (length < 0 || (size_t)length >= stages->document_size) {
+        printf("Error: Frame %d does not fit the SVG buffer\n", frame->frame);
+        return -1;
+    }
+    result->frame = frame->frame;
+    result->length = length;
+    return 0;
+}
 
-                xmlFree(points_str);  // Free the string after use
-                xmlFreeDoc(doc);  // 	 Free the document
-                return 0;  // 			 Successfully extracted triangle points
+// Function to save a frame's SVG document; the frame writer compresses and writes it in the
+// background
+int write_svg(void* context, const void* out)
+{
+    const FrameStages* stages = (const FrameStages*) context;
+    const FrameDocument* result = (const FrameDocument*) out;
+
+    // Generate unique filename for each frame
+    char filename[FRAME_NAME_SIZE + 1];  // One byte more than the writer takes: a cut name is refused
+    snprintf(filename, sizeof(filename), "%s/frame_%03d.%s", stages->directory, result->frame, stages->extension);
+    if (stages->manifest) {
+        shard_manifest_frame(stages->manifest, result->frame, result->document, result->length);  // What the merge will check
+    }
+    return frame_writer_submit(stages->writer, filename, result->document, result->length);
+}
+
+// Function to hash everything that determines the frame files: both input SVGs and every option
+int build_run_key(RunKey* key, const char* source_svg, const char* target_svg, int total_frames, int num_points,
+                  const Easing* easing, const CoordFormat* coord_format, FrameOutput frame_output, int level,
+                  float adaptive_tolerance, int delay_ms, float simplify_tolerance, float path_tolerance,
+                  char** keyframes, const float* key_times, int num_keys)
+{
+    run_key_init(key);
+    run_key_add_param(key, "circle-to-triangle frames v1");  // Bump when the output format changes
+    if (num_keys > 0) {
+        // A timeline replaces the source and target with its keyframes
+        run_key_add_param(key, "keyframes=%d", num_keys);
+        for (int k = 0; k < num_keys; k++) {
+            if (run_key_add_file(key, keyframes[k]) == -1) {
+                return -1;
             }
+            run_key_add_param(key, "at=%a", key_times ? key_times[k] : (float)k);
+        }
+    } else if (run_key_add_file(key, source_svg) == -1 || run_key_add_file(key, target_svg) == -1) {
+        return -1;
+    }
+    run_key_add_param(key, "frames=%d points=%d", total_frames, num_points);
+    run_key_add_param(key, "ease=%d %a %a %a %a %d", (int)easing->kind, easing->params[0], easing->params[1],
+                      easing->params[2], easing->params[3], easing->jump_start);
+    run_key_add_param(key, "decimals=%d grid=%a", coord_format->decimals, coord_format->grid);
+    run_key_add_param(key, "output=%d level=%d", (int)frame_output, frame_output == FRAME_OUTPUT_SVG ? 0 : level);
+    if (adaptive_tolerance > 0.0f) {
+        // Adaptive runs keep other frames and write a timeline; uniform runs keep their old keys
+        run_key_add_param(key, "adaptive=%a delay=%d", adaptive_tolerance, delay_ms);
+    }
+    if (simplify_tolerance > 0.0f) {
+        run_key_add_param(key, "simplify=%a", simplify_tolerance);
+    }
+    if (path_tolerance > 0.0f) {
+        run_key_add_param(key, "path=%a", path_tolerance);
+    }
+    return 0;
+}
+
+// Function to load keyframe SVGs (a <polygon>, or else a <circle>) into a spline timeline in the run arena. Every
+// outline is brought to the largest vertex count (at least min_points); segment_paints receives the
+// paired paint of both ends of every segment
+MorphTimeline* load_keyframe_timeline(Arena* arena, char** keyframes, const float* key_times, int num_keys,
+                                      int min_points, PaintSet* segment_paints)
+{
+    float* outlines[MAX_KEYFRAMES] = { NULL };
+    float* keys[MAX_KEYFRAMES] = { NULL };
+    int counts[MAX_KEYFRAMES];
+    float circles[MAX_KEYFRAMES][3];
+    float paints[MAX_KEYFRAMES][PAINT_NUM_CHANNELS];
+    MorphTimeline* timeline = NULL;
+    int num_points = min_points, status = 0;
+    for (int k = 0; k < num_keys && status == 0; k++) {
+        counts[k] = extract_polygon_points(keyframes[k], &outlines[k]);
+        const char* element = "polygon";
+        if (counts[k] < 1) {
+            counts[k] = 0;
+            element = "circle";
+            if (extract_circle_info(keyframes[k], &circles[k][0], &circles[k][1], &circles[k][2]) == -1) {
+                printf("Error: Keyframe %s has no <polygon> with points and no <circle>\n", keyframes[k]);
+                status = -1;
+            }
+        }
+        if (status == 0 && extract_paint_info(keyframes[k], element, paints[k]) == -1) {
+            printf("Error: Could not extract paint info of keyframe %s\n", keyframes[k]);
+            status = -1;
+        }
+        if (counts[k] > num_points) {
+            num_points = counts[k];
         }
-        node = node->next;  // Move to the next node
     }
 
-    xmlFreeDoc(doc);  // Free the document if no <polygon> is found
-    return -1;  // Return -1 if triangle points could not be extracted
+    // Every keyframe gets the same number of points, in outline order
+    for (int k = 0; k < num_keys && status == 0; k++) {
+        keys[k] = (float*) malloc((size_t)num_points * 2 * sizeof(float));
+        if (keys[k] == NULL) {
+            printf("Error: Could not allocate keyframe %d\n", k);
+            status = -1;
+        } else if (counts[k] > 0) {
+            morph_outline_resample(outlines[k], counts[k], num_points, keys[k]);
+        } else {
+            morph_outline_circle(circles[k][0], circles[k][1], circles[k][2], num_points, keys[k]);
+        }
+    }
+    if (status == 0) {
+        timeline = morph_timeline_create_in(arena, num_keys, num_points, (const float* const*) keys, key_times);
+    }
+
+    // Paint fades linearly within each segment; a "none" end takes the other end's color
+    for (int s = 0; timeline && s < num_keys - 1; s++) {
+        if (paint_set_init(&segment_paints[2 * s], 1) == -1 || paint_set_init(&segment_paints[2 * s + 1], 1) == -1) {
+            timeline = NULL;
+            break;
+        }
+        paint_set_add(&segment_paints[2 * s], paints[s]);
+        paint_set_add(&segment_paints[2 * s + 1], paints[s + 1]);
+        paint_set_pair(&segment_paints[2 * s], &segment_paints[2 * s + 1]);
+    }
+    for (int k = 0; k < num_keys; k++) {
+        free(outlines[k]);
+        free(keys[k]);
+    }
+    return timeline;
 }
 
-// Function to calculate a quadratic Bézier curve point given three points and a factor `t`
-float bezier_point(float p0, float p1, float p2, float t) 
+// Function to write the timestamps of an adaptive run: each output frame, the candidate frame it
+// shows, when it appears and how long it stays on screen
+int write_timeline(const char* path, const int* selected, int num_selected, int total_frames,
+                   const float* frame_times, int delay_ms)
 {
-    // Quadratic Bézier formula to smoothly transition from p0 to p2, with p1 as control
-    return pow(1 - t, 2) * p0 + 2 * (1 - t) * t * p1 + t * t * p2;
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error: Could not open file %s for writing\n", path);
+        return -1;
+    }
+    fprintf(file, "# morph timeline v1: %d of %d frames, %d ms per candidate frame\n", num_selected,
+            total_frames, delay_ms);
+    fprintf(file, "# frame candidate time_ms duration_ms t\n");
+    for (int e = 0; e < num_selected; e++) {
+        int next = (e + 1 < num_selected) ? selected[e + 1] : total_frames;
+        fprintf(file, "%d %d %lld %lld %.6f\n", e, selected[e], (long long)selected[e] * delay_ms,
+                (long long)(next - selected[e]) * delay_ms, frame_times[selected[e]]);
+    }
+    if (fclose(file) != 0) {
+        printf("Error: Could not write file %s\n", path);
+        return -1;
+    }
+    return 0;
 }
 
-// Function to save the current interpolated frame to an SVG file
-void write_svg(char* interpolated_points, int frame_number) 
+// Function to morph outlines of any size with bounded memory: the points are paired once into a
+// mapped spill file, then every frame is evaluated and written one chunk of points at a time
+int run_chunked_morph(const char* source_svg, const char* target_svg, int total_frames, int chunk_points,
+                      const Easing* easing, const CoordFormat* coord_format, FrameOutput frame_output, int level,
+                      float simplify_tolerance, float path_tolerance, int progress_ms)
 {
-    // Generate unique filename for each frame
-    char filename[256];
-    sprintf(filename, "./circle_to_triangle/frame_%03d.svg", frame_number);
+    const char* directory = "./circle_to_triangle";
+    struct stat st = {0};
+    if (stat(directory, &st) == -1) {
+        mkdir(directory, 0700);
+    }
+    ChunkedMorph morph;
+    if (chunked_morph_open(&morph, source_svg, target_svg, directory, chunk_points, simplify_tolerance,
+                           path_tolerance) == -1) {
+        return -1;
+    }
+    printf("Chunked morph: %lld points, %d per chunk\n", morph.num_points, chunk_points);
 
-	//Open the file for writing and write.
-    FILE* file = fopen(filename, "w");
-    if (file == NULL) {
-        printf("Error: Could not open file %s for writing\n", filename);
-        return;
+    float source_paint[PAINT_NUM_CHANNELS], target_paint[PAINT_NUM_CHANNELS];
+    PaintSet paint_start, paint_final, paint_frame;
+    if (extract_paint_info(source_svg, morph.source_element, source_paint) == -1 ||
+        extract_paint_info(target_svg, "polygon", target_paint) == -1) {
+        printf("Error: Could not extract paint info.\n");
+        chunked_morph_close(&morph);
+        return -1;
     }
-	
-	//We write the template to make this an svg and write in the polygon points within the child nodes
-    fprintf(file, "<svg width='500' height='500' xmlns='http://www.w3.org/2000/svg'>\n");
-    fprintf(file, "  <polygon points='%s' fill='blue' />\n", interpolated_points);
-    fprintf(file, "</svg>\n");
+    float* frame_times = easing_bake(easing, total_frames);
+    if (frame_times == NULL || paint_set_init(&paint_start, 1) == -1 || paint_set_init(&paint_final, 1) == -1 ||
+        paint_set_init(&paint_frame, 1) == -1) {
+        chunked_morph_close(&morph);
+        return -1;
+    }
+    paint_set_add(&paint_start, source_paint);
+    paint_set_add(&paint_final, target_paint);
+    paint_set_pair(&paint_start, &paint_final);
 
-    fclose(file);  // Close the file after writing
-    printf("File %s created successfully.\n", filename);
+    // A reporter thread logs frames/s and bytes written at a fixed interval, as for the in-memory morph
+    Progress* progress = progress_start("circle_to_triangle", total_frames, progress_ms);
+    const char* extension = (frame_output == FRAME_OUTPUT_SVGZ) ? "svgz" : "svg";
+    int status = progress ? 0 : -1;
+    for (int frame = 0; frame < total_frames && status == 0; frame++) {
+        paint_set_interpolate(&paint_start, &paint_final, frame_times[frame], &paint_frame);
+        char paint_attributes[256];
+        paint_format_attributes(&paint_frame, 0, paint_attributes, sizeof(paint_attributes));
+        char filename[1024];
+        snprintf(filename, sizeof(filename), "%s/frame_%03d.%s", directory, frame, extension);
+        status = chunked_morph_write_frame(&morph, frame_times[frame], coord_format, paint_attributes, filename,
+                                           frame_output == FRAME_OUTPUT_SVGZ ? level : -1);
+        if (status == 0) {
+            log_message(LOG_DEBUG, "File %s created successfully.\n", filename);
+            progress_add(progress, 1, morph.frame_bytes);
+        }
+    }
+    progress_finish(progress);
+
+    chunked_morph_close(&morph);
+    free(frame_times);
+    paint_set_free(&paint_start);
+    paint_set_free(&paint_final);
+    paint_set_free(&paint_frame);
+    log_flush();
+    return status;
+}
+
+// Function to print the wall-clock time since start
+void print_execution_time(const struct timeval* start)
+{
+    struct timeval end;
+    gettimeofday(&end, NULL);  // Record the wall-clock end time
+
+    // Calculate the time difference in seconds with millisecond precision
+    double time_taken = (end.tv_sec - start->tv_sec) + (end.tv_usec - start->tv_usec) / 1e6;
+    printf("Execution Time: %.3f seconds\n", time_taken);
+}
+
+// Function to print the command line options
+void print_usage(const char* program)
+{
+    printf("Usage: %s [--frames N] [--gif FILE] [--apng FILE] [--delay MS] [--no-svg]\n", program);
+    printf("       [--stream PATH|-] [--stream-format y4m|rgba] [--fps N] [--ease F]\n");
+    printf("       [--precision N] [--grid STEP] [--svgz] [--svgz-stream FILE] [--level N] [--writer-threads N]\n");
+    printf("       [--serialize-threads N] [--pipeline-memory MB] [--log-level L] [--progress S]\n");
+    printf("       [--cache DIR] [--cache-size MB] [--source FILE] [--target FILE] [--chunked] [--chunk-points N]\n");
+    printf("       [--shard i/N] [--merge N] [--adaptive PX] [--simplify PX] [--path PX] [--keyframe FILE[@T]]...\n");
+    printf("  --frames N   number of frames to generate (default 100000)\n");
+    printf("  --gif FILE   also write the animation as a GIF\n");
+    printf("  --apng FILE  also write the animation as an animated PNG\n");
+    printf("  --delay MS   delay between animation frames in milliseconds (default 40)\n");
+    printf("  --no-svg     skip the per-frame SVG files\n");
+    printf("  --stream P   stream rendered frames to a file, FIFO or stdout (-)\n");
+    printf("  --stream-format F  y4m (default) or rgba\n");
+    printf("  --fps N      frame rate written in the Y4M header (default 25)\n");
+    printf("  --ease F     timing function applied to t (default linear)\n");
+    easing_print_help();
+    printf("  --precision N  write coordinates with at most N decimals (default: %%f)\n");
+    printf("  --grid STEP    snap coordinates to multiples of STEP, e.g. 0.25\n");
+    printf("  --svgz         write gzip-compressed .svgz frames\n");
+    printf("  --svgz-stream FILE  write all frames in order into one gzip file\n");
+    printf("  --level N      compression level 0-9 (default 6)\n");
+    printf("  --writer-threads N  threads compressing and writing frames (default: one per core)\n");
+    printf("  --serialize-threads N  threads formatting SVG documents while frames are computed (default 1)\n");
+    printf("  --pipeline-memory MB  bound on the frames queued between the compute, format and write\n");
+    printf("                 stages (default 64)\n");
+    printf("  --log-level L  error, warning, info (default) or debug, which adds one line per written frame\n");
+    printf("  --progress S   report frames/s, bytes written and the ETA on stderr every S seconds\n");
+    printf("                 (default 1, 0 for the final summary only)\n");
+    printf("  --cache DIR    reuse the frames of an identical earlier run stored in DIR\n");
+    printf("  --cache-size MB  evict least recently used runs beyond this size (default 1024)\n");
+    printf("  --source FILE  SVG with the starting <circle> (or <polygon> with --chunked)\n");
+    printf("  --target FILE  SVG with the final <polygon>\n");
+    printf("  --chunked      morph outlines of any size with bounded memory, writing frames chunk by chunk\n");
+    printf("  --chunk-points N  points evaluated and written per chunk with --chunked (default 4096)\n");
+    printf("  --shard i/N    compute only shard i (0-based) of N equal frame ranges, with a manifest\n");
+    printf("  --merge N      verify the N shards of a run (same options) and assemble a --svgz-stream\n");
+    printf("  --adaptive PX  of the --frames candidates (--delay MS apart), emit only those where a vertex\n");
+    printf("                 moved more than PX pixels since the last emitted frame; timestamps go to\n");
+    printf("                 timeline.txt (or FILE.timeline.txt for --svgz-stream) and the GIF/APNG delays\n");
+    printf("  --simplify PX  drop vertices from each frame while the outline stays within PX pixels\n");
+    printf("  --path PX      write each frame as a <path> of cubic Béziers fitted within PX pixels\n");
+    printf("  --keyframe FILE[@T]  morph through 2 to %d keyframe SVGs in order (<polygon> or <circle>), every\n",
+           MAX_KEYFRAMES);
+    printf("                 point on a Catmull-Rom spline; T places the keyframe in time (default: evenly)\n");
 }
 
 // main func
-int main() 
+int main(int argc, char** argv) 
 {
 	//stop watch object
-	struct timeval start, end;
+	struct timeval start;
     gettimeofday(&start, NULL);  // record the wall-clock start time
 
-    // Variables for circle center and radius
-    float cx, cy, r;
-    float triangle_vertices[3][2];  // Array to store triangle vertices
+    // Command line options
+    int total_frames = 100000;  // Total number of frames in the morphing animation
+    const char* gif_file = NULL;
+    const char* apng_file = NULL;
+    int delay_ms = 40;
+    int write_svg_frames = 1;
+    const char* stream_path = NULL;
+    StreamFormat stream_format = STREAM_Y4M;
+    int fps = 25;
+    Easing easing = { EASE_LINEAR, { 0 }, 0 };
+    int decimals = -1;
+    float grid = 0.0f;
+    FrameOutput frame_output = FRAME_OUTPUT_SVG;
+    const char* svgz_stream = NULL;
+    int level = 6;
+    int writer_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int serialize_threads = 1;
+    long long pipeline_megabytes = 64;
+    LogLevel log_level = LOG_INFO;
+    float progress_seconds = 1.0f;
+    const char* cache_dir = NULL;
+    long long cache_megabytes = 1024;
+    const char* source_svg = "../../svg/small_circle.svg";
+    const char* target_svg = "../../svg/triangle.svg";
+    int chunked = 0;
+    int chunk_points = 4096;
+    ShardSpec shard = { 0, 1 };
+    int sharded = 0;
+    int merge_shards = 0;
+    float adaptive_tolerance = 0.0f;  // 0 = uniform frames
+    float simplify_tolerance = 0.0f;  // 0 = every vertex is written
+    float path_tolerance = 0.0f;      // 0 = <polygon> output
+    char* keyframes[MAX_KEYFRAMES];
+    float key_times[MAX_KEYFRAMES];
+    int num_keys = 0;
+    int num_timed_keys = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            total_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--gif") == 0 && i + 1 < argc) {
+            gif_file = argv[++i];
+        } else if (strcmp(argv[i], "--apng") == 0 && i + 1 < argc) {
+            apng_file = argv[++i];
+        } else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            delay_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-svg") == 0) {
+            write_svg_frames = 0;
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            stream_path = argv[++i];
+        } else if (strcmp(argv[i], "--stream-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "y4m") == 0) {
+                stream_format = STREAM_Y4M;
+            } else if (strcmp(argv[i], "rgba") == 0) {
+                stream_format = STREAM_RGBA;
+            } else {
+                print_usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            decimals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--svgz") == 0) {
+            frame_output = FRAME_OUTPUT_SVGZ;
+        } else if (strcmp(argv[i], "--svgz-stream") == 0 && i + 1 < argc) {
+            frame_output = FRAME_OUTPUT_STREAM;
+            svgz_stream = argv[++i];
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--writer-threads") == 0 && i + 1 < argc) {
+            writer_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--serialize-threads") == 0 && i + 1 < argc) {
+            serialize_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline-memory") == 0 && i + 1 < argc) {
+            pipeline_megabytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (log_parse_level(argv[++i], &log_level) == -1) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--progress") == 0 && i + 1 < argc) {
+            progress_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+            cache_megabytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            source_svg = argv[++i];
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            target_svg = argv[++i];
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            if (shard_parse(argv[++i], &shard) == -1) {
+                return -1;
+            }
+            sharded = 1;
+        } else if (strcmp(argv[i], "--merge") == 0 && i + 1 < argc) {
+            merge_shards = atoi(argv[++i]);
+            if (merge_shards < 1) {
+                print_usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc) {
+            adaptive_tolerance = atof(argv[++i]);
+            if (adaptive_tolerance <= 0.0f) {
+                printf("Error: --adaptive expects a tolerance above 0 pixels.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--simplify") == 0 && i + 1 < argc) {
+            simplify_tolerance = atof(argv[++i]);
+            if (simplify_tolerance <= 0.0f) {
+                printf("Error: --simplify expects a tolerance above 0 pixels.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--path") == 0 && i + 1 < argc) {
+            path_tolerance = atof(argv[++i]);
+            if (path_tolerance <= 0.0f) {
+                printf("Error: --path expects a tolerance above 0 pixels.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--keyframe") == 0 && i + 1 < argc) {
+            if (num_keys == MAX_KEYFRAMES) {
+                printf("Error: At most %d keyframes are supported.\n", MAX_KEYFRAMES);
+                return -1;
+            }
+            // FILE@T only when everything after the last '@' is a number, so paths may contain '@'
+            char* at = strrchr(argv[++i], '@');
+            char* end = NULL;
+            float key_time = at ? strtof(at + 1, &end) : 0.0f;
+            if (at && end != at + 1 && *end == '\0') {
+                *at = '\0';  // The file name ends where the time begins
+                key_times[num_keys] = key_time;
+                num_timed_keys++;
+            }
+            keyframes[num_keys++] = argv[i];
+        } else if (strcmp(argv[i], "--chunked") == 0) {
+            chunked = 1;
+        } else if (strcmp(argv[i], "--chunk-points") == 0 && i + 1 < argc) {
+            chunk_points = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ease") == 0 && i + 1 < argc) {
+            if (easing_parse(argv[++i], &easing) == -1) {
+                return -1;
+            }
+        } else {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    log_set_level(log_level);
+    if (progress_seconds < 0.0f) {
+        printf("Error: --progress expects an interval of 0 seconds or more.\n");
+        return -1;
+    }
+    if (total_frames < 2) {
+        printf("Error: At least 2 frames are needed.\n");
+        return -1;
+    }
+    CoordFormat coord_format;
+    if (coord_format_init(&coord_format, decimals, grid) == -1) {
+        return -1;
+    }
 
-    // Load circle information from the SVG file
-    if (extract_circle_info("../../svg/small_circle.svg", &cx, &cy, &r) == -1) {
-        printf("Error: Could not extract circle info.\n");
+    int num_circle_points = 30;  // Number of points along the circle to morph
+    if (num_keys == 1 || (num_timed_keys > 0 && num_timed_keys < num_keys)) {
+        printf("Error: A timeline needs at least 2 keyframes, either all with a time or none.\n");
+        return -1;
+    }
+    const float* keyframe_times = num_timed_keys ? key_times : NULL;
+    if (num_keys > 0 && chunked) {
+        printf("Error: --keyframe does not combine with --chunked.\n");
         return -1;
     }
 
-    // Load triangle vertex coordinates from the SVG file
-    if (extract_triangle_info("../../svg/triangle.svg", triangle_vertices) == -1) {
-        printf("Error: Could not extract triangle info.\n");
+    // Adaptive frames have their own timing, which a constant-rate stream or a fixed split cannot carry
+    if (adaptive_tolerance > 0.0f && (stream_path || sharded || merge_shards || chunked)) {
+        printf("Error: --adaptive does not combine with --stream, --shard, --merge or --chunked.\n");
+        return -1;
+    }
+    if (serialize_threads < 1 || pipeline_megabytes < 1) {
+        printf("Error: --serialize-threads and --pipeline-memory expect a value of at least 1.\n");
         return -1;
     }
+    // A path frame's fit is seeded by the frame before it, so one thread has to fit them in order
+    if (serialize_threads > 1 && path_tolerance > 0.0f) {
+        log_message(LOG_INFO, "Note: --path fits every frame from the previous one; using 1 serialize thread.\n");
+        serialize_threads = 1;
+    }
 
-    int num_circle_points = 30;  // Number of points along the circle to morph
-    float control_points[3][2] = {  // Control points for Bézier curve transition
-        {cx + 0.5 * r, cy},         // Control point for 1st vertex
-        {cx, cy - 0.5 * r},         // Control point for 2nd vertex
-        {cx - 0.5 * r, cy}          // Control point for 3rd vertex
-    };
+    // Shards split the frame files of one run; the merge recomputes the run's key to match them up
+    char run_key[33] = "";
+    if (sharded || merge_shards) {
+        RunKey key;
+        if (gif_file || apng_file || stream_path || cache_dir || chunked || !write_svg_frames ||
+            (sharded && merge_shards)) {
+            printf("Error: --shard and --merge only apply to SVG, SVGZ or --svgz-stream frames.\n");
+            return -1;
+        }
+        if (build_run_key(&key, source_svg, target_svg, total_frames, num_circle_points, &easing, &coord_format,
+                          frame_output, level, 0.0f, delay_ms, simplify_tolerance, path_tolerance, keyframes,
+                          keyframe_times, num_keys) == -1) {
+            return -1;
+        }
+        run_key_format(&key, run_key);
+    }
+    if (merge_shards) {
+        const char* extension = (frame_output == FRAME_OUTPUT_SVGZ) ? "svgz" : "svg";
+        if (shard_merge("./circle_to_triangle", merge_shards, run_key, total_frames, extension, svgz_stream) == -1) {
+            return -1;
+        }
+        print_execution_time(&start);
+        return 0;
+    }
 
-    int total_frames = 100000;  // Total number of frames in the morphing animation
-    for (int frame = 0; frame < total_frames; frame++) {
-        float t = (float)frame / (total_frames - 1);  // `t` ranges from 0 to 1 smoothly
-		
-		// Couldn't have used the bezier curve method without these lines of code from 3rd source ( 159 - 175)
-        char interpolated_points[1024] = "";  // String to hold interpolated points for SVG
-        char point[50];  // Temporary buffer to store each interpolated point
+    // Outlines too big for the in-memory pipeline take the chunked path, which only writes frame files
+    if (chunked) {
+        if (gif_file || apng_file || stream_path || cache_dir || !write_svg_frames ||
+            frame_output == FRAME_OUTPUT_STREAM) {
+            printf("Error: --chunked only writes per-frame SVG or SVGZ files.\n");
+            return -1;
+        }
+        if (run_chunked_morph(source_svg, target_svg, total_frames, chunk_points, &easing, &coord_format,
+                              frame_output, level, simplify_tolerance, path_tolerance,
+                              (int)(progress_seconds * 1000.0f + 0.5f)) == -1) {
+            return -1;
+        }
+        print_execution_time(&start);
+        return 0;
+    }
+
+    // The plan or timeline and the frame geometry live as long as the run
+    Arena run_arena;
+    arena_init(&run_arena, 1 << 20);
+
+    // Each segment of the animation blends the paint of its two ends; a plain morph is one segment
+    PaintSet segment_paints[2 * (MAX_KEYFRAMES - 1)];
+    int num_segments = 1;
+    MorphPlan* plan = NULL;
+    MorphTimeline* timeline = NULL;
+    int shape_points = num_circle_points;
+    if (num_keys > 0) {
+        // Keyframes: every point follows a spline through all of them
+        timeline = load_keyframe_timeline(&run_arena, keyframes, keyframe_times, num_keys, num_circle_points,
+                                          segment_paints);
+        if (timeline == NULL) {
+            return -1;
+        }
+        num_segments = num_keys - 1;
+        shape_points = timeline->num_points;
+        log_message(LOG_INFO, "Timeline: %d keyframes, %d points\n", num_keys, shape_points);  // stderr: stdout may carry --stream -
+    } else {
+        // Variables for circle center and radius
+        float cx, cy, r;
+        float triangle_vertices[3][2];  // Array to store triangle vertices
+
+        // Load circle information from the SVG file
+        if (extract_circle_info(source_svg, &cx, &cy, &r) == -1) {
+            printf("Error: Could not extract circle info.\n");
+            return -1;
+        }
+
+        // Load triangle vertex coordinates from the SVG file
+        if (extract_triangle_info(target_svg, triangle_vertices) == -1) {
+            printf("Error: Could not extract triangle info.\n");
+            return -1;
+        }
+
+        // Sample the circle and pick each point's target and control point once, not per frame
+        plan = morph_plan_circle_to_triangle_in(&run_arena, cx, cy, r, triangle_vertices, num_circle_points);
+        if (plan == NULL) {
+            return -1;
+        }
+
+        // Load the paint of both shapes; a "none" side takes the other side's color so it only fades
+        float circle_paint[PAINT_NUM_CHANNELS], triangle_paint[PAINT_NUM_CHANNELS];
+        if (extract_paint_info(source_svg, "circle", circle_paint) == -1 ||
+            extract_paint_info(target_svg, "polygon", triangle_paint) == -1) {
+            printf("Error: Could not extract paint info.\n");
+            return -1;
+        }
+        if (paint_set_init(&segment_paints[0], 1) == -1 || paint_set_init(&segment_paints[1], 1) == -1) {
+            return -1;
+        }
+        paint_set_add(&segment_paints[0], circle_paint);
+        paint_set_add(&segment_paints[1], triangle_paint);
+        paint_set_pair(&segment_paints[0], &segment_paints[1]);
+    }
+    PaintSet paint_frame;
+    if (paint_set_init(&paint_frame, 1) == -1) {
+        return -1;
+    }
+
+    // Open the animation writers; they all share one framebuffer and the GIF/APNG global palette
+    Color background = { 255, 255, 255, 255 };
+
+    // The palette samples every color the fading fill and stroke produce over the background,
+    // sharing its 85 samples (3 colors each) among the segments
+    Color colors[256];
+    int num_colors = 0;
+    colors[num_colors++] = background;
+    int palette_samples = 85 / num_segments;
+    for (int s = 0; s < num_segments; s++) {
+        for (int k = 0; k < palette_samples; k++) {
+            Color fill, stroke;
+            paint_set_interpolate(&segment_paints[2 * s], &segment_paints[2 * s + 1], k / (float)(palette_samples - 1),
+                                  &paint_frame);
+            paint_set_encode(&paint_frame, &fill, &stroke);
+            Color filled = color_over(fill, background);
+            colors[num_colors++] = filled;
+            colors[num_colors++] = color_over(stroke, background);
+            colors[num_colors++] = color_over(stroke, filled);
+        }
+    }
+    AnimWriter* gif_writer = NULL;
+    AnimWriter* apng_writer = NULL;
+    StreamWriter* stream_writer = NULL;
+    Framebuffer fb = { 0 };
+    DirtyRenderer renderer = { 0 };  // Only the region around the moving shape is redrawn
+    int render_frames = (gif_file || apng_file || stream_path);
+    if (render_frames) {
+        if (framebuffer_init(&fb, 500, 500) == -1 || framebuffer_reserve(&fb, shape_points) == -1 ||
+            dirty_renderer_init(&renderer, &fb, background, 1) == -1) {
+            return -1;
+        }
+        if (gif_file && (gif_writer = anim_writer_open(gif_file, ANIM_GIF, 500, 500, colors, num_colors, delay_ms)) == NULL) {
+            return -1;
+        }
+        if (apng_file && (apng_writer = anim_writer_open(apng_file, ANIM_APNG, 500, 500, colors, num_colors, delay_ms)) == NULL) {
+            return -1;
+        }
+        // The writer thread encodes frame N while the loop computes frame N+1
+        if (stream_path && (stream_writer = stream_writer_open(stream_path, stream_format, 500, 500, fps, 8)) == NULL) {
+            return -1;
+        }
+    }
+
+    // The timing function is evaluated once per frame here, never inside the frame loop
+    float* frame_times = easing_bake(&easing, total_frames);
+    if (frame_times == NULL) {
+        return -1;
+    }
+
+    // Adaptive runs emit only the candidate frames where the shape has visibly moved
+    int num_output_frames = total_frames;
+    int* selected = NULL;
+    if (adaptive_tolerance > 0.0f) {
+        selected = (int*) malloc((size_t)total_frames * sizeof(int));
+        if (selected == NULL ||
+            (num_output_frames = timeline
+                 ? morph_timeline_select_frames(timeline, frame_times, total_frames, adaptive_tolerance, selected)
+                 : morph_plan_select_frames(plan, frame_times, total_frames, adaptive_tolerance, selected)) == -1) {
+            printf("Error: Could not select the adaptive frames\n");
+            return -1;
+        }
+        printf("Adaptive: %d of %d frames move more than %g px\n", num_output_frames, total_frames,
+               adaptive_tolerance);
+    }
+
+    // With a cache, frames are written into the entry for this exact run and copied out at the end
+    RunCache cache;
+    int use_cache = (cache_dir && write_svg_frames && frame_output != FRAME_OUTPUT_STREAM);
+    if (cache_dir && !use_cache) {
+        printf("Warning: --cache only applies to per-frame SVG/SVGZ output; ignoring it.\n");
+    }
+    if (use_cache) {
+        RunKey key;
+        if (build_run_key(&key, source_svg, target_svg, total_frames, num_circle_points, &easing, &coord_format,
+                          frame_output, level, adaptive_tolerance, delay_ms, simplify_tolerance,
+                          path_tolerance, keyframes, keyframe_times, num_keys) == -1 ||
+            run_cache_open(&cache, cache_dir, &key, cache_megabytes * 1024 * 1024) == -1) {
+            return -1;
+        }
+        if (cache.hit) {
+            printf("Cache: run %s found, skipping SVG generation\n", cache.key);
+        } else if (cache.partial) {
+            printf("Cache: resuming run %s, frames already in the cache are reused\n", cache.key);
+        }
+    }
+    const char* frame_directory = use_cache ? cache.entry : "./circle_to_triangle";
+    int generate_svg = write_svg_frames && !(use_cache && cache.hit);
+
+    // A shard computes only its own frame range; a stream shard writes its own part of the stream
+    int first_frame = 0, end_frame = num_output_frames;
+    ShardManifest shard_manifest;
+    char stream_part[1024];
+    const char* stream_file = svgz_stream;
+    if (sharded) {
+        shard_range(&shard, total_frames, &first_frame, &end_frame);
+        printf("Shard %d/%d: frames %d to %d of run %s\n", shard.index, shard.count, first_frame, end_frame - 1,
+               run_key);
+        if (frame_output == FRAME_OUTPUT_STREAM) {
+            shard_part_path(svgz_stream, &shard, stream_part, sizeof(stream_part));
+            stream_file = stream_part;
+        }
+        const char* output = (frame_output == FRAME_OUTPUT_STREAM) ? "stream" :
+                             (frame_output == FRAME_OUTPUT_SVGZ) ? "svgz" : "svg";
+        if (shard_manifest_open(&shard_manifest, frame_directory, &shard, run_key, total_frames, first_frame,
+                                end_frame, output) == -1) {
+            return -1;
+        }
+    }
+
+    // Frame files are compressed and written by worker threads, each with its own deflate stream
+    FrameWriter* frame_writer = NULL;
+    const char* extension = (frame_output == FRAME_OUTPUT_SVGZ) ? "svgz" : "svg";
+    if (generate_svg) {
+        struct stat st = {0};
+        if (frame_output != FRAME_OUTPUT_STREAM && stat(frame_directory, &st) == -1) {
+            mkdir(frame_directory, 0700);
+        }
+        frame_writer = frame_writer_open(frame_output, stream_file, level, writer_threads, 64,
+                                         frame_output != FRAME_OUTPUT_STREAM);
+        if (frame_writer == NULL) {
+            return -1;
+        }
+    }
+
+    // Interpolated vertices of the current frame
+    Polygon shape;
+    if (polygon_init(&shape, &run_arena, shape_points) == -1) {
+        return -1;
+    }
+    float* points_x = shape.x;
+    float* points_y = shape.y;
+    SimplifyScratch simplify_scratch;   // Reused by every frame of this thread
+    simplify_scratch_init(&simplify_scratch);
+
+    // This loop computes the frames; serialize threads format their text (points, or path data
+    // with room for two control points per vertex) into documents, and one I/O thread hands the
+    // documents to the frame writer in frame order
+    size_t points_text_size = (size_t)shape_points * (path_tolerance > 0.0f ? 6 : 2) * 33 + 64;
+    FrameStages stages = { frame_writer, sharded ? &shard_manifest : NULL, frame_directory, extension,
+                           &coord_format, path_tolerance, shape_points, points_text_size,
+                           points_text_size + 1024 };
+    PipelineCallbacks callbacks = { serialize_svg, write_svg, frame_serializer_create, frame_serializer_free };
+    Pipeline* pipeline = NULL;
+    if (frame_writer) {
+        if (frame_writer_reserve(frame_writer, stages.document_size) == -1) {
+            return -1;
+        }
+        pipeline = pipeline_open(&callbacks, &stages, serialize_threads,
+                                 sizeof(FrameItem) + 2 * (size_t)shape_points * sizeof(float),
+                                 sizeof(FrameDocument) + stages.document_size,
+                                 (size_t)pipeline_megabytes * 1024 * 1024);
+        if (pipeline == NULL) {
+            return -1;
+        }
+    }
+
+    // Frames are counted as they are computed and bytes as the frame writer writes them; a
+    // reporter thread logs both at a fixed interval instead of a line per frame
+    Progress* progress = progress_start("circle_to_triangle", end_frame - first_frame,
+                                        (int)(progress_seconds * 1000.0f + 0.5f));
+    if (progress == NULL) {
+        return -1;
+    }
+    if (frame_writer) {
+        frame_writer_track(frame_writer, progress);
+    }
+
+    // Buffers that grow to their working size do so on the first frame; from then on nothing in
+    // the loop may allocate (checked in builds that count allocations, see arena.h)
+    long long warm_allocations = -1;
+
+    // A cached run without animation outputs has nothing left to compute
+    if (!generate_svg && !render_frames) {
+        end_frame = first_frame;
+    }
+    for (int frame = first_frame; frame < end_frame; frame++) {
+        int candidate = selected ? selected[frame] : frame;
+        float t = frame_times[candidate];  // `t` ranges from 0 to 1 along the timing curve
 
         // Calculate each interpolated point on the circle-to-triangle morph
-        for (int i = 0; i < num_circle_points; i++) {
-            // Calculate initial point on the circle
-            float angle = (2 * M_PI / num_circle_points) * i;
-            float circle_x = cx + r * cos(angle);
-            float circle_y = cy + r * sin(angle);
+        int segment = 0;
+        float s = t;  // factor within the current pair of keyframes
+        if (timeline) {
+            morph_timeline_locate(timeline, t, &segment, &s);
+            morph_timeline_evaluate_polygon(timeline, t, &shape);
+        } else {
+            morph_plan_evaluate_polygon(plan, t, &shape);
+        }
+        int num_points = shape_points;
+        if (simplify_tolerance > 0.0f &&
+            (num_points = simplify_outline(&simplify_scratch, points_x, points_y, shape_points, 1,
+                                           simplify_tolerance)) == -1) {
+            return -1;
+        }
 
-            // Determine target vertex for this point and corresponding control point
-            float* triangle_vertex = triangle_vertices[i % 3];
-            float* control_point = control_points[i % 3];
+        // Blend the paint alongside the geometry
+        paint_set_interpolate(&segment_paints[2 * segment], &segment_paints[2 * segment + 1], s, &paint_frame);
 
-            // Interpolate position using Bézier curve
-            float interp_x = bezier_point(circle_x, control_point[0], triangle_vertex[0], t);
-            float interp_y = bezier_point(circle_y, control_point[1], triangle_vertex[1], t);
+        // Frames an interrupted run already cached are not written again
+        int reuse_frame = 0;
+        if (generate_svg && use_cache && cache.partial) {
+            char name[64];
+            snprintf(name, sizeof(name), "frame_%03d.%s", frame, extension);
+            reuse_frame = run_cache_has_frame(&cache, name);
+        }
 
-            sprintf(point, "%f,%f ", interp_x, interp_y);  // Format point as "x,y"
-            strcat(interpolated_points, point);  // Append to SVG point string
+        // Hand the current frame's interpolated points to the stages that write it as an SVG file
+        if (generate_svg && !reuse_frame) {
+            FrameItem* item = (FrameItem*) pipeline_claim(pipeline);
+            if (item == NULL) {
+                return -1;
+            }
+            item->frame = frame;
+            item->num_points = num_points;
+            for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+                item->paint[c] = paint_frame.channels[c][0];
+            }
+            memcpy(item->points, points_x, (size_t)num_points * sizeof(float));
+            memcpy(item->points + num_points, points_y, (size_t)num_points * sizeof(float));
+            pipeline_submit(pipeline);
         }
-		// Remove the trailing space from the interpolated points string
-        interpolated_points[strlen(interpolated_points) - 1] = '\0';
 
-        // Write the current frame's interpolated points to an SVG file
-        write_svg(interpolated_points, frame);
+        // Draw the same polygon for the animation outputs
+        if (render_frames) {
+            Color fill, stroke;
+            paint_set_encode(&paint_frame, &fill, &stroke);
+            float stroke_width = stroke.a ? paint_frame.channels[PAINT_STROKE_WIDTH][0] : 0.0f;
+            dirty_renderer_mark(&renderer, 0, points_x, points_y, num_points, stroke_width);
+            dirty_renderer_begin(&renderer);
+            dirty_renderer_fill(&renderer, points_x, points_y, num_points, fill);
+            if (stroke_width > 0.0f) {
+                dirty_renderer_stroke(&renderer, points_x, points_y, num_points, stroke, stroke_width);
+            }
+            dirty_renderer_end(&renderer);
+            // An adaptive frame stays on screen until the next emitted candidate is due
+            int next = (frame + 1 < num_output_frames) ? (selected ? selected[frame + 1] : frame + 1) : total_frames;
+            int frame_delay = (next - candidate) * delay_ms;
+            if (gif_writer && anim_writer_add_frame_timed(gif_writer, fb.pixels, frame_delay) == -1) {
+                return -1;
+            }
+            if (apng_writer && anim_writer_add_frame_timed(apng_writer, fb.pixels, frame_delay) == -1) {
+                return -1;
+            }
+            if (stream_writer && stream_writer_push(stream_writer, fb.pixels) == -1) {
+                return -1;
+            }
+        }
+        progress_add(progress, 1, 0);
+        if (frame == first_frame) {
+            warm_allocations = arena_heap_allocations();
+        }
+    }
+    if (pipeline && pipeline_close(pipeline) == -1) {
+        printf("Error: Could not finish serializing the frames\n");
+        return -1;
+    }
+    if (warm_allocations >= 0) {
+        long long loop_allocations = arena_heap_allocations() - warm_allocations;
+        printf("Allocations: %lld in the frame loop after the first frame\n", loop_allocations);
+        if (loop_allocations != 0) {
+            printf("Error: The frame loop allocated memory\n");
+            return -1;
+        }
     }
 
-    gettimeofday(&end, NULL);  // Record the wall-clock end time
+    // Finish the frame files and the animation files
+    if (frame_writer && frame_writer_close(frame_writer) == -1) {
+        printf("Error: Could not finish writing the frames\n");
+        return -1;
+    }
+    if (sharded && shard_manifest_close(&shard_manifest) == -1) {
+        return -1;
+    }
+    // The timeline sits next to the frames, so a cached adaptive run exports it along with them
+    if (selected && generate_svg) {
+        char timeline[1024];
+        if (frame_output == FRAME_OUTPUT_STREAM) {
+            snprintf(timeline, sizeof(timeline), "%s.timeline.txt", svgz_stream);
+        } else {
+            snprintf(timeline, sizeof(timeline), "%s/timeline.txt", frame_directory);
+        }
+        if (write_timeline(timeline, selected, num_output_frames, total_frames, frame_times, delay_ms) == -1) {
+            return -1;
+        }
+    }
+    if (use_cache) {
+        if (!cache.hit && run_cache_commit(&cache) == -1) {
+            return -1;
+        }
+        if (run_cache_export(&cache, "./circle_to_triangle") == -1) {
+            return -1;
+        }
+    }
+    if (gif_writer && anim_writer_close(gif_writer) == -1) {
+        printf("Error: Could not finish %s\n", gif_file);
+        return -1;
+    }
+    if (apng_writer && anim_writer_close(apng_writer) == -1) {
+        printf("Error: Could not finish %s\n", apng_file);
+        return -1;
+    }
+    if (stream_writer && stream_writer_close(stream_writer) == -1) {
+        printf("Error: Could not finish the video stream\n");
+        return -1;
+    }
+    dirty_renderer_free(&renderer);
+    framebuffer_free(&fb);
+    arena_free(&run_arena);  // The plan or timeline and the points
+    free(frame_times);
+    free(selected);
+    simplify_scratch_free(&simplify_scratch);
+    for (int s = 0; s < 2 * num_segments; s++) {
+        paint_set_free(&segment_paints[s]);
+    }
+    paint_set_free(&paint_frame);
+    progress_finish(progress);
+    log_flush();  // Whatever the main thread still has buffered
 
-    // Calculate the time difference in seconds with millisecond precision
-    double time_taken = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
-    printf("Execution Time: %.3f seconds\n", time_taken);
+    print_execution_time(&start);
 
     return 0;
 }
@@ -0,0 +1,452 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "curve_fit.h"
+
+#define NEWTON_ITERATIONS 4   // Reparameterization rounds before a piece is split
+#define CORNER_COSINE 0.7071f // Turns sharper than 45 degrees are kept as corners
+#define NUMBER_LENGTH 32      // Longest number format_number writes
+
+// Define a 2D vector for the fitting arithmetic
+typedef struct {
+    float x;
+    float y;
+} Vec2;
+
+// Function to prepare an empty fitter
+void curve_fitter_init(CurveFitter* fitter)
+{
+    memset(fitter, 0, sizeof(CurveFitter));
+}
+
+// Function to release the fitter
+void curve_fitter_free(CurveFitter* fitter)
+{
+    free(fitter->segments);
+    free(fitter->u);
+    free(fitter->run_x);
+    free(fitter->run_y);
+    free(fitter->hints);
+    curve_fitter_init(fitter);
+}
+
+// Function to grow the per-point buffers to num_points
+static int reserve_points(CurveFitter* fitter, int num_points)
+{
+    if (num_points <= fitter->capacity) {
+        return 0;
+    }
+    float* u = (float*) realloc(fitter->u, num_points * sizeof(float));
+    if (u) {
+        fitter->u = u;
+    }
+    float* run_x = (float*) realloc(fitter->run_x, num_points * sizeof(float));
+    if (run_x) {
+        fitter->run_x = run_x;
+    }
+    float* run_y = (float*) realloc(fitter->run_y, num_points * sizeof(float));
+    if (run_y) {
+        fitter->run_y = run_y;
+    }
+    int* hints = (int*) realloc(fitter->hints, num_points * sizeof(int));
+    if (hints) {
+        fitter->hints = hints;
+    }
+    if (!u || !run_x || !run_y || !hints) {
+        printf("Error: Could not allocate curve fitting buffers for %d points\n", num_points);
+        return -1;
+    }
+    fitter->capacity = num_points;
+    return 0;
+}
+
+// Function to presize for outlines of num_points points: a closed outline is fitted as a run of
+// num_points + 1 points, and every piece covers at least one of them
+int curve_fitter_reserve(CurveFitter* fitter, int num_points)
+{
+    if (reserve_points(fitter, num_points + 1) == -1) {
+        return -1;
+    }
+    if (fitter->segment_capacity < num_points + 1) {
+        CurveSegment* grown = (CurveSegment*) realloc(fitter->segments, (num_points + 1) * sizeof(CurveSegment));
+        if (grown == NULL) {
+            printf("Error: Could not allocate curve segments\n");
+            return -1;
+        }
+        fitter->segments = grown;
+        fitter->segment_capacity = num_points + 1;
+    }
+    return 0;
+}
+
+// Function to append a fitted piece
+static int add_segment(CurveFitter* fitter, const CurveSegment* segment)
+{
+    if (fitter->num_segments == fitter->segment_capacity) {
+        int capacity = fitter->segment_capacity ? fitter->segment_capacity * 2 : 64;
+        CurveSegment* grown = (CurveSegment*) realloc(fitter->segments, capacity * sizeof(CurveSegment));
+        if (grown == NULL) {
+            printf("Error: Could not allocate curve segments\n");
+            return -1;
+        }
+        fitter->segments = grown;
+        fitter->segment_capacity = capacity;
+    }
+    fitter->segments[fitter->num_segments++] = *segment;
+    return 0;
+}
+
+// Function to scale a vector to unit length (a zero vector stays zero)
+static Vec2 normalized(float x, float y)
+{
+    float length = hypotf(x, y);
+    Vec2 v = { 0.0f, 0.0f };
+    if (length > 0.0f) {
+        v.x = x / length;
+        v.y = y / length;
+    }
+    return v;
+}
+
+// Function to tell whether the outline turns sharply at interior point i. Turns between edges
+// shorter than the tolerance are noise the fit may smooth over, not corners
+static int is_corner(const float* xs, const float* ys, int i, float tolerance2)
+{
+    float ax = xs[i] - xs[i - 1], ay = ys[i] - ys[i - 1];
+    float bx = xs[i + 1] - xs[i], by = ys[i + 1] - ys[i];
+    if (ax * ax + ay * ay < tolerance2 || bx * bx + by * by < tolerance2) {
+        return 0;
+    }
+    Vec2 in = normalized(ax, ay);
+    Vec2 out = normalized(bx, by);
+    return in.x * out.x + in.y * out.y < CORNER_COSINE;
+}
+
+// Function to find the unit tangent at point i pointing into the piece (forward: the piece starts
+// at i). One-sided at the ends of the run and at corners; along the neighbours at other breaks,
+// so adjoining pieces join smoothly
+static Vec2 tangent_at(const float* xs, const float* ys, int num_points, int i, int forward, float tolerance2)
+{
+    if (i == 0 || (forward && i < num_points - 1 && is_corner(xs, ys, i, tolerance2))) {
+        return normalized(xs[i + 1] - xs[i], ys[i + 1] - ys[i]);
+    }
+    if (i == num_points - 1 || (!forward && is_corner(xs, ys, i, tolerance2))) {
+        return normalized(xs[i - 1] - xs[i], ys[i - 1] - ys[i]);
+    }
+    Vec2 v = normalized(xs[i + 1] - xs[i - 1], ys[i + 1] - ys[i - 1]);
+    if (!forward) {
+        v.x = -v.x;
+        v.y = -v.y;
+    }
+    return v;
+}
+
+// Function to evaluate a cubic Bézier (p0, c1, c2, p3) at u
+static Vec2 bezier_at(const float* b, float u)
+{
+    float v = 1.0f - u;
+    float w0 = v * v * v, w1 = 3.0f * v * v * u, w2 = 3.0f * v * u * u, w3 = u * u * u;
+    Vec2 p = { w0 * b[0] + w1 * b[2] + w2 * b[4] + w3 * b[6], w0 * b[1] + w1 * b[3] + w2 * b[5] + w3 * b[7] };
+    return p;
+}
+
+// Function to parameterize points first..last by their share of the chord length
+static void chord_length_parameters(float* u, const float* xs, const float* ys, int first, int last)
+{
+    u[first] = 0.0f;
+    for (int i = first + 1; i <= last; i++) {
+        u[i] = u[i - 1] + hypotf(xs[i] - xs[i - 1], ys[i] - ys[i - 1]);
+    }
+    float total = u[last];
+    for (int i = first + 1; i <= last; i++) {
+        u[i] = total > 0.0f ? u[i] / total : (float)(i - first) / (last - first);
+    }
+}
+
+// Function to solve for the control point distances along both end tangents (least squares)
+static void generate_bezier(const float* u, const float* xs, const float* ys, int first, int last, Vec2 t1,
+                            Vec2 t2, float* b)
+{
+    float p0x = xs[first], p0y = ys[first], p3x = xs[last], p3y = ys[last];
+    double c00 = 0.0, c01 = 0.0, c11 = 0.0, x0 = 0.0, x1 = 0.0;
+    for (int i = first; i <= last; i++) {
+        float s = u[i], v = 1.0f - s;
+        float w0 = v * v * v, w1 = 3.0f * v * v * s, w2 = 3.0f * v * s * s, w3 = s * s * s;
+        float a1x = t1.x * w1, a1y = t1.y * w1, a2x = t2.x * w2, a2y = t2.y * w2;
+        c00 += a1x * a1x + a1y * a1y;
+        c01 += a1x * a2x + a1y * a2y;
+        c11 += a2x * a2x + a2y * a2y;
+        float rx = xs[i] - (p0x * (w0 + w1) + p3x * (w2 + w3));
+        float ry = ys[i] - (p0y * (w0 + w1) + p3y * (w2 + w3));
+        x0 += a1x * rx + a1y * ry;
+        x1 += a2x * rx + a2y * ry;
+    }
+    double det = c00 * c11 - c01 * c01;
+    float chord = hypotf(p3x - p0x, p3y - p0y);
+    float alpha1 = 0.0f, alpha2 = 0.0f;
+    if (fabs(det) > 1e-12) {
+        alpha1 = (float)((x0 * c11 - x1 * c01) / det);
+        alpha2 = (float)((c00 * x1 - c01 * x0) / det);
+    }
+    // A degenerate or backwards solution falls back to the classic third of the chord
+    if (alpha1 < 1e-6f * chord || alpha2 < 1e-6f * chord) {
+        alpha1 = alpha2 = chord / 3.0f;
+    }
+    b[0] = p0x;
+    b[1] = p0y;
+    b[2] = p0x + t1.x * alpha1;
+    b[3] = p0y + t1.y * alpha1;
+    b[4] = p3x + t2.x * alpha2;
+    b[5] = p3y + t2.y * alpha2;
+    b[6] = p3x;
+    b[7] = p3y;
+}
+
+// Function to find the point (or edge midpoint, so the curve also follows the straight edges between
+// sparse points) furthest from its place on the curve, returns the squared distance
+static float max_error(const float* u, const float* xs, const float* ys, int first, int last, const float* b,
+                       int* split)
+{
+    float worst = 0.0f;
+    *split = (first + last) / 2;
+    for (int i = first; i < last; i++) {
+        if (i > first) {
+            Vec2 q = bezier_at(b, u[i]);
+            float d = (q.x - xs[i]) * (q.x - xs[i]) + (q.y - ys[i]) * (q.y - ys[i]);
+            if (d > worst) {
+                worst = d;
+                *split = i;
+            }
+        }
+        Vec2 q = bezier_at(b, 0.5f * (u[i] + u[i + 1]));
+        float mx = 0.5f * (xs[i] + xs[i + 1]), my = 0.5f * (ys[i] + ys[i + 1]);
+        float d = (q.x - mx) * (q.x - mx) + (q.y - my) * (q.y - my);
+        if (d > worst) {
+            worst = d;
+            *split = (i > first) ? i : i + 1;  // Split at an end of that edge, inside the piece
+        }
+    }
+    return worst;
+}
+
+// Function to improve every parameter with one Newton-Raphson step towards the closest curve point
+static void reparameterize(float* u, const float* xs, const float* ys, int first, int last, const float* b)
+{
+    for (int i = first + 1; i < last; i++) {
+        float s = u[i], v = 1.0f - s;
+        Vec2 q = bezier_at(b, s);
+        // First and second derivatives of the curve at s
+        float d1x = 3.0f * (v * v * (b[2] - b[0]) + 2.0f * v * s * (b[4] - b[2]) + s * s * (b[6] - b[4]));
+        float d1y = 3.0f * (v * v * (b[3] - b[1]) + 2.0f * v * s * (b[5] - b[3]) + s * s * (b[7] - b[5]));
+        float d2x = 6.0f * (v * (b[4] - 2.0f * b[2] + b[0]) + s * (b[6] - 2.0f * b[4] + b[2]));
+        float d2y = 6.0f * (v * (b[5] - 2.0f * b[3] + b[1]) + s * (b[7] - 2.0f * b[5] + b[3]));
+        float numerator = (q.x - xs[i]) * d1x + (q.y - ys[i]) * d1y;
+        float denominator = d1x * d1x + d1y * d1y + (q.x - xs[i]) * d2x + (q.y - ys[i]) * d2y;
+        if (denominator != 0.0f) {
+            s -= numerator / denominator;
+            u[i] = s < 0.0f ? 0.0f : s > 1.0f ? 1.0f : s;
+        }
+    }
+}
+
+// Function to try one piece over first..last without splitting. Returns 1 when it fits the
+// tolerance, otherwise 0 with the worst point in *split
+static int fit_piece(CurveFitter* fitter, const float* xs, const float* ys, int num_points, int first, int last,
+                     float tolerance2, CurveSegment* segment, int* split)
+{
+    segment->end = last;
+    segment->line = 1;
+    segment->c[4] = xs[last];
+    segment->c[5] = ys[last];
+
+    // A straight line is both the shortest output and exact for the polygon's own edges
+    float dx = xs[last] - xs[first], dy = ys[last] - ys[first];
+    float length2 = dx * dx + dy * dy, worst = 0.0f;
+    *split = (first + last) / 2;
+    for (int i = first + 1; i < last; i++) {
+        float s = length2 > 0.0f ? ((xs[i] - xs[first]) * dx + (ys[i] - ys[first]) * dy) / length2 : 0.0f;
+        s = s < 0.0f ? 0.0f : s > 1.0f ? 1.0f : s;
+        float ex = xs[i] - xs[first] - s * dx, ey = ys[i] - ys[first] - s * dy;
+        if (ex * ex + ey * ey > worst) {
+            worst = ex * ex + ey * ey;
+            *split = i;
+        }
+    }
+    if (worst <= tolerance2) {
+        return 1;
+    }
+
+    Vec2 t1 = tangent_at(xs, ys, num_points, first, 1, tolerance2);
+    Vec2 t2 = tangent_at(xs, ys, num_points, last, 0, tolerance2);
+    float b[8];
+    chord_length_parameters(fitter->u, xs, ys, first, last);
+    generate_bezier(fitter->u, xs, ys, first, last, t1, t2, b);
+    float error = max_error(fitter->u, xs, ys, first, last, b, split);
+    // Close misses are usually a matter of parameterization rather than shape
+    for (int k = 0; k < NEWTON_ITERATIONS && error > tolerance2 && error < 4.0f * tolerance2; k++) {
+        reparameterize(fitter->u, xs, ys, first, last, b);
+        generate_bezier(fitter->u, xs, ys, first, last, t1, t2, b);
+        error = max_error(fitter->u, xs, ys, first, last, b, split);
+    }
+    if (error > tolerance2) {
+        return 0;
+    }
+    segment->line = 0;
+    memcpy(segment->c, b + 2, 6 * sizeof(float));
+    return 1;
+}
+
+// Function to fit first..last, splitting at the worst point until every piece fits
+static int fit_recursive(CurveFitter* fitter, const float* xs, const float* ys, int num_points, int first,
+                         int last, float tolerance2)
+{
+    CurveSegment segment;
+    int split;
+    if (fit_piece(fitter, xs, ys, num_points, first, last, tolerance2, &segment, &split)) {
+        return add_segment(fitter, &segment);
+    }
+    if (fit_recursive(fitter, xs, ys, num_points, first, split, tolerance2) == -1) {
+        return -1;
+    }
+    return fit_recursive(fitter, xs, ys, num_points, split, last, tolerance2);
+}
+
+// Function to fit an open run, starting from the previous breaks
+int curve_fit_run(CurveFitter* fitter, const float* xs, const float* ys, int num_points, float tolerance,
+                  const int* hints, int num_hints)
+{
+    fitter->num_segments = 0;
+    if (num_points < 2) {
+        return 0;
+    }
+    if (reserve_points(fitter, num_points) == -1) {
+        return -1;
+    }
+    float tolerance2 = tolerance * tolerance;
+    int h = 0, first = 0, corner = 0;
+    while (first < num_points - 1) {
+        // Corners always end a piece; the breaks of the previous fit are only a starting point
+        if (corner <= first) {
+            corner = first + 1;
+            while (corner < num_points - 1 && !is_corner(xs, ys, corner, tolerance2)) {
+                corner++;
+            }
+        }
+        while (h < num_hints && hints[h] <= first) {
+            h++;
+        }
+        int last = (h < num_hints && hints[h] < corner) ? hints[h++] : corner;
+
+        // Drop breaks the shape no longer needs, as long as the longer piece still fits
+        CurveSegment merged = { { 0 }, 0, 0 }, trial;
+        int have_merged = 0, split;
+        while (last < corner) {
+            int next = (h < num_hints && hints[h] < corner) ? hints[h] : corner;
+            if (!fit_piece(fitter, xs, ys, num_points, first, next, tolerance2, &trial, &split)) {
+                break;
+            }
+            merged = trial;
+            have_merged = 1;
+            last = next;
+            h++;
+        }
+        if (have_merged) {
+            if (add_segment(fitter, &merged) == -1) {
+                return -1;
+            }
+        } else if (fit_recursive(fitter, xs, ys, num_points, first, last, tolerance2) == -1) {
+            return -1;
+        }
+        first = last;
+    }
+    return fitter->num_segments;
+}
+
+// Function to fit a closed outline, seeded by the previous call's breaks
+int curve_fit_outline(CurveFitter* fitter, const float* xs, const float* ys, int num_points, float tolerance)
+{
+    if (reserve_points(fitter, num_points + 1) == -1) {
+        return -1;
+    }
+    memcpy(fitter->run_x, xs, num_points * sizeof(float));
+    memcpy(fitter->run_y, ys, num_points * sizeof(float));
+    fitter->run_x[num_points] = xs[0];
+    fitter->run_y[num_points] = ys[0];
+    if (curve_fit_run(fitter, fitter->run_x, fitter->run_y, num_points + 1, tolerance, fitter->hints,
+                      fitter->num_hints) == -1) {
+        return -1;
+    }
+    // The breaks of this frame seed the next one
+    fitter->num_hints = 0;
+    for (int k = 0; k + 1 < fitter->num_segments; k++) {
+        fitter->hints[fitter->num_hints++] = fitter->segments[k].end;
+    }
+    return fitter->num_segments;
+}
+
+// Function to append a command letter when it differs from the previous one
+static int put_command(CurveFitter* fitter, char* out, size_t size, size_t* length, char command)
+{
+    if (fitter->command == command) {
+        return 0;
+    }
+    if (*length + 2 > size) {
+        return -1;
+    }
+    out[(*length)++] = command;
+    fitter->command = command;
+    return 0;
+}
+
+// Function to append coordinate pairs, separated as compactly as the format allows
+static int put_pairs(CurveFitter* fitter, char* out, size_t size, size_t* length, const float* xy, int num_pairs,
+                     const CoordFormat* format)
+{
+    char number[NUMBER_LENGTH];
+    for (int i = 0; i < 2 * num_pairs; i++) {
+        int count = format_number(number, xy[i], format);
+        // Right after a command letter, or before a minus sign, no separator is needed
+        int after_command = (i == 0 && *length > 0 && out[*length - 1] == fitter->command);
+        int separator = !after_command && (format->decimals < 0 || number[0] != '-');
+        if (*length + separator + count + 1 > size) {
+            return -1;
+        }
+        if (separator) {
+            out[(*length)++] = (i % 2 == 0) ? ' ' : ',';
+        }
+        memcpy(out + *length, number, count);
+        *length += count;
+    }
+    return 0;
+}
+
+// Function to write the fitted pieces as SVG path data
+int curve_format_path(CurveFitter* fitter, char* out, size_t size, const float* start, int close,
+                      const CoordFormat* format)
+{
+    size_t length = 0;
+    if (start) {
+        fitter->command = 0;
+        if (put_command(fitter, out, size, &length, 'M') == -1 ||
+            put_pairs(fitter, out, size, &length, start, 1, format) == -1) {
+            return -1;
+        }
+    }
+    for (int k = 0; k < fitter->num_segments; k++) {
+        const CurveSegment* segment = &fitter->segments[k];
+        int status = segment->line
+            ? (put_command(fitter, out, size, &length, 'L') == -1 ? -1 :
+               put_pairs(fitter, out, size, &length, segment->c + 4, 1, format))
+            : (put_command(fitter, out, size, &length, 'C') == -1 ? -1 :
+               put_pairs(fitter, out, size, &length, segment->c, 3, format));
+        if (status == -1) {
+            return -1;
+        }
+    }
+    if (close && put_command(fitter, out, size, &length, 'Z') == -1) {
+        return -1;
+    }
+    out[length] = '\0';
+    return (int)length;
+}
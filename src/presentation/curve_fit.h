@@ -0,0 +1,55 @@
+#ifndef CURVE_FIT_H
+#define CURVE_FIT_H
+
+#include <stddef.h>
+#include "svg_format.h"
+
+// Define one fitted piece, running from the end of the previous piece to point `end`
+typedef struct {
+    float c[6];     // first control, second control and end point (x, y); a line only uses the end
+    int line;       // 1 when every point it covers lies within tolerance of the chord
+    int end;        // index of the last point the piece covers
+} CurveSegment;
+
+// Define the fitter: the pieces of the latest fit, scratch parameters, and the breaks of the
+// previous outline, which seed the fit of the next frame. Not shared between threads
+typedef struct {
+    CurveSegment* segments;
+    int num_segments;
+    int segment_capacity;
+    float* u;               // parameter of every point inside its piece
+    float* run_x;           // closed outlines are fitted as a run that returns to its first point
+    float* run_y;
+    int capacity;
+    int* hints;             // piece ends of the previous outline
+    int num_hints;
+    char command;           // last path command written, so repeated commands can be left out
+} CurveFitter;
+
+// Prepare an empty fitter
+void curve_fitter_init(CurveFitter* fitter);
+
+// Release the fitter
+void curve_fitter_free(CurveFitter* fitter);
+
+// Size the buffers for outlines of up to num_points points, so fitting them never allocates.
+// Returns 0 on success and -1 on failure
+int curve_fitter_reserve(CurveFitter* fitter, int num_points);
+
+// Fit cubic Béziers (and straight lines) through an open run of num_points points so that every
+// point lies within tolerance of the curve. Fitting starts from the sorted interior break points
+// in hints (typically where the previous frame broke), merging neighbouring pieces the shape no
+// longer needs and splitting pieces where it now moves away. Returns the number of pieces or -1
+int curve_fit_run(CurveFitter* fitter, const float* xs, const float* ys, int num_points, float tolerance,
+                  const int* hints, int num_hints);
+
+// Fit a closed outline, seeded by the fitter's own breaks from the previous call
+int curve_fit_outline(CurveFitter* fitter, const float* xs, const float* ys, int num_points, float tolerance);
+
+// Write the fitted pieces as SVG path data. A non-NULL start begins the path with "M x,y" (otherwise
+// the data continues an earlier call); close appends "Z". Returns the length written, or -1 if the
+// buffer is too small
+int curve_format_path(CurveFitter* fitter, char* out, size_t size, const float* start, int close,
+                      const CoordFormat* format);
+
+#endif
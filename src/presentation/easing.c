@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "easing.h"
+
+// Define a timing function that is known by name
+typedef struct {
+    const char* name;
+    EaseKind kind;
+    float params[4];
+} NamedEasing;
+
+// The CSS keywords and the usual polynomial families
+static const NamedEasing named_easings[] = {
+    { "linear", EASE_LINEAR, { 0 } },
+    { "ease", EASE_CUBIC_BEZIER, { 0.25f, 0.1f, 0.25f, 1.0f } },
+    { "ease-in", EASE_CUBIC_BEZIER, { 0.42f, 0.0f, 1.0f, 1.0f } },
+    { "ease-out", EASE_CUBIC_BEZIER, { 0.0f, 0.0f, 0.58f, 1.0f } },
+    { "ease-in-out", EASE_CUBIC_BEZIER, { 0.42f, 0.0f, 0.58f, 1.0f } },
+    { "quad-in", EASE_POLY_IN, { 2 } }, { "quad-out", EASE_POLY_OUT, { 2 } }, { "quad-in-out", EASE_POLY_IN_OUT, { 2 } },
+    { "cubic-in", EASE_POLY_IN, { 3 } }, { "cubic-out", EASE_POLY_OUT, { 3 } }, { "cubic-in-out", EASE_POLY_IN_OUT, { 3 } },
+    { "quart-in", EASE_POLY_IN, { 4 } }, { "quart-out", EASE_POLY_OUT, { 4 } }, { "quart-in-out", EASE_POLY_IN_OUT, { 4 } },
+    { "quint-in", EASE_POLY_IN, { 5 } }, { "quint-out", EASE_POLY_OUT, { 5 } }, { "quint-in-out", EASE_POLY_IN_OUT, { 5 } }
+};
+
+// Function to parse a timing function name or call
+int easing_parse(const char* text, Easing* easing)
+{
+    memset(easing, 0, sizeof(Easing));
+    for (size_t i = 0; i < sizeof(named_easings) / sizeof(named_easings[0]); i++) {
+        if (strcmp(text, named_easings[i].name) == 0) {
+            easing->kind = named_easings[i].kind;
+            memcpy(easing->params, named_easings[i].params, sizeof(easing->params));
+            return 0;
+        }
+    }
+
+    // A call only counts when its closing parenthesis ends the text (end is where %n got to)
+    float a, b, c, d;
+    char position[8] = "end";
+    int end = -1;
+    if (sscanf(text, "cubic-bezier(%f ,%f ,%f ,%f )%n", &a, &b, &c, &d, &end) == 4 && end > 0 && text[end] == '\0') {
+        if (a < 0.0f || a > 1.0f || c < 0.0f || c > 1.0f) {
+            printf("Error: cubic-bezier x values must lie in [0, 1]\n");
+            return -1;
+        }
+        easing->kind = EASE_CUBIC_BEZIER;
+        easing->params[0] = a;
+        easing->params[1] = b;
+        easing->params[2] = c;
+        easing->params[3] = d;
+        return 0;
+    }
+    end = -1;
+    if (sscanf(text, "spring(%f ,%f )%n", &a, &b, &end) == 2 && end > 0 && text[end] == '\0') {
+        if (a <= 0.0f || b <= 0.0f) {
+            printf("Error: spring stiffness and damping must be positive\n");
+            return -1;
+        }
+        easing->kind = EASE_SPRING;
+        easing->params[0] = a;
+        easing->params[1] = b;
+        return 0;
+    }
+    int steps;
+    end = -1;
+    if (sscanf(text, "steps(%d )%n", &steps, &end) != 1 || end < 0) {
+        sscanf(text, "steps(%d , %7[a-z] )%n", &steps, position, &end);
+    }
+    if (end > 0 && text[end] == '\0') {
+        if (steps < 1 || (strcmp(position, "start") != 0 && strcmp(position, "end") != 0)) {
+            printf("Error: steps needs a positive count and start or end\n");
+            return -1;
+        }
+        easing->kind = EASE_STEPS;
+        easing->params[0] = (float)steps;
+        easing->jump_start = (strcmp(position, "start") == 0);
+        return 0;
+    }
+
+    printf("Error: Unknown timing function '%s'\n", text);
+    return -1;
+}
+
+// Function to evaluate one coordinate of a cubic Bézier with end points 0 and 1
+static float bezier_coordinate(float p1, float p2, float s)
+{
+    float u = 1.0f - s;
+    return 3.0f * u * u * s * p1 + 3.0f * u * s * s * p2 + s * s * s;
+}
+
+// Function to evaluate a CSS cubic-bezier: find s with x(s) = t, then return y(s)
+static float cubic_bezier(const float* p, float t)
+{
+    // Newton's method converges in a few steps for the usual curves
+    float s = t;
+    for (int i = 0; i < 8; i++) {
+        float error = bezier_coordinate(p[0], p[2], s) - t;
+        if (fabsf(error) < 1e-6f) {
+            return bezier_coordinate(p[1], p[3], s);
+        }
+        float u = 1.0f - s;
+        float slope = 3.0f * u * u * p[0] + 6.0f * u * s * (p[2] - p[0]) + 3.0f * s * s * (1.0f - p[2]);
+        if (fabsf(slope) < 1e-6f) {
+            break;
+        }
+        s -= error / slope;
+    }
+
+    // Fall back to bisection when the slope is too flat
+    float lo = 0.0f, hi = 1.0f;
+    s = t;
+    for (int i = 0; i < 32; i++) {
+        float x = bezier_coordinate(p[0], p[2], s);
+        if (fabsf(x - t) < 1e-6f) {
+            break;
+        }
+        if (x < t) {
+            lo = s;
+        } else {
+            hi = s;
+        }
+        s = 0.5f * (lo + hi);
+    }
+    return bezier_coordinate(p[1], p[3], s);
+}
+
+// Function to evaluate a unit-mass spring released from 0 toward 1; t = 1 is when it has settled
+static float spring(float stiffness, float damping, float t)
+{
+    double omega = sqrt(stiffness);
+    double zeta = damping / (2.0 * omega);
+
+    // Run the spring until its envelope is within 0.1% of the rest position
+    double duration = log(1000.0) / (zeta < 1.0 ? zeta * omega : omega * (zeta - sqrt(zeta * zeta - 1.0)));
+    double time = t * duration;
+    double value;
+    if (zeta < 1.0) {
+        double omega_d = omega * sqrt(1.0 - zeta * zeta);
+        value = 1.0 - exp(-zeta * omega * time) * (cos(omega_d * time) + zeta * omega / omega_d * sin(omega_d * time));
+    } else if (zeta == 1.0) {
+        value = 1.0 - exp(-omega * time) * (1.0 + omega * time);
+    } else {
+        double root = omega * sqrt(zeta * zeta - 1.0);
+        double r1 = -zeta * omega + root, r2 = -zeta * omega - root;
+        value = 1.0 - (r1 * exp(r2 * time) - r2 * exp(r1 * time)) / (r1 - r2);
+    }
+    return (float)value;
+}
+
+// Function to evaluate a timing function
+float easing_evaluate(const Easing* easing, float t)
+{
+    if (t <= 0.0f) {
+        return easing->kind == EASE_STEPS && easing->jump_start ? 1.0f / easing->params[0] : 0.0f;
+    }
+    if (t >= 1.0f) {
+        return 1.0f;
+    }
+    float p = easing->params[0];
+    switch (easing->kind) {
+    case EASE_POLY_IN:
+        return powf(t, p);
+    case EASE_POLY_OUT:
+        return 1.0f - powf(1.0f - t, p);
+    case EASE_POLY_IN_OUT:
+        return t < 0.5f ? 0.5f * powf(2.0f * t, p) : 1.0f - 0.5f * powf(2.0f - 2.0f * t, p);
+    case EASE_CUBIC_BEZIER:
+        return cubic_bezier(easing->params, t);
+    case EASE_SPRING:
+        return spring(easing->params[0], easing->params[1], t);
+    case EASE_STEPS:
+        return (easing->jump_start ? ceilf(t * p) : floorf(t * p)) / p;
+    case EASE_LINEAR:
+    default:
+        return t;
+    }
+}
+
+// Function to bake the remapped t of every frame into a table
+float* easing_bake(const Easing* easing, int num_frames)
+{
+    float* table = (float*) malloc((num_frames > 0 ? num_frames : 1) * sizeof(float));
+    if (table == NULL) {
+        printf("Error: Could not allocate a timing table of %d frames\n", num_frames);
+        return NULL;
+    }
+    if (num_frames == 1) {
+        table[0] = easing_evaluate(easing, 0.0f);
+        return table;
+    }
+    // Same t as the frame loops compute themselves, so linear timing is unchanged
+    for (int frame = 0; frame < num_frames; frame++) {
+        table[frame] = easing_evaluate(easing, (float)frame / (num_frames - 1));
+    }
+    return table;
+}
+
+// Function to list the timing functions easing_parse understands
+void easing_print_help(void)
+{
+    printf("  timing functions: linear, ease, ease-in, ease-out, ease-in-out,\n");
+    printf("    {quad,cubic,quart,quint}-{in,out,in-out}, cubic-bezier(x1,y1,x2,y2),\n");
+    printf("    spring(stiffness,damping), steps(n[,start|end])\n");
+}
@@ -0,0 +1,37 @@
+#ifndef EASING_H
+#define EASING_H
+
+// Kinds of timing functions an animation can use
+typedef enum {
+    EASE_LINEAR,
+    EASE_POLY_IN,         // t^p
+    EASE_POLY_OUT,        // 1 - (1 - t)^p
+    EASE_POLY_IN_OUT,     // t^p for the first half, mirrored for the second
+    EASE_CUBIC_BEZIER,    // CSS cubic-bezier(x1, y1, x2, y2)
+    EASE_SPRING,          // damped spring settling from 0 to 1
+    EASE_STEPS            // CSS steps(n, start|end)
+} EaseKind;
+
+// Define a timing function and its parameters
+typedef struct {
+    EaseKind kind;
+    float params[4];      // power; bezier x1 y1 x2 y2; spring stiffness damping; step count
+    int jump_start;       // steps(n, start) jumps at the beginning of each step
+} Easing;
+
+// Parse a timing function: linear, ease, ease-in, ease-out, ease-in-out, quad-in, cubic-out,
+// quart-in-out, quint-in, ..., cubic-bezier(x1,y1,x2,y2), spring(stiffness,damping), steps(n[,start|end]).
+// Returns 0 on success and -1 when the text is not understood
+int easing_parse(const char* text, Easing* easing);
+
+// Evaluate the timing function at t in [0, 1]
+float easing_evaluate(const Easing* easing, float t);
+
+// Bake the remapped t of every frame once per run: table[k] = ease(k / (num_frames - 1)).
+// Returns a malloc'ed table of num_frames floats, or NULL on failure
+float* easing_bake(const Easing* easing, int num_frames);
+
+// Print the accepted timing function names
+void easing_print_help(void);
+
+#endif
@@ -0,0 +1,487 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>    // unlink
+#include <pthread.h>   // Frames are compressed and written by worker threads
+#include "frame_writer.h"
+
+// Function to set up a reusable gzip deflate stream
+int gzip_context_init(GzipContext* context, int level)
+{
+    memset(context, 0, sizeof(GzipContext));
+    // 15 + 16 asks zlib for a gzip header and trailer instead of the zlib ones
+    if (deflateInit2(&context->stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        printf("Error: Could not initialize compression level %d\n", level);
+        return -1;
+    }
+    context->ready = 1;
+    return 0;
+}
+
+// Function to make room for at least `capacity` bytes of compressed output
+static int gzip_context_reserve(GzipContext* context, size_t capacity)
+{
+    if (context->capacity >= capacity) {
+        return 0;
+    }
+    unsigned char* grown = (unsigned char*) realloc(context->out, capacity);
+    if (grown == NULL) {
+        printf("Error: Could not allocate %zu bytes for compression\n", capacity);
+        return -1;
+    }
+    context->out = grown;
+    context->capacity = capacity;
+    return 0;
+}
+
+// Function to compress one document into a gzip member, reusing the stream's state
+int gzip_context_compress(GzipContext* context, const void* data, size_t length,
+                          const unsigned char** out, size_t* out_length)
+{
+    if (gzip_context_reserve(context, deflateBound(&context->stream, (uLong)length)) == -1) {
+        return -1;
+    }
+
+    deflateReset(&context->stream);  // Cheap: keeps the window and hash tables allocated
+    context->stream.next_in = (Bytef*) data;
+    context->stream.avail_in = (uInt)length;
+    context->stream.next_out = context->out;
+    context->stream.avail_out = (uInt)context->capacity;
+    for (;;) {
+        int result = deflate(&context->stream, Z_FINISH);
+        if (result == Z_STREAM_END) {
+            break;
+        }
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            printf("Error: Compression failed\n");
+            return -1;
+        }
+        // The bound can be short (stored blocks at level 0 after a reset); grow and carry on
+        size_t used = context->capacity - context->stream.avail_out;
+        if (gzip_context_reserve(context, context->capacity * 2) == -1) {
+            return -1;
+        }
+        context->stream.next_out = context->out + used;
+        context->stream.avail_out = (uInt)(context->capacity - used);
+    }
+    *out = context->out;
+    *out_length = context->capacity - context->stream.avail_out;
+    return 0;
+}
+
+// Function to release a deflate context
+void gzip_context_free(GzipContext* context)
+{
+    if (context->ready) {
+        deflateEnd(&context->stream);
+    }
+    free(context->out);
+    memset(context, 0, sizeof(GzipContext));
+}
+
+// Define one queued frame
+typedef struct {
+    char filename[FRAME_NAME_SIZE];
+    char* data;
+    size_t length;
+    size_t capacity;
+    unsigned char* packed;     // compressed copy kept until it is written in order (stream mode)
+    size_t packed_length;
+    size_t packed_capacity;
+    int done;
+} FrameSlot;
+
+struct FrameWriter {
+    FrameOutput output;
+    FILE* stream;              // the single output file of FRAME_OUTPUT_STREAM
+    int verbose;               // log every written frame at debug level
+    char* retired_names;       // verbose only: the names of one retired batch per worker, in order
+    long logged;               // frames whose lines are out; the next batch's turn to log
+    pthread_mutex_t log_lock;
+    pthread_cond_t log_turn;
+    Progress* progress;        // counts the bytes written, may be NULL
+
+    FrameSlot* slots;          // queue_frames slots, indexed by frame sequence % queue_frames
+    int queue_frames;
+    long submitted;            // frames handed in by the caller
+    long claimed;              // frames taken by a worker
+    long retired;              // frames written out in order; their slots can be reused
+    int closing;
+    int failed;
+
+    GzipContext* contexts;     // one per worker, created once
+    int num_contexts;
+    pthread_t* threads;
+    int num_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t space;
+};
+
+// Define what a worker thread needs to know about itself
+typedef struct {
+    FrameWriter* writer;
+    int index;
+} WorkerArgs;
+
+// Function to build the hidden temporary name a frame is written under: ".name.tmp" next to it
+int frame_temporary_path(const char* filename, char* temporary, size_t size)
+{
+    const char* slash = strrchr(filename, '/');
+    int directory_length = slash ? (int)(slash - filename) + 1 : 0;
+    int length = snprintf(temporary, size, "%.*s.%s.tmp", directory_length, filename, filename + directory_length);
+    if (length < 0 || (size_t)length >= size) {
+        printf("Error: File name %s is too long\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to write one buffer to a new file. The bytes go to a hidden temporary file that is
+// renamed over filename once complete, so an interrupted run never leaves a partial frame under
+// the real name, and a file that was linked elsewhere (a cache entry) is replaced, not truncated
+static int write_file(const char* filename, const void* data, size_t length)
+{
+    char temporary[FRAME_NAME_SIZE + 8];
+    if (frame_temporary_path(filename, temporary, sizeof(temporary)) == -1) {
+        return -1;
+    }
+    FILE* file = fopen(temporary, "wb");
+    if (file == NULL) {
+        printf("Error: Could not open file %s for writing\n", temporary);
+        return -1;
+    }
+    size_t written = fwrite(data, 1, length, file);
+    if (fclose(file) != 0 || written != length) {
+        printf("Error: Could not write file %s\n", filename);
+        unlink(temporary);
+        return -1;
+    }
+    if (rename(temporary, filename) == -1) {
+        printf("Error: Could not move %s into place\n", filename);
+        unlink(temporary);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to retire finished frames in sequence order; called with the lock held
+static int retire_frames(FrameWriter* writer, char* names)
+{
+    int count = 0;
+    while (writer->retired < writer->claimed) {
+        FrameSlot* slot = &writer->slots[writer->retired % writer->queue_frames];
+        if (!slot->done) {
+            break;  // An earlier frame is still being compressed
+        }
+        if (writer->output == FRAME_OUTPUT_STREAM && !writer->failed) {
+            if (fwrite(slot->packed, 1, slot->packed_length, writer->stream) != slot->packed_length) {
+                printf("Error: Could not write the compressed frame stream\n");
+                writer->failed = 1;
+            } else {
+                progress_add(writer->progress, 0, slot->packed_length);
+            }
+        }
+        if (writer->verbose) {
+            // Logged once the lock is released; the slot may be refilled by then
+            char* name = names + (size_t)count * FRAME_NAME_SIZE;
+            snprintf(name, FRAME_NAME_SIZE, "%s", writer->failed ? "" : slot->filename);
+        }
+        count++;
+        slot->done = 0;
+        writer->retired++;
+        pthread_cond_broadcast(&writer->space);
+    }
+    return count;
+}
+
+// Function to log a batch of retired frames outside the writer lock. Batches take turns by their
+// first frame, so the lines of all workers come out in frame order
+static void log_retired(FrameWriter* writer, long first, const char* names, int count)
+{
+    pthread_mutex_lock(&writer->log_lock);
+    while (writer->logged != first) {
+        pthread_cond_wait(&writer->log_turn, &writer->log_lock);
+    }
+    pthread_mutex_unlock(&writer->log_lock);
+    for (int i = 0; i < count; i++) {
+        const char* name = names + (size_t)i * FRAME_NAME_SIZE;
+        if (name[0] != '\0') {
+            log_message(LOG_DEBUG, "File %s created successfully.\n", name);
+        }
+    }
+    log_flush();
+    pthread_mutex_lock(&writer->log_lock);
+    writer->logged = first + count;
+    pthread_cond_broadcast(&writer->log_turn);
+    pthread_mutex_unlock(&writer->log_lock);
+}
+
+// Worker thread: compresses (and for per-frame files writes) frames outside the lock
+static void* frame_worker(void* arg)
+{
+    WorkerArgs* args = (WorkerArgs*) arg;
+    FrameWriter* writer = args->writer;
+    GzipContext* context = writer->output == FRAME_OUTPUT_SVG ? NULL : &writer->contexts[args->index];
+    char* names = NULL;
+    if (writer->verbose) {
+        names = writer->retired_names + (size_t)args->index * writer->queue_frames * FRAME_NAME_SIZE;
+    }
+    free(args);
+
+    for (;;) {
+        pthread_mutex_lock(&writer->lock);
+        while (writer->claimed == writer->submitted && !writer->closing) {
+            pthread_cond_wait(&writer->work, &writer->lock);
+        }
+        if (writer->claimed == writer->submitted) {
+            pthread_mutex_unlock(&writer->lock);
+            break;  // Closing and fully drained
+        }
+        FrameSlot* slot = &writer->slots[writer->claimed % writer->queue_frames];
+        writer->claimed++;
+        pthread_mutex_unlock(&writer->lock);
+
+        int status = 0;
+        const unsigned char* packed = (const unsigned char*) slot->data;
+        size_t packed_length = slot->length;
+        if (context) {
+            status = gzip_context_compress(context, slot->data, slot->length, &packed, &packed_length);
+        }
+        if (status == 0 && writer->output == FRAME_OUTPUT_STREAM) {
+            // The stream is appended in frame order once earlier frames are done, so the slot
+            // keeps the compressed bytes and the context takes the slot's old buffer instead
+            unsigned char* spare = slot->packed;
+            size_t spare_capacity = slot->packed_capacity;
+            slot->packed = context->out;
+            slot->packed_capacity = context->capacity;
+            slot->packed_length = packed_length;
+            context->out = spare;
+            context->capacity = spare_capacity;
+        } else if (status == 0) {
+            status = write_file(slot->filename, packed, packed_length);
+        }
+        if (status == 0 && writer->output != FRAME_OUTPUT_STREAM) {
+            progress_add(writer->progress, 0, packed_length);
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        if (status == -1) {
+            writer->failed = 1;
+        }
+        slot->done = 1;
+        long first = writer->retired;
+        int count = retire_frames(writer, names);
+        pthread_mutex_unlock(&writer->lock);
+        if (writer->verbose && count > 0) {
+            log_retired(writer, first, names, count);
+        }
+    }
+    log_flush();
+    return NULL;
+}
+
+// Function to start the frame writer and its workers
+FrameWriter* frame_writer_open(FrameOutput output, const char* stream_path, int level, int num_threads,
+                               int queue_frames, int verbose)
+{
+    if (level < 0 || level > 9) {
+        printf("Error: Compression level must be between 0 and 9\n");
+        return NULL;
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (queue_frames < num_threads * 2) {
+        queue_frames = num_threads * 2;  // Enough for every worker plus the one being filled
+    }
+    FrameWriter* writer = (FrameWriter*) calloc(1, sizeof(FrameWriter));
+    if (writer == NULL) {
+        printf("Error: Could not allocate the frame writer\n");
+        return NULL;
+    }
+    writer->output = output;
+    writer->verbose = verbose && log_enabled(LOG_DEBUG);
+    writer->queue_frames = queue_frames;
+    writer->slots = (FrameSlot*) calloc(queue_frames, sizeof(FrameSlot));
+    writer->contexts = (GzipContext*) calloc(num_threads, sizeof(GzipContext));
+    writer->threads = (pthread_t*) calloc(num_threads, sizeof(pthread_t));
+    if (writer->verbose) {
+        // A worker retires at most the whole queue at once
+        writer->retired_names = (char*) malloc((size_t)num_threads * queue_frames * FRAME_NAME_SIZE);
+    }
+    if (writer->slots == NULL || writer->contexts == NULL || writer->threads == NULL ||
+        (writer->verbose && writer->retired_names == NULL)) {
+        printf("Error: Could not allocate the frame queue\n");
+        free(writer->slots);
+        free(writer->contexts);
+        free(writer->threads);
+        free(writer->retired_names);
+        free(writer);
+        return NULL;
+    }
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->work, NULL);
+    pthread_cond_init(&writer->space, NULL);
+    pthread_mutex_init(&writer->log_lock, NULL);
+    pthread_cond_init(&writer->log_turn, NULL);
+
+    if (output == FRAME_OUTPUT_STREAM) {
+        writer->stream = fopen(stream_path, "wb");
+        if (writer->stream == NULL) {
+            printf("Error: Could not open file %s for writing\n", stream_path);
+            frame_writer_close(writer);
+            return NULL;
+        }
+    }
+
+    // Every worker gets its own deflate context up front; frames only reset it
+    for (int i = 0; i < num_threads && output != FRAME_OUTPUT_SVG; i++) {
+        if (gzip_context_init(&writer->contexts[i], level) == -1) {
+            frame_writer_close(writer);
+            return NULL;
+        }
+        writer->num_contexts++;
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        WorkerArgs* args = (WorkerArgs*) malloc(sizeof(WorkerArgs));
+        if (args == NULL) {
+            printf("Error: Could not start frame writer thread %d\n", i);
+            frame_writer_close(writer);
+            return NULL;
+        }
+        args->writer = writer;
+        args->index = i;
+        if (pthread_create(&writer->threads[i], NULL, frame_worker, args) != 0) {
+            printf("Error: Could not start frame writer thread %d\n", i);
+            free(args);
+            frame_writer_close(writer);
+            return NULL;
+        }
+        writer->num_threads++;
+    }
+    return writer;
+}
+
+// Function to count the bytes written by the workers in a progress report
+void frame_writer_track(FrameWriter* writer, Progress* progress)
+{
+    writer->progress = progress;
+}
+
+// Function to presize the slot buffers and deflate outputs; the workers are idle until the first submit
+int frame_writer_reserve(FrameWriter* writer, size_t bytes)
+{
+    size_t bound = bytes;
+    for (int i = 0; i < writer->num_contexts; i++) {
+        uLong context_bound = deflateBound(&writer->contexts[i].stream, (uLong)bytes);
+        if (context_bound > bound) {
+            bound = context_bound;
+        }
+        if (gzip_context_reserve(&writer->contexts[i], context_bound) == -1) {
+            return -1;
+        }
+    }
+    for (int i = 0; i < writer->queue_frames; i++) {
+        FrameSlot* slot = &writer->slots[i];
+        if (slot->capacity < bytes) {
+            char* grown = (char*) realloc(slot->data, bytes);
+            if (grown == NULL) {
+                printf("Error: Could not reserve a frame slot of %zu bytes\n", bytes);
+                return -1;
+            }
+            slot->data = grown;
+            slot->capacity = bytes;
+        }
+        // Stream mode swaps compressed buffers between slots and contexts, so both get the bound
+        if (writer->output == FRAME_OUTPUT_STREAM && slot->packed_capacity < bound) {
+            unsigned char* grown = (unsigned char*) realloc(slot->packed, bound);
+            if (grown == NULL) {
+                printf("Error: Could not reserve a frame slot of %zu bytes\n", bound);
+                return -1;
+            }
+            slot->packed = grown;
+            slot->packed_capacity = bound;
+        }
+    }
+    return 0;
+}
+
+// Function to hand one frame document to the workers
+int frame_writer_submit(FrameWriter* writer, const char* filename, const char* data, size_t length)
+{
+    pthread_mutex_lock(&writer->lock);
+    while (writer->submitted - writer->retired == writer->queue_frames && !writer->failed) {
+        pthread_cond_wait(&writer->space, &writer->lock);
+    }
+    int failed = writer->failed;
+    pthread_mutex_unlock(&writer->lock);
+    if (failed) {
+        return -1;
+    }
+
+    // A cut-off name could land on another frame's file, so it is refused instead
+    if (strlen(filename) >= FRAME_NAME_SIZE) {
+        printf("Error: File name %s is too long\n", filename);
+        return -1;
+    }
+
+    // The slot belongs to the caller until it is published below
+    FrameSlot* slot = &writer->slots[writer->submitted % writer->queue_frames];
+    if (slot->capacity < length) {
+        char* grown = (char*) realloc(slot->data, length);
+        if (grown == NULL) {
+            printf("Error: Could not queue a frame of %zu bytes\n", length);
+            return -1;
+        }
+        slot->data = grown;
+        slot->capacity = length;
+    }
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    snprintf(slot->filename, sizeof(slot->filename), "%s", filename);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->submitted++;
+    pthread_cond_signal(&writer->work);
+    pthread_mutex_unlock(&writer->lock);
+    return 0;
+}
+
+// Function to drain the queue, stop the workers and release everything
+int frame_writer_close(FrameWriter* writer)
+{
+    if (writer->num_threads > 0) {
+        pthread_mutex_lock(&writer->lock);
+        writer->closing = 1;
+        pthread_cond_broadcast(&writer->work);
+        pthread_mutex_unlock(&writer->lock);
+        for (int i = 0; i < writer->num_threads; i++) {
+            pthread_join(writer->threads[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->work);
+    pthread_cond_destroy(&writer->space);
+    pthread_mutex_destroy(&writer->log_lock);
+    pthread_cond_destroy(&writer->log_turn);
+    int status = writer->failed ? -1 : 0;
+    if (writer->stream && fclose(writer->stream) != 0) {
+        printf("Error: Could not finish the compressed frame stream\n");
+        status = -1;
+    }
+    for (int i = 0; i < writer->queue_frames; i++) {
+        free(writer->slots[i].data);
+        free(writer->slots[i].packed);
+    }
+    for (int i = 0; i < writer->num_contexts; i++) {
+        gzip_context_free(&writer->contexts[i]);
+    }
+    free(writer->slots);
+    free(writer->contexts);
+    free(writer->threads);
+    free(writer->retired_names);
+    free(writer);
+    return status;
+}
@@ -0,0 +1,63 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <stddef.h>
+#include <zlib.h>
+#include "logger.h"     // per-frame debug lines and progress counters
+
+#define FRAME_NAME_SIZE 1024   // Longest frame file name the writer takes, terminator included
+
+// How the frame documents end up on disk
+typedef enum {
+    FRAME_OUTPUT_SVG,       // one plain .svg file per frame
+    FRAME_OUTPUT_SVGZ,      // one gzip-compressed .svgz file per frame
+    FRAME_OUTPUT_STREAM     // all frames in order in one gzip file (one gzip member per frame)
+} FrameOutput;
+
+// Define a deflate context that is reset, never re-initialized, between documents
+typedef struct {
+    z_stream stream;
+    unsigned char* out;     // compressed output, grown when needed
+    size_t capacity;
+    int ready;
+} GzipContext;
+
+// Set up a gzip deflate stream at the given level (0-9), returns 0 on success and -1 on failure
+int gzip_context_init(GzipContext* context, int level);
+
+// Compress one document into a complete gzip member; *out stays valid until the next call
+int gzip_context_compress(GzipContext* context, const void* data, size_t length,
+                          const unsigned char** out, size_t* out_length);
+
+// Release the deflate state and the output buffer
+void gzip_context_free(GzipContext* context);
+
+// Opaque writer state (frame queue, worker threads and their deflate contexts)
+typedef struct FrameWriter FrameWriter;
+
+// Start num_threads workers that compress and write frames while the caller computes the next
+// ones. stream_path is the output file for FRAME_OUTPUT_STREAM and ignored otherwise.
+// queue_frames bounds how many frames may wait; verbose logs one debug line per written frame.
+FrameWriter* frame_writer_open(FrameOutput output, const char* stream_path, int level, int num_threads,
+                               int queue_frames, int verbose);
+
+// Size every queue slot and deflate buffer for documents of up to `bytes` bytes, so the frames
+// that follow are queued and compressed without allocating. Call before the first submit
+int frame_writer_reserve(FrameWriter* writer, size_t bytes);
+
+// Count every byte the workers write in progress; call before the first submit
+void frame_writer_track(FrameWriter* writer, Progress* progress);
+
+// Build the hidden temporary name (".name.tmp" in the same directory) a frame is written under
+// before it is renamed to filename. Returns 0 on success and -1 when it does not fit in size bytes
+int frame_temporary_path(const char* filename, char* temporary, size_t size);
+
+// Queue one frame document (the data is copied). filename is where FRAME_OUTPUT_SVG/SVGZ write it.
+// Blocks while the queue is full; returns -1 once any write has failed or when filename does not
+// fit in FRAME_NAME_SIZE
+int frame_writer_submit(FrameWriter* writer, const char* filename, const char* data, size_t length);
+
+// Write the remaining frames, stop the workers and close the stream
+int frame_writer_close(FrameWriter* writer);
+
+#endif
@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <sys/time.h>  //time execution
+#include <unistd.h>    // sysconf for the default thread count
+#include "line_set.h"  // <line> loading, equalizing and interpolation
+#include "paint.h"     // linear light -> sRGB table
+#include "easing.h"    // timing functions baked into a per-frame t table
+#include "svg_format.h" // quantized coordinate output
+#include "frame_writer.h" // reusable gzip contexts for .svgz frames
+#include "batch_pool.h"   // one thread pool shared by every job of a batch
+
+// Morphs the <line> sets of the tc_* test cases (the C version of src/python/morphtc1.py)
+
+// Define a growable text buffer that one frame's SVG is formatted into
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+// Function to make sure a buffer has room for `extra` more characters and a terminator
+int text_reserve(TextBuffer* buffer, size_t extra)
+{
+    if (buffer->capacity - buffer->length > extra) {
+        return 0;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+    while (capacity - buffer->length <= extra) {
+        capacity *= 2;
+    }
+    char* grown = (char*) realloc(buffer->data, capacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+// Function to append formatted text to a buffer, growing it when needed
+int text_append(TextBuffer* buffer, const char* format, ...)
+{
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        size_t room = buffer->capacity - buffer->length;
+        int written = vsnprintf(buffer->data + buffer->length, room, format, args);
+        va_end(args);
+        if (written < 0) {
+            return -1;
+        }
+        if ((size_t)written < room) {
+            buffer->length += written;
+            return 0;
+        }
+        if (text_reserve(buffer, written) == -1) {
+            return -1;
+        }
+    }
+}
+
+// Function to append a literal string to a buffer that already has room for it
+static void text_put(TextBuffer* buffer, const char* text)
+{
+    size_t length = strlen(text);
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+}
+
+// Function to append one quantized attribute value to a buffer that already has room for it
+static void text_put_number(TextBuffer* buffer, const char* attribute, float value, const CoordFormat* format)
+{
+    text_put(buffer, attribute);
+    buffer->length += format_number(buffer->data + buffer->length, value, format);
+    buffer->data[buffer->length++] = '"';
+}
+
+// Function to write the interpolated lines of one frame to an SVG file
+int write_svg_lines(const LineSet* lines, int width, int height, const char* directory,
+                    const char* name, int frame_number, const CoordFormat* format, TextBuffer* buffer,
+                    GzipContext* gzip)
+{
+    static const char hex[] = "0123456789abcdef";
+    buffer->length = 0;
+    int status = text_append(buffer, "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"%d\" height=\"%d\">",
+                             width, height);
+    for (int i = 0; i < lines->count && status == 0; i++) {
+        // One line is at most ~250 characters; reserve it so the numbers can be written in place
+        if ((status = text_reserve(buffer, 256)) == -1) {
+            break;
+        }
+
+        // Coordinates and widths are rounded like the Python version by default; colors were blended in linear light
+        text_put_number(buffer, "<line x1=\"", lines->x1[i], format);
+        text_put_number(buffer, " y1=\"", lines->y1[i], format);
+        text_put_number(buffer, " x2=\"", lines->x2[i], format);
+        text_put_number(buffer, " y2=\"", lines->y2[i], format);
+        unsigned char rgb[3] = { linear_to_srgb(lines->stroke_r[i]), linear_to_srgb(lines->stroke_g[i]),
+                                 linear_to_srgb(lines->stroke_b[i]) };
+        text_put(buffer, " stroke=\"#");
+        for (int c = 0; c < 3; c++) {
+            buffer->data[buffer->length++] = hex[rgb[c] >> 4];
+            buffer->data[buffer->length++] = hex[rgb[c] & 15];
+        }
+        buffer->data[buffer->length++] = '"';
+        text_put_number(buffer, " stroke-width=\"", lines->width[i], format);
+        text_put(buffer, " />");
+    }
+    if (status == 0) {
+        status = text_append(buffer, "</svg>");
+    }
+    if (status == -1) {
+        printf("Error: Could not format frame %d\n", frame_number);
+        return -1;
+    }
+
+    // With a gzip context the frame is compressed by the thread that formatted it
+    const void* data = buffer->data;
+    size_t length = buffer->length;
+    if (gzip && gzip_context_compress(gzip, buffer->data, buffer->length, (const unsigned char**)&data, &length) == -1) {
+        return -1;
+    }
+
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/%s_%03d.%s", directory, name, frame_number, gzip ? "svgz" : "svg");
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        printf("Error: Could not open file %s for writing\n", filename);
+        return -1;
+    }
+    size_t written = fwrite(data, 1, length, file);
+    if (fclose(file) != 0 || written != length) {
+        printf("Error: Could not write file %s\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+// Define one morph job: its options, then (while it is loaded) its line sets and timing table
+typedef struct {
+    char start_file[512];
+    char final_file[512];
+    char directory[512];
+    char name[128];
+    int steps;
+    Easing easing;
+    int decimals;
+    float grid;
+    int compress;
+    int level;
+
+    LineSet start, final;
+    int width, height;
+    float* frame_times;
+    CoordFormat coord_format;
+    struct timeval load_time;
+} LineJob;
+
+// Define the scratch state of one pool thread, reused for every frame of every job
+typedef struct {
+    LineSet frame_lines;
+    TextBuffer buffer;
+    GzipContext gzip;
+    int gzip_level;       // level the context was set up with, -1 before the first .svgz frame
+} LineWorker;
+
+// Function to print the command line options
+void print_usage(const char* program)
+{
+    printf("Usage: %s [--start FILE] [--final FILE] [--steps N] [--out DIR] [--name BASE] [--ease F]\n", program);
+    printf("       [--precision N] [--grid STEP] [--svgz] [--level N] [--batch FILE] [--threads N] [--window N]\n");
+    printf("  --start FILE  SVG with the starting lines (default ../../svg/tc_2_start.svg)\n");
+    printf("  --final FILE  SVG with the final lines (default ../../svg/tc_2_final.svg)\n");
+    printf("  --steps N     interpolation steps, N + 1 frames are written (default 100)\n");
+    printf("  --out DIR     output directory (default line_morph)\n");
+    printf("  --name BASE   frame file prefix (default tc2)\n");
+    printf("  --ease F      timing function applied to t (default linear)\n");
+    easing_print_help();
+    printf("  --precision N decimals kept for coordinates and widths (default 0)\n");
+    printf("  --grid STEP   snap coordinates and widths to multiples of STEP\n");
+    printf("  --svgz        write gzip-compressed .svgz frames\n");
+    printf("  --level N     compression level 0-9 (default 6)\n");
+    printf("  --batch FILE  run every job of a manifest: one job per line, written with the options above;\n");
+    printf("                options on the command line are the defaults of every job, '#' starts a comment\n");
+    printf("  --threads N   threads shared by all jobs (default: one per core)\n");
+    printf("  --window N    jobs whose inputs may be loaded at once (default: threads + 1)\n");
+}
+
+// Function to apply one job option at argv[*i], returns 1 when it was one, 0 when not and -1 on a bad value
+int parse_job_option(LineJob* job, int argc, char** argv, int* i)
+{
+    const char* option = argv[*i];
+    int has_value = (*i + 1 < argc);
+    if (strcmp(option, "--svgz") == 0) {
+        job->compress = 1;
+        return 1;
+    }
+    if (!has_value) {
+        return 0;
+    }
+    const char* value = argv[*i + 1];
+    if (strcmp(option, "--start") == 0) {
+        snprintf(job->start_file, sizeof(job->start_file), "%s", value);
+    } else if (strcmp(option, "--final") == 0) {
+        snprintf(job->final_file, sizeof(job->final_file), "%s", value);
+    } else if (strcmp(option, "--steps") == 0) {
+        job->steps = atoi(value);
+    } else if (strcmp(option, "--out") == 0) {
+        snprintf(job->directory, sizeof(job->directory), "%s", value);
+    } else if (strcmp(option, "--name") == 0) {
+        snprintf(job->name, sizeof(job->name), "%s", value);
+    } else if (strcmp(option, "--level") == 0) {
+        job->level = atoi(value);
+    } else if (strcmp(option, "--precision") == 0) {
+        job->decimals = atoi(value);
+    } else if (strcmp(option, "--grid") == 0) {
+        job->grid = atof(value);
+    } else if (strcmp(option, "--ease") == 0) {
+        if (easing_parse(value, &job->easing) == -1) {
+            return -1;
+        }
+    } else {
+        return 0;
+    }
+    (*i)++;
+    return 1;
+}
+
+// Function to split a manifest line into arguments; double quotes keep spaces in paths
+int split_arguments(char* line, char** args, int max_args)
+{
+    int count = 0;
+    char* p = line;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            return count;
+        }
+        if (count == max_args) {
+            return -1;
+        }
+        char quote = (*p == '"') ? *p++ : 0;
+        args[count++] = p;
+        while (*p && (quote ? *p != quote : (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'))) {
+            p++;
+        }
+        if (*p == '\0') {
+            return count;
+        }
+        *p++ = '\0';
+    }
+}
+
+// Function to read a job manifest; every job starts from the command line's options
+LineJob* read_manifest(const char* filename, const LineJob* defaults, int* num_jobs)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        printf("Error: Could not open manifest %s\n", filename);
+        return NULL;
+    }
+    int capacity = 16;
+    LineJob* jobs = (LineJob*) malloc(capacity * sizeof(LineJob));
+    if (jobs == NULL) {
+        printf("Error: Could not allocate the job list\n");
+        fclose(file);
+        return NULL;
+    }
+    *num_jobs = 0;
+    char line[4096];
+    int line_number = 0, status = 0;
+    while (status == 0 && fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* args[64];
+        int count = split_arguments(line, args, 64);
+        if (count == -1) {
+            printf("Error: %s line %d has too many arguments\n", filename, line_number);
+            status = -1;
+            break;
+        }
+        if (count == 0) {
+            continue;
+        }
+        if (*num_jobs == capacity) {
+            LineJob* grown = (LineJob*) realloc(jobs, capacity * 2 * sizeof(LineJob));
+            if (grown == NULL) {
+                printf("Error: Could not allocate the job list\n");
+                status = -1;
+                break;
+            }
+            jobs = grown;
+            capacity *= 2;
+        }
+        LineJob* job = &jobs[(*num_jobs)++];
+        *job = *defaults;
+        for (int i = 0; i < count && status == 0; i++) {
+            int parsed = parse_job_option(job, count, args, &i);
+            if (parsed == 0) {
+                printf("Error: %s line %d: unknown or incomplete option '%s'\n", filename, line_number, args[i]);
+            }
+            status = (parsed == 1) ? 0 : -1;
+        }
+    }
+    fclose(file);
+    if (status == -1) {
+        free(jobs);
+        return NULL;
+    }
+    return jobs;
+}
+
+// Function to read a job's inputs (pool callback), returns the number of frames or -1
+int load_line_job(void* arg)
+{
+    LineJob* job = (LineJob*) arg;
+    gettimeofday(&job->load_time, NULL);
+    if (job->steps < 1) {
+        printf("Error: At least 1 step is needed.\n");
+        return -1;
+    }
+    // Whole numbers like the Python version unless a precision or grid is asked for
+    if (coord_format_init(&job->coord_format, job->decimals, job->grid) == -1) {
+        return -1;
+    }
+    if (job->coord_format.decimals < 0) {
+        job->coord_format.decimals = 0;
+    }
+
+    // Load both line sets
+    if (line_set_init(&job->start, 64) == -1 || line_set_init(&job->final, 64) == -1) {
+        return -1;
+    }
+    if (load_svg_lines(job->start_file, &job->start, &job->width, &job->height) == -1 ||
+        load_svg_lines(job->final_file, &job->final, NULL, NULL) == -1) {
+        return -1;
+    }
+    printf("Number of lines in start SVG: %d\n", job->start.count);
+    printf("Number of lines in final SVG: %d\n", job->final.count);
+
+    // Both sets need one line per line before they can be interpolated
+    if (equalize_line_counts(&job->start, &job->final) == -1) {
+        return -1;
+    }
+    printf("After equalization: %d lines\n", job->start.count);
+
+    // Create the output folder if it does not exist
+    struct stat st = {0};
+    if (stat(job->directory, &st) == -1) {
+        mkdir(job->directory, 0700);
+    }
+
+    // Bake the timing function once; the frame loop only looks t up
+    job->frame_times = easing_bake(&job->easing, job->steps + 1);
+    return job->frame_times ? job->steps + 1 : -1;
+}
+
+// Function to set up the scratch state of a pool thread (pool callback)
+void* line_worker_init(void)
+{
+    LineWorker* worker = (LineWorker*) calloc(1, sizeof(LineWorker));
+    if (worker) {
+        worker->gzip_level = -1;
+    }
+    return worker;
+}
+
+// Function to release a pool thread's scratch state (pool callback)
+void line_worker_free(void* arg)
+{
+    LineWorker* worker = (LineWorker*) arg;
+    if (worker == NULL) {
+        return;
+    }
+    free(worker->buffer.data);
+    line_set_free(&worker->frame_lines);
+    if (worker->gzip_level >= 0) {
+        gzip_context_free(&worker->gzip);
+    }
+    free(worker);
+}
+
+// Function to interpolate and write one frame of a job (pool callback)
+int render_line_frame(void* arg, int step, void* worker_arg)
+{
+    LineJob* job = (LineJob*) arg;
+    LineWorker* worker = (LineWorker*) worker_arg;
+    if (worker == NULL) {
+        return -1;
+    }
+    // The per-thread arrays and deflate stream are only rebuilt when a job needs more or different ones
+    if (worker->frame_lines.capacity < job->start.count) {
+        line_set_free(&worker->frame_lines);
+        if (line_set_init(&worker->frame_lines, job->start.count) == -1) {
+            return -1;
+        }
+    }
+    if (job->compress && worker->gzip_level != job->level) {
+        if (worker->gzip_level >= 0) {
+            gzip_context_free(&worker->gzip);
+            worker->gzip_level = -1;
+        }
+        if (gzip_context_init(&worker->gzip, job->level) == -1) {
+            return -1;
+        }
+        worker->gzip_level = job->level;
+    }
+
+    float t = job->frame_times[step];  // Interpolation factor (0.0 to 1.0)
+    line_set_interpolate(&job->start, &job->final, t, &worker->frame_lines);
+    return write_svg_lines(&worker->frame_lines, job->width, job->height, job->directory, job->name, step,
+                           &job->coord_format, &worker->buffer, job->compress ? &worker->gzip : NULL);
+}
+
+// Function to release a job's inputs once its last frame is written (pool callback)
+void finish_line_job(void* arg, int failed)
+{
+    LineJob* job = (LineJob*) arg;
+    struct timeval end_time;
+    gettimeofday(&end_time, NULL);  // Record the wall-clock end time
+    double time_taken = (end_time.tv_sec - job->load_time.tv_sec) + (end_time.tv_usec - job->load_time.tv_usec) / 1e6;
+    if (failed) {
+        printf("Error: Job %s (%s -> %s) failed\n", job->name, job->start_file, job->final_file);
+    } else {
+        printf("Wrote %d frames to %s in %.3f seconds\n", job->steps + 1, job->directory, time_taken);
+    }
+    line_set_free(&job->start);
+    line_set_free(&job->final);
+    free(job->frame_times);
+    job->frame_times = NULL;
+}
+
+int main(int argc, char** argv)
+{
+    struct timeval start_time, end_time;
+    gettimeofday(&start_time, NULL);  // record the wall-clock start time
+
+    // The command line describes the single job, or the defaults of every job in a manifest
+    LineJob defaults;
+    memset(&defaults, 0, sizeof(LineJob));
+    snprintf(defaults.start_file, sizeof(defaults.start_file), "../../svg/tc_2_start.svg");
+    snprintf(defaults.final_file, sizeof(defaults.final_file), "../../svg/tc_2_final.svg");
+    snprintf(defaults.directory, sizeof(defaults.directory), "line_morph");
+    snprintf(defaults.name, sizeof(defaults.name), "tc2");
+    defaults.steps = 100;
+    defaults.easing.kind = EASE_LINEAR;
+    defaults.decimals = -1;
+    defaults.level = 6;
+    const char* manifest = NULL;
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int window = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            manifest = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            window = atoi(argv[++i]);
+        } else {
+            int parsed = parse_job_option(&defaults, argc, argv, &i);
+            if (parsed == -1) {
+                return -1;
+            }
+            if (parsed == 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+        }
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (window < 1) {
+        window = num_threads + 1;  // One job loading ahead while the others render
+    }
+
+    LineJob* jobs = &defaults;
+    int num_jobs = 1;
+    if (manifest && (jobs = read_manifest(manifest, &defaults, &num_jobs)) == NULL) {
+        return -1;
+    }
+    void** job_list = (void**) malloc(num_jobs * sizeof(void*));
+    if (job_list == NULL) {
+        printf("Error: Could not allocate the job list\n");
+        return -1;
+    }
+    for (int j = 0; j < num_jobs; j++) {
+        job_list[j] = &jobs[j];
+    }
+
+    // Every job's frames run on the same threads; the color tables are built before any of them start
+    paint_tables_init();
+    BatchCallbacks callbacks = { load_line_job, render_line_frame, finish_line_job,
+                                 line_worker_init, line_worker_free };
+    int failed = batch_pool_run(job_list, num_jobs, &callbacks, num_threads, window, 4);
+
+    free(job_list);
+    if (jobs != &defaults) {
+        free(jobs);
+    }
+
+    if (manifest) {
+        gettimeofday(&end_time, NULL);  // Record the wall-clock end time
+        double time_taken = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_usec - start_time.tv_usec) / 1e6;
+        printf("Batch: %d of %d jobs finished in %.3f seconds\n", failed < 0 ? 0 : num_jobs - failed, num_jobs,
+               time_taken);
+    }
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "line_set.h"
+#include "svg_scan.h"  // mapped, in-place attribute reading; safe to use from several threads at once
+#include "paint.h"     // SVG colors and the sRGB <-> linear tables
+
+// Function to allocate the arrays of a line set
+int line_set_init(LineSet* set, int capacity)
+{
+    memset(set, 0, sizeof(LineSet));
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    float** arrays[8] = { &set->x1, &set->y1, &set->x2, &set->y2, &set->width,
+                          &set->stroke_r, &set->stroke_g, &set->stroke_b };
+    for (int i = 0; i < 8; i++) {
+        *arrays[i] = (float*) malloc(capacity * sizeof(float));
+        if (*arrays[i] == NULL) {
+            printf("Error: Could not allocate a line set of %d lines\n", capacity);
+            line_set_free(set);
+            return -1;
+        }
+    }
+    set->capacity = capacity;
+    return 0;
+}
+
+// Function to release the arrays of a line set
+void line_set_free(LineSet* set)
+{
+    free(set->x1);
+    free(set->y1);
+    free(set->x2);
+    free(set->y2);
+    free(set->width);
+    free(set->stroke_r);
+    free(set->stroke_g);
+    free(set->stroke_b);
+    memset(set, 0, sizeof(LineSet));
+}
+
+// Function to double the capacity of every array in the set
+static int line_set_grow(LineSet* set)
+{
+    int capacity = set->capacity * 2;
+    float** arrays[8] = { &set->x1, &set->y1, &set->x2, &set->y2, &set->width,
+                          &set->stroke_r, &set->stroke_g, &set->stroke_b };
+    for (int i = 0; i < 8; i++) {
+        float* grown = (float*) realloc(*arrays[i], capacity * sizeof(float));
+        if (grown == NULL) {
+            printf("Error: Could not grow line set to %d lines\n", capacity);
+            return -1;
+        }
+        *arrays[i] = grown;
+    }
+    set->capacity = capacity;
+    return 0;
+}
+
+// Function to append one line to the set
+int line_set_add(LineSet* set, float x1, float y1, float x2, float y2, float width,
+                 float r, float g, float b)
+{
+    if (set->count == set->capacity && line_set_grow(set) == -1) {
+        return -1;
+    }
+    int i = set->count++;
+    set->x1[i] = x1;
+    set->y1[i] = y1;
+    set->x2[i] = x2;
+    set->y2[i] = y2;
+    set->width[i] = width;
+    set->stroke_r[i] = r;
+    set->stroke_g[i] = g;
+    set->stroke_b[i] = b;
+    return 0;
+}
+
+// Function to read a numeric attribute, returning fallback when it is missing (and 0 when it is not a number)
+static float get_float_prop(const SvgSpan* tag, const char* name, float fallback, int* present)
+{
+    SvgSpan value;
+    if (svg_attribute(tag, name, &value) == -1) {
+        if (present) {
+            *present = 0;
+        }
+        return fallback;
+    }
+    const char* cursor = value.start;
+    double number;
+    if (svg_parse_number(&cursor, value.start + value.length, &number) == -1) {
+        number = 0.0;
+    }
+    return (float)number;
+}
+
+// Function to collect every <line> element of the document
+static int collect_lines(const SvgFile* file, LineSet* set)
+{
+    size_t offset = 0;
+    SvgSpan tag;
+    while (svg_find_element(file, "line", &offset, &tag) == 0) {
+        int complete = 1;  // Lines without all four coordinates are skipped
+        float x1 = get_float_prop(&tag, "x1", 0, &complete);
+        float y1 = get_float_prop(&tag, "y1", 0, &complete);
+        float x2 = get_float_prop(&tag, "x2", 0, &complete);
+        float y2 = get_float_prop(&tag, "y2", 0, &complete);
+        if (!complete) {
+            continue;
+        }
+        float r = 0, g = 0, b = 0;  // Default stroke is black
+        char stroke[64];
+        if (svg_attribute_copy(&tag, "stroke", stroke, sizeof(stroke)) == 0 &&
+            parse_svg_color(stroke, &r, &g, &b) == -1) {
+            printf("Warning: Unknown color name '%s'. Using black.\n", stroke);
+        }
+
+        // Colors are stored in linear light so that blends between them look even
+        if (line_set_add(set, x1, y1, x2, y2, get_float_prop(&tag, "stroke-width", 1.0f, NULL),
+                         srgb_to_linear((int)r), srgb_to_linear((int)g), srgb_to_linear((int)b)) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Function to load all the lines of an SVG file
+int load_svg_lines(const char* filename, LineSet* set, int* width, int* height)
+{
+    paint_tables_init();
+    SvgFile file;
+    if (svg_file_map(filename, &file) == -1) {
+        return -1;
+    }
+    size_t offset = 0;
+    SvgSpan root;
+    if (svg_find_element(&file, "svg", &offset, &root) == -1) {
+        printf("Error: Could not find root element in %s\n", filename);
+        svg_file_unmap(&file);
+        return -1;
+    }
+    if (width) {
+        *width = (int)get_float_prop(&root, "width", 200, NULL);
+    }
+    if (height) {
+        *height = (int)get_float_prop(&root, "height", 200, NULL);
+    }
+    int status = collect_lines(&file, set);
+    svg_file_unmap(&file);
+    return status;
+}
+
+// Function to replace the lines of a set with `parts[i]` equal pieces of line i
+static int split_lines(LineSet* set, int target_count)
+{
+    LineSet split;
+    if (line_set_init(&split, target_count) == -1) {
+        return -1;
+    }
+    int base_parts = target_count / set->count;
+    int extra = target_count % set->count;  // The first `extra` lines get one more piece
+    for (int i = 0; i < set->count; i++) {
+        int num_parts = base_parts + (i < extra ? 1 : 0);
+        float dx = set->x2[i] - set->x1[i];
+        float dy = set->y2[i] - set->y1[i];
+        for (int k = 0; k < num_parts; k++) {
+            float t1 = (float)k / num_parts;
+            float t2 = (float)(k + 1) / num_parts;
+            line_set_add(&split, set->x1[i] + dx * t1, set->y1[i] + dy * t1,
+                         set->x1[i] + dx * t2, set->y1[i] + dy * t2, set->width[i],
+                         set->stroke_r[i], set->stroke_g[i], set->stroke_b[i]);
+        }
+    }
+    line_set_free(set);
+    *set = split;
+    return 0;
+}
+
+// Function to give both sets the same number of lines by splitting the smaller one
+int equalize_line_counts(LineSet* start, LineSet* final)
+{
+    if (start->count == 0 || final->count == 0) {
+        printf("Error: Both SVGs need at least one line\n");
+        return -1;
+    }
+    if (start->count == final->count) {
+        return 0;
+    }
+    if (start->count > final->count) {
+        return split_lines(final, start->count);
+    }
+    return split_lines(start, final->count);
+}
+
+// Function to interpolate every line attribute array at factor t
+void line_set_interpolate(const LineSet* start, const LineSet* final, float t, LineSet* out)
+{
+    int n = start->count;
+    out->count = n;
+
+    // One flat loop per array keeps the memory access contiguous and vectorizable
+    const float* a[8] = { start->x1, start->y1, start->x2, start->y2, start->width,
+                          start->stroke_r, start->stroke_g, start->stroke_b };
+    const float* b[8] = { final->x1, final->y1, final->x2, final->y2, final->width,
+                          final->stroke_r, final->stroke_g, final->stroke_b };
+    float* o[8] = { out->x1, out->y1, out->x2, out->y2, out->width,
+                    out->stroke_r, out->stroke_g, out->stroke_b };
+    for (int k = 0; k < 8; k++) {
+        const float* restrict from = a[k];
+        const float* restrict to = b[k];
+        float* restrict result = o[k];
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            result[i] = from[i] + (to[i] - from[i]) * t;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef LINE_SET_H
+#define LINE_SET_H
+
+// Define a set of SVG <line> strokes stored as contiguous arrays, one entry per line
+typedef struct {
+    int count;
+    int capacity;
+    float* x1;            // start points
+    float* y1;
+    float* x2;            // end points
+    float* y2;
+    float* width;         // stroke-width
+    float* stroke_r;      // stroke color channels in linear light, 0-1
+    float* stroke_g;
+    float* stroke_b;
+} LineSet;
+
+// Allocate room for capacity lines, returns 0 on success and -1 on failure
+int line_set_init(LineSet* set, int capacity);
+
+// Release the arrays of a line set
+void line_set_free(LineSet* set);
+
+// Append one line, growing the arrays when needed
+int line_set_add(LineSet* set, float x1, float y1, float x2, float y2, float width,
+                 float r, float g, float b);
+
+// Load every <line> element of an SVG file; width/height receive the canvas size if not NULL
+int load_svg_lines(const char* filename, LineSet* set, int* width, int* height);
+
+// Split lines of the smaller set into equal pieces until both sets have the same count
+int equalize_line_counts(LineSet* start, LineSet* final);
+
+// Interpolate endpoints, stroke width and color of every line at factor t into out
+// (which must have room for start->count lines)
+void line_set_interpolate(const LineSet* start, const LineSet* final, float t, LineSet* out);
+
+#endif
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "logger.h"
+
+#define LOG_BUFFER_SIZE 4096  // At most PIPE_BUF, so one write reaches a pipe in one piece
+
+// Define the messages a thread has formatted but not written yet
+typedef struct {
+    int length;
+    char data[LOG_BUFFER_SIZE];
+} LogBuffer;
+
+static __thread LogBuffer thread_buffer;
+static int log_level = LOG_INFO;
+
+struct Progress {
+    char label[64];
+    long long total_frames;
+    int interval_ms;
+    int terminal;                   // stderr is a terminal: reports overwrite each other
+    long long frames;               // updated with atomics by every stage
+    long long bytes;
+    struct timespec start;
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t stop;
+    pthread_t thread;
+};
+
+// Function to set the most detailed level that is written
+void log_set_level(LogLevel level)
+{
+    __atomic_store_n(&log_level, (int)level, __ATOMIC_RELAXED);
+}
+
+// Function to parse a level name
+int log_parse_level(const char* text, LogLevel* level)
+{
+    static const char* names[] = { "error", "warning", "info", "debug" };
+    for (int i = 0; i <= LOG_DEBUG; i++) {
+        if (strcmp(text, names[i]) == 0) {
+            *level = (LogLevel)i;
+            return 0;
+        }
+    }
+    printf("Error: Unknown log level '%s' (error, warning, info or debug)\n", text);
+    return -1;
+}
+
+// Function to tell whether a level is written
+int log_enabled(LogLevel level)
+{
+    return (int)level <= __atomic_load_n(&log_level, __ATOMIC_RELAXED);
+}
+
+// Function to write the calling thread's buffer to stderr in one piece
+void log_flush(void)
+{
+    LogBuffer* buffer = &thread_buffer;
+    const char* data = buffer->data;
+    size_t length = buffer->length;
+    while (length > 0) {
+        ssize_t written = write(STDERR_FILENO, data, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;  // Nowhere left to report to; the messages are dropped
+        }
+        data += written;
+        length -= written;
+    }
+    buffer->length = 0;
+}
+
+// Function to append a message to the calling thread's buffer
+void log_message(LogLevel level, const char* format, ...)
+{
+    if (!log_enabled(level)) {
+        return;
+    }
+    LogBuffer* buffer = &thread_buffer;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t room = LOG_BUFFER_SIZE - buffer->length;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, room, format, args);
+        va_end(args);
+        if (written < 0) {
+            return;
+        }
+        if ((size_t)written < room) {
+            buffer->length += written;
+            break;
+        }
+        if (buffer->length == 0) {
+            buffer->length = LOG_BUFFER_SIZE - 1;  // Longer than a whole buffer: keep what fits
+            break;
+        }
+        log_flush();  // Make room, then format the message again
+    }
+    if (level != LOG_DEBUG) {
+        log_flush();
+    }
+}
+
+// Function to measure the seconds since the progress started
+static double progress_elapsed(const Progress* progress)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - progress->start.tv_sec) + (now.tv_nsec - progress->start.tv_nsec) / 1e9;
+}
+
+// Function to log one report of the counters so far
+static void progress_report(const Progress* progress)
+{
+    long long frames = __atomic_load_n(&progress->frames, __ATOMIC_RELAXED);
+    long long bytes = __atomic_load_n(&progress->bytes, __ATOMIC_RELAXED);
+    double elapsed = progress_elapsed(progress);
+    double rate = elapsed > 0.0 ? frames / elapsed : 0.0;
+    char eta[32] = "ETA unknown";
+    if (rate > 0.0 && progress->total_frames > 0) {
+        snprintf(eta, sizeof(eta), "ETA %.0f s", (progress->total_frames - frames) / rate);
+    }
+    double percent = progress->total_frames > 0 ? 100.0 * frames / progress->total_frames : 0.0;
+    // On a terminal each report overwrites the last; log collectors get one line per report
+    log_message(LOG_INFO, "%s%s: %lld/%lld frames (%.1f%%), %.0f frames/s, %.1f MB written, %s%s",
+                progress->terminal ? "\r\033[K" : "", progress->label, frames, progress->total_frames, percent, rate,
+                bytes / 1e6, eta, progress->terminal ? "" : "\n");
+}
+
+// Reporter thread: wakes every interval until the progress is finished
+static void* progress_reporter(void* arg)
+{
+    Progress* progress = (Progress*) arg;
+    pthread_mutex_lock(&progress->lock);
+    while (!progress->stopping) {
+        struct timespec wake;
+        clock_gettime(CLOCK_MONOTONIC, &wake);
+        wake.tv_sec += progress->interval_ms / 1000;
+        wake.tv_nsec += (long)(progress->interval_ms % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        int status = 0;
+        while (!progress->stopping && status != ETIMEDOUT) {
+            status = pthread_cond_timedwait(&progress->stop, &progress->lock, &wake);
+        }
+        if (!progress->stopping) {
+            progress_report(progress);
+        }
+    }
+    pthread_mutex_unlock(&progress->lock);
+    return NULL;
+}
+
+// Function to start counting and, with an interval, the reporter thread
+Progress* progress_start(const char* label, long long total_frames, int interval_ms)
+{
+    Progress* progress = (Progress*) calloc(1, sizeof(Progress));
+    if (progress == NULL) {
+        printf("Error: Could not allocate the progress reporter\n");
+        return NULL;
+    }
+    snprintf(progress->label, sizeof(progress->label), "%s", label);
+    progress->total_frames = total_frames;
+    progress->interval_ms = interval_ms > 0 ? interval_ms : 0;
+    progress->terminal = isatty(STDERR_FILENO);
+    clock_gettime(CLOCK_MONOTONIC, &progress->start);
+    pthread_mutex_init(&progress->lock, NULL);
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);  // Clock changes do not skew the interval
+    pthread_cond_init(&progress->stop, &attributes);
+    pthread_condattr_destroy(&attributes);
+    if (progress->interval_ms > 0 && pthread_create(&progress->thread, NULL, progress_reporter, progress) != 0) {
+        printf("Error: Could not start the progress reporter\n");
+        pthread_cond_destroy(&progress->stop);
+        pthread_mutex_destroy(&progress->lock);
+        free(progress);
+        return NULL;
+    }
+    return progress;
+}
+
+// Function to add to the counters
+void progress_add(Progress* progress, long long frames, long long bytes)
+{
+    if (progress == NULL) {
+        return;
+    }
+    if (frames) {
+        __atomic_add_fetch(&progress->frames, frames, __ATOMIC_RELAXED);
+    }
+    if (bytes) {
+        __atomic_add_fetch(&progress->bytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+// Function to stop the reporter and log the summary
+void progress_finish(Progress* progress)
+{
+    if (progress == NULL) {
+        return;
+    }
+    if (progress->interval_ms > 0) {
+        pthread_mutex_lock(&progress->lock);
+        progress->stopping = 1;
+        pthread_cond_signal(&progress->stop);
+        pthread_mutex_unlock(&progress->lock);
+        pthread_join(progress->thread, NULL);
+    }
+    double elapsed = progress_elapsed(progress);
+    log_message(LOG_INFO, "%s%s: %lld frames in %.3f s (%.0f frames/s), %.1f MB written\n",
+                progress->terminal && progress->interval_ms > 0 ? "\r\033[K" : "", progress->label, progress->frames,
+                elapsed, elapsed > 0.0 ? progress->frames / elapsed : 0.0, progress->bytes / 1e6);
+    pthread_cond_destroy(&progress->stop);
+    pthread_mutex_destroy(&progress->lock);
+    free(progress);
+}
@@ -0,0 +1,42 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// How much gets logged; every level includes the ones above it
+typedef enum {
+    LOG_ERROR,
+    LOG_WARNING,
+    LOG_INFO,       // run summaries and progress reports (the default)
+    LOG_DEBUG       // one line per frame
+} LogLevel;
+
+// Set the most detailed level that is written
+void log_set_level(LogLevel level);
+
+// Parse "error", "warning", "info" or "debug", returns 0 on success and -1 on failure
+int log_parse_level(const char* text, LogLevel* level);
+
+// Tell whether messages of this level are written, so callers can skip preparing them
+int log_enabled(LogLevel level);
+
+// Format a message into the calling thread's own buffer, without taking the stdio lock.
+// Debug messages wait there until the buffer fills or log_flush is called; the other levels
+// are written to stderr at once. Every buffer is written whole, so lines never interleave
+void log_message(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Write the calling thread's buffered messages; threads call this before they exit
+void log_flush(void);
+
+// Opaque progress state (counters and the reporter thread)
+typedef struct Progress Progress;
+
+// Start a thread that reports frames/s, bytes written and the ETA of total_frames at info level
+// every interval_ms milliseconds (0: only the final summary). Returns NULL on failure
+Progress* progress_start(const char* label, long long total_frames, int interval_ms);
+
+// Count finished frames and written bytes; any thread may call it, and a NULL progress is ignored
+void progress_add(Progress* progress, long long frames, long long bytes);
+
+// Stop the reporter, log the summary of the run and release the progress
+void progress_finish(Progress* progress);
+
+#endif
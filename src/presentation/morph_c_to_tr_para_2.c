@@ -8,6 +8,7 @@
 #include <time.h>  // Include time.h for execution time measurement
 #include <sys/time.h>  //time execution
 #include <omp.h>    // Include OpenMP for parallelism
+#include "svg_format.h" // quantized coordinate output
 
 // Function prototypes
 int extract_circle_info(const char* svg_file, float* cx, float* cy, float* r);
@@ -111,10 +112,28 @@ void write_svg(char* interpolated_points, int frame_number) {
 }
 
 // Main function to perform the morphing and generate SVG frames
-int main() {
+int main(int argc, char** argv) {
     struct timeval start, end;
     gettimeofday(&start, NULL);  // record the wall-clock start time
 
+    // Optional coordinate quantization: --precision N and/or --grid STEP
+    int decimals = -1;
+    float grid = 0.0f;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            decimals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            grid = atof(argv[++i]);
+        } else {
+            printf("Usage: %s [--precision N] [--grid STEP]\n", argv[0]);
+            return -1;
+        }
+    }
+    CoordFormat coord_format;
+    if (coord_format_init(&coord_format, decimals, grid) == -1) {
+        return -1;
+    }
+
     float cx, cy, r;
     float triangle_vertices[3][2];
 
@@ -144,8 +163,8 @@ int main() {
     for (int frame = 0; frame < total_frames; frame++) {
         float t = (float)frame / (total_frames - 1);  // `t` smoothly ranges from 0 to 1
 
-        char interpolated_points[1024] = "";
-        char point[50];
+        char interpolated_points[1024];
+        float points_x[num_circle_points], points_y[num_circle_points];
 
         // Calculate interpolated points between circle and triangle vertices using Bézier curves
         for (int i = 0; i < num_circle_points; i++) {
@@ -158,14 +177,12 @@ int main() {
             float ty = triangle_vertex[1];
 
             float* control_point = control_points[i % 3];
-            float interp_x = bezier_point(circle_x, control_point[0], tx, t);
-            float interp_y = bezier_point(circle_y, control_point[1], ty, t);
-
-            sprintf(point, "%f,%f ", interp_x, interp_y);
-            strcat(interpolated_points, point);
+            points_x[i] = bezier_point(circle_x, control_point[0], tx, t);
+            points_y[i] = bezier_point(circle_y, control_point[1], ty, t);
         }
 
-        interpolated_points[strlen(interpolated_points) - 1] = '\0';
+        format_points(interpolated_points, sizeof(interpolated_points), points_x, points_y,
+                      num_circle_points, &coord_format);
         write_svg(interpolated_points, frame);
     }
 
@@ -0,0 +1,574 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "svg_scan.h"  // mmap-based tokenizer; attribute values are parsed in place
+#include "morph_engine.h"
+
+// Function to extract circle attributes (cx, cy, r) from an SVG file
+int extract_circle_info(const char* svg_file, float* cx, float* cy, float* r)
+{
+    SvgFile file;
+    if (svg_file_map(svg_file, &file) == -1) {
+        return -1;
+    }
+
+    // Take the first <circle> that has all three attributes
+    size_t offset = 0;
+    SvgSpan tag;
+    int status = -1;
+    while (status == -1 && svg_find_element(&file, "circle", &offset, &tag) == 0) {
+        if (svg_attribute_float(&tag, "cx", cx) == 0 && svg_attribute_float(&tag, "cy", cy) == 0 &&
+            svg_attribute_float(&tag, "r", r) == 0) {
+            status = 0;
+        }
+    }
+
+    svg_file_unmap(&file);
+    return status;
+}
+
+// Function to extract every vertex of the first <polygon> with a points list
+int extract_polygon_points(const char* svg_file, float** xy)
+{
+    SvgFile file;
+    if (svg_file_map(svg_file, &file) == -1) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    SvgSpan tag, points;
+    int count = -1;
+    while (svg_find_element(&file, "polygon", &offset, &tag) == 0) {
+        if (svg_attribute(&tag, "points", &points) == 0) {
+            count = svg_parse_points(&points, xy);
+            break;
+        }
+    }
+
+    svg_file_unmap(&file);
+    return count;
+}
+
+// Function to extract triangle points from an SVG file's <polygon> element
+int extract_triangle_info(const char* svg_file, float triangle[3][2])
+{
+    float* xy = NULL;
+    int count = extract_polygon_points(svg_file, &xy);
+    if (count == -1) {
+        return -1;
+    }
+    if (count < 3) {
+        printf("Error: The polygon in %s has %d vertices, a triangle needs 3\n", svg_file, count);
+        free(xy);
+        return -1;
+    }
+    for (int i = 0; i < 3; i++) {
+        triangle[i][0] = xy[2 * i];
+        triangle[i][1] = xy[2 * i + 1];
+    }
+    free(xy);
+    return 0;
+}
+
+// Function to calculate a quadratic Bézier curve point given three points and a factor `t`
+float bezier_point(float p0, float p1, float p2, float t) 
+{
+    // Quadratic Bézier formula to smoothly transition from p0 to p2, with p1 as control
+    return pow(1 - t, 2) * p0 + 2 * (1 - t) * t * p1 + t * t * p2;
+}
+
+// Kernels: one loop per curve degree, stamped out by a macro for the padded sizes of small shapes
+// (16 to 64 points: triangles, quads, icons) with the trip count a constant, so the compiler
+// unrolls it completely into aligned vector code, and once more for any size. rows holds the
+// degree + 1 rows of one axis (plans: source, control, target; timelines: a, b, c, d) and the
+// kernel writes count coordinates, count being the padded size for the fixed ones
+#define MORPH_KERNEL(name, size, setup, expression)                                              \
+    static void name(const float* const* rows, float t, float* destination, int count)           \
+    {                                                                                            \
+        const int fixed = (size);                                                                \
+        float* restrict out = fixed ? __builtin_assume_aligned(destination, POLYGON_ALIGN) : destination; \
+        const float* restrict a = KERNEL_ROW(0);                                                 \
+        const float* restrict b = KERNEL_ROW(1);                                                 \
+        const float* restrict c = KERNEL_ROW(2);                                                 \
+        setup                                                                                    \
+        if (fixed) {                                                                             \
+            _Pragma("GCC unroll 64")                                                             \
+            for (int i = 0; i < fixed; i++) {                                                    \
+                out[i] = expression;                                                             \
+            }                                                                                    \
+        } else {                                                                                 \
+            _Pragma("omp simd")                                                                  \
+            for (int i = 0; i < count; i++) {                                                    \
+                out[i] = expression;                                                             \
+            }                                                                                    \
+        }                                                                                        \
+    }
+
+// Row k of a kernel's input; the fixed sizes only ever see padded, aligned polygon rows
+#define KERNEL_ROW(k) (fixed ? __builtin_assume_aligned(rows[k], POLYGON_ALIGN) : (const void*) rows[k])
+
+// Stamp out the five sizes of one degree and the table dispatch picks from
+#define MORPH_KERNEL_SIZES(degree, setup, expression)                                            \
+    MORPH_KERNEL(degree##_any, 0, setup, expression)                                             \
+    MORPH_KERNEL(degree##_16, 16, setup, expression)                                             \
+    MORPH_KERNEL(degree##_32, 32, setup, expression)                                             \
+    MORPH_KERNEL(degree##_48, 48, setup, expression)                                             \
+    MORPH_KERNEL(degree##_64, 64, setup, expression)                                             \
+    static const MorphKernel degree##_kernels[5] = {                                             \
+        degree##_any, degree##_16, degree##_32, degree##_48, degree##_64                         \
+    };
+
+// Straight line from source to target (the control row is not read)
+MORPH_KERNEL_SIZES(linear, (void) b;, a[i] + (c[i] - a[i]) * t)
+
+// Quadratic Bézier with the weights of bezier_point, taken out of the loop with the same rounding
+MORPH_KERNEL_SIZES(quadratic,
+                   double w0 = pow(1 - t, 2); float w1 = 2 * (1 - t) * t; float w2 = t * t;,
+                   w0 * a[i] + w1 * b[i] + w2 * c[i])
+
+// Cubic in Horner form, ((a * s + b) * s + c) * s + d, with t as the segment factor s
+MORPH_KERNEL_SIZES(cubic,
+                   const float* restrict d = KERNEL_ROW(3);,
+                   ((a[i] * t + b[i]) * t + c[i]) * t + d[i])
+
+// Function to pick a kernel once per plan or timeline: the fixed-size one for its padded size,
+// or the one for any size
+static MorphKernel pick_kernel(const MorphKernel* kernels, int padded)
+{
+    return (padded <= 4 * POLYGON_LANES) ? kernels[padded / POLYGON_LANES] : kernels[0];
+}
+
+// Function to take zeroed, 64-byte aligned memory for plan or timeline storage from an arena, or
+// from the heap without one
+static void* engine_alloc(Arena* arena, size_t bytes)
+{
+    if (arena) {
+        return arena_alloc(arena, bytes);
+    }
+    bytes = (bytes + POLYGON_ALIGN - 1) / POLYGON_ALIGN * POLYGON_ALIGN;  // aligned_alloc needs a multiple
+    void* memory = aligned_alloc(POLYGON_ALIGN, bytes ? bytes : POLYGON_ALIGN);
+    if (memory) {
+        memset(memory, 0, bytes);
+    }
+    return memory;
+}
+
+// Function to allocate a plan with room for num_points points
+static MorphPlan* morph_plan_alloc(Arena* arena, int num_points)
+{
+    MorphPlan* plan = (MorphPlan*) engine_alloc(arena, sizeof(MorphPlan));
+    if (plan == NULL) {
+        printf("Error: Could not allocate morph plan\n");
+        return NULL;
+    }
+    plan->num_points = num_points;
+    plan->arena = arena;  // Set first: destroying a half-built arena plan must not free() into the arena
+    if (polygon_init(&plan->source, arena, num_points) == -1 ||
+        polygon_init(&plan->control, arena, num_points) == -1 ||
+        polygon_init(&plan->target, arena, num_points) == -1) {
+        printf("Error: Could not allocate morph plan for %d points\n", num_points);
+        morph_plan_destroy(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+// Function to record a plan's curve degree and pick its kernels for the rest of the run
+static void morph_plan_set_degree(MorphPlan* plan, int degree)
+{
+    const MorphKernel* kernels = (degree == 1) ? linear_kernels : quadratic_kernels;
+    plan->degree = degree;
+    plan->kernel = pick_kernel(kernels, plan->source.capacity);
+    plan->any_kernel = kernels[0];
+}
+
+// Function to create a plan from interleaved x,y point arrays
+MorphPlan* morph_plan_create(int num_points, const float* source_xy, const float* control_xy,
+                             const float* target_xy)
+{
+    return morph_plan_create_in(NULL, num_points, source_xy, control_xy, target_xy);
+}
+
+// Function to create a plan from interleaved x,y point arrays in an arena
+MorphPlan* morph_plan_create_in(Arena* arena, int num_points, const float* source_xy, const float* control_xy,
+                                const float* target_xy)
+{
+    MorphPlan* plan = morph_plan_alloc(arena, num_points);
+    if (plan == NULL) {
+        return NULL;
+    }
+    polygon_load_xy(&plan->source, source_xy);
+    polygon_load_xy(&plan->target, target_xy);
+    morph_plan_set_degree(plan, control_xy ? 2 : 1);
+    if (control_xy) {
+        polygon_load_xy(&plan->control, control_xy);
+    } else {
+        // A control point halfway along the segment turns the curve into a straight line
+        for (int i = 0; i < num_points; i++) {
+            plan->control.x[i] = 0.5f * (plan->source.x[i] + plan->target.x[i]);
+            plan->control.y[i] = 0.5f * (plan->source.y[i] + plan->target.y[i]);
+        }
+    }
+    return plan;
+}
+
+// Function to create the circle-to-triangle plan, sampling the circle once up front
+MorphPlan* morph_plan_circle_to_triangle(float cx, float cy, float r, float triangle[3][2], int num_points)
+{
+    return morph_plan_circle_to_triangle_in(NULL, cx, cy, r, triangle, num_points);
+}
+
+// Function to create the circle-to-triangle plan in an arena
+MorphPlan* morph_plan_circle_to_triangle_in(Arena* arena, float cx, float cy, float r, float triangle[3][2],
+                                            int num_points)
+{
+    MorphPlan* plan = morph_plan_alloc(arena, num_points);
+    if (plan == NULL) {
+        return NULL;
+    }
+    float control_points[3][2] = {  // Control points for Bézier curve transition
+        {cx + 0.5 * r, cy},         // Control point for 1st vertex
+        {cx, cy - 0.5 * r},         // Control point for 2nd vertex
+        {cx - 0.5 * r, cy}          // Control point for 3rd vertex
+    };
+    // Couldn't have used the bezier curve method without these lines of code from 3rd source
+    for (int i = 0; i < num_points; i++) {
+        // Initial point on the circle
+        float angle = (2 * M_PI / num_points) * i;
+        plan->source.x[i] = cx + r * cos(angle);
+        plan->source.y[i] = cy + r * sin(angle);
+
+        // Target vertex for this point and corresponding control point
+        plan->control.x[i] = control_points[i % 3][0];
+        plan->control.y[i] = control_points[i % 3][1];
+        plan->target.x[i] = triangle[i % 3][0];
+        plan->target.y[i] = triangle[i % 3][1];
+    }
+    morph_plan_set_degree(plan, 2);
+    return plan;
+}
+
+// Function to free a plan and everything it owns
+void morph_plan_destroy(MorphPlan* plan)
+{
+    if (plan == NULL || plan->arena) {
+        return;
+    }
+    polygon_free(&plan->source);
+    polygon_free(&plan->control);
+    polygon_free(&plan->target);
+    free(plan);
+}
+
+// Function to compute every point of the shape at factor t
+void morph_plan_evaluate(const MorphPlan* plan, float t, float* out_x, float* out_y)
+{
+    const float* rows_x[3] = { plan->source.x, plan->control.x, plan->target.x };
+    const float* rows_y[3] = { plan->source.y, plan->control.y, plan->target.y };
+    plan->any_kernel(rows_x, t, out_x, plan->num_points);
+    plan->any_kernel(rows_y, t, out_y, plan->num_points);
+}
+
+// Function to compute the shape at factor t into a polygon with the kernel picked for the plan's
+// padded size, whole aligned vectors at a time
+void morph_plan_evaluate_polygon(const MorphPlan* plan, float t, Polygon* out)
+{
+    const float* rows_x[3] = { plan->source.x, plan->control.x, plan->target.x };
+    const float* rows_y[3] = { plan->source.y, plan->control.y, plan->target.y };
+    plan->kernel(rows_x, t, out->x, plan->source.capacity);
+    plan->kernel(rows_y, t, out->y, plan->source.capacity);
+    out->num_vertices = plan->num_points;
+}
+
+// Define how the frame selection computes a shape, so plans and timelines share it
+typedef void (*ShapeEvaluator)(const void* shape, float t, float* out_x, float* out_y);
+
+// Function to evaluate a plan through the shared evaluator signature
+static void evaluate_plan(const void* shape, float t, float* out_x, float* out_y)
+{
+    morph_plan_evaluate((const MorphPlan*) shape, t, out_x, out_y);
+}
+
+// Function to evaluate a timeline through the shared evaluator signature
+static void evaluate_timeline(const void* shape, float t, float* out_x, float* out_y)
+{
+    morph_timeline_evaluate((const MorphTimeline*) shape, t, out_x, out_y);
+}
+
+// Function to pick the candidate frames an adaptive animation shows: a frame is kept once some
+// vertex has moved more than tolerance since the last kept frame, so holding each kept frame
+// until the next one is never further than tolerance from the true shape
+static int select_frames(const void* shape, ShapeEvaluator evaluate, int n, const float* frame_times, int count,
+                         float tolerance, int* selected)
+{
+    float* shown = (float*) malloc((size_t)n * 4 * sizeof(float));  // last kept frame, then the candidate
+    if (shown == NULL || count < 1) {
+        free(shown);
+        return -1;
+    }
+    float* shown_x = shown;
+    float* shown_y = shown + n;
+    float* candidate_x = shown + 2 * n;
+    float* candidate_y = shown + 3 * n;
+    float limit = tolerance * tolerance;
+
+    evaluate(shape, frame_times[0], shown_x, shown_y);
+    selected[0] = 0;
+    int num_selected = 1;
+    for (int k = 1; k < count; k++) {
+        evaluate(shape, frame_times[k], candidate_x, candidate_y);
+        int moved = (k == count - 1);  // The final shape is always shown
+        for (int i = 0; i < n && !moved; i++) {
+            float dx = candidate_x[i] - shown_x[i];
+            float dy = candidate_y[i] - shown_y[i];
+            moved = (dx * dx + dy * dy > limit);
+        }
+        if (moved) {
+            selected[num_selected++] = k;
+            memcpy(shown_x, candidate_x, n * sizeof(float));
+            memcpy(shown_y, candidate_y, n * sizeof(float));
+        }
+    }
+    free(shown);
+    return num_selected;
+}
+
+// Function to pick the frames of an adaptive animation of a plan
+int morph_plan_select_frames(const MorphPlan* plan, const float* frame_times, int count, float tolerance,
+                             int* selected)
+{
+    return select_frames(plan, evaluate_plan, plan->num_points, frame_times, count, tolerance, selected);
+}
+
+// Function to pick the frames of an adaptive animation of a timeline
+int morph_timeline_select_frames(const MorphTimeline* timeline, const float* frame_times, int count,
+                                 float tolerance, int* selected)
+{
+    return select_frames(timeline, evaluate_timeline, timeline->num_points, frame_times, count, tolerance,
+                         selected);
+}
+
+// Function to bring any outline to num_points points: a polygon with another vertex count is
+// resampled by index (vertices repeat or are skipped, in order), a circle is sampled evenly
+void morph_outline_resample(const float* xy, int count, int num_points, float* out)
+{
+    double perimeter = 0.0;
+    for (int e = 0; e < count; e++) {
+        int f = (e + 1) % count;
+        perimeter += hypot(xy[2 * f] - xy[2 * e], xy[2 * f + 1] - xy[2 * e + 1]);
+    }
+    if (num_points < count || perimeter <= 0.0) {
+        // Fewer points (or a single spot): pick vertices by index
+        for (long long i = 0; i < num_points; i++) {
+            long long j = i * count / num_points;
+            out[2 * i] = xy[2 * j];
+            out[2 * i + 1] = xy[2 * j + 1];
+        }
+        return;
+    }
+
+    // Keep every vertex and share the extra points among the closed outline's edges by length
+    int extra = num_points - count;
+    double length = 0.0;
+    int written = 0;
+    for (int e = 0; e < count; e++) {
+        int f = (e + 1) % count;
+        float dx = xy[2 * f] - xy[2 * e], dy = xy[2 * f + 1] - xy[2 * e + 1];
+        length += hypot(dx, dy);
+        int end = e + 1 + (int) lround(extra * (length / perimeter));  // points written once this edge is done
+        int on_edge = end - written;
+        for (int k = 0; k < on_edge; k++) {
+            out[2 * written] = xy[2 * e] + dx * k / on_edge;
+            out[2 * written + 1] = xy[2 * e + 1] + dy * k / on_edge;
+            written++;
+        }
+    }
+}
+
+// Function to sample a circle as an outline of num_points points
+void morph_outline_circle(float cx, float cy, float r, int num_points, float* out)
+{
+    for (int i = 0; i < num_points; i++) {
+        float angle = (2 * M_PI / num_points) * i;
+        out[2 * i] = cx + r * cos(angle);
+        out[2 * i + 1] = cy + r * sin(angle);
+    }
+}
+
+// Function to build a keyframe timeline. Each point gets Catmull-Rom tangents (finite differences
+// over the neighbouring keyframes, one-sided at the ends) and every segment is stored as the
+// cubic Hermite polynomial in the segment's local factor, so a frame is one Horner step per point
+MorphTimeline* morph_timeline_create(int num_keys, int num_points, const float* const* keys_xy,
+                                     const float* key_times)
+{
+    return morph_timeline_create_in(NULL, num_keys, num_points, keys_xy, key_times);
+}
+
+// Function to build a keyframe timeline in an arena
+MorphTimeline* morph_timeline_create_in(Arena* arena, int num_keys, int num_points, const float* const* keys_xy,
+                                        const float* key_times)
+{
+    if (num_keys < 2 || num_points < 1) {
+        printf("Error: A timeline needs at least 2 keyframes\n");
+        return NULL;
+    }
+    MorphTimeline* timeline = (MorphTimeline*) engine_alloc(arena, sizeof(MorphTimeline));
+    if (timeline == NULL) {
+        printf("Error: Could not allocate the timeline\n");
+        return NULL;
+    }
+    timeline->num_keys = num_keys;
+    timeline->num_points = num_points;
+    timeline->arena = arena;
+    timeline->kernel = pick_kernel(cubic_kernels, polygon_padded(num_points));
+    timeline->any_kernel = cubic_kernels[0];
+    timeline->key_times = (float*) engine_alloc(arena, num_keys * sizeof(float));
+    timeline->stride = polygon_padded(num_points);
+    timeline->coefficients = (float*) engine_alloc(arena, (size_t)(num_keys - 1) * 8 * timeline->stride * sizeof(float));
+    if (timeline->key_times == NULL || timeline->coefficients == NULL) {
+        printf("Error: Could not allocate a timeline of %d keyframes of %d points\n", num_keys, num_points);
+        morph_timeline_destroy(timeline);
+        return NULL;
+    }
+
+    // Key times are normalized to 0..1; without them the keyframes are evenly spaced
+    for (int k = 0; k < num_keys; k++) {
+        timeline->key_times[k] = key_times
+            ? (key_times[k] - key_times[0]) / (key_times[num_keys - 1] - key_times[0])
+            : (float)k / (num_keys - 1);
+        if (k > 0 && !(timeline->key_times[k] > timeline->key_times[k - 1])) {
+            printf("Error: Keyframe times must increase\n");
+            morph_timeline_destroy(timeline);
+            return NULL;
+        }
+    }
+
+    const float* times = timeline->key_times;
+    for (int k = 0; k < num_keys - 1; k++) {
+        float h = times[k + 1] - times[k];
+        int before = (k > 0) ? k - 1 : k;                      // Neighbours for the tangent at key k
+        int after = (k + 2 < num_keys) ? k + 2 : k + 1;        // ... and at key k + 1
+        float* c = timeline->coefficients + (size_t)k * 8 * timeline->stride;
+        for (int i = 0; i < num_points; i++) {
+            for (int axis = 0; axis < 2; axis++) {
+                float p0 = keys_xy[k][2 * i + axis];
+                float p1 = keys_xy[k + 1][2 * i + axis];
+                float m0 = (p1 - keys_xy[before][2 * i + axis]) / (times[k + 1] - times[before]);
+                float m1 = (keys_xy[after][2 * i + axis] - p0) / (times[after] - times[k]);
+                // Hermite basis in s = (t - t_k) / h, tangents scaled to the segment length
+                float* row = c + (size_t)4 * axis * timeline->stride;
+                row[i] = 2 * p0 + h * m0 - 2 * p1 + h * m1;
+                row[timeline->stride + i] = -3 * p0 - 2 * h * m0 + 3 * p1 - h * m1;
+                row[2 * timeline->stride + i] = h * m0;
+                row[3 * timeline->stride + i] = p0;
+            }
+        }
+    }
+    return timeline;
+}
+
+// Function to free a timeline
+void morph_timeline_destroy(MorphTimeline* timeline)
+{
+    if (timeline == NULL || timeline->arena) {
+        return;
+    }
+    free(timeline->key_times);
+    free(timeline->coefficients);
+    free(timeline);
+}
+
+// Function to find the keyframe segment of t and the factor inside it; t outside 0..1 (overshooting
+// easings) extends the first or last segment
+void morph_timeline_locate(const MorphTimeline* timeline, float t, int* segment, float* s)
+{
+    int k = 0;
+    while (k < timeline->num_keys - 2 && t >= timeline->key_times[k + 1]) {
+        k++;
+    }
+    *segment = k;
+    *s = (t - timeline->key_times[k]) / (timeline->key_times[k + 1] - timeline->key_times[k]);
+}
+
+// Function to compute every point of the shape at timeline factor t
+void morph_timeline_evaluate(const MorphTimeline* timeline, float t, float* out_x, float* out_y)
+{
+    int segment;
+    float s;
+    morph_timeline_locate(timeline, t, &segment, &s);
+    int stride = timeline->stride;
+    const float* c = timeline->coefficients + (size_t)segment * 8 * stride;
+    const float* rows_x[4] = { c, c + stride, c + 2 * stride, c + 3 * stride };
+    const float* rows_y[4] = { c + 4 * stride, c + 5 * stride, c + 6 * stride, c + 7 * stride };
+    timeline->any_kernel(rows_x, s, out_x, timeline->num_points);
+    timeline->any_kernel(rows_y, s, out_y, timeline->num_points);
+}
+
+// Function to compute the shape at timeline factor t into a polygon, whole aligned vectors at a time
+void morph_timeline_evaluate_polygon(const MorphTimeline* timeline, float t, Polygon* out)
+{
+    int segment;
+    float s;
+    morph_timeline_locate(timeline, t, &segment, &s);
+    int stride = timeline->stride;
+    const float* c = timeline->coefficients + (size_t)segment * 8 * stride;
+    const float* rows_x[4] = { c, c + stride, c + 2 * stride, c + 3 * stride };
+    const float* rows_y[4] = { c + 4 * stride, c + 5 * stride, c + 6 * stride, c + 7 * stride };
+    timeline->kernel(rows_x, s, out->x, stride);
+    timeline->kernel(rows_y, s, out->y, stride);
+    out->num_vertices = timeline->num_points;
+}
+
+// Function to allocate a frame buffer the engine owns (aligned for vector loads)
+float* morph_frames_alloc(int count, int num_points)
+{
+    size_t bytes = (size_t)count * num_points * 2 * sizeof(float);
+    bytes = (bytes + 63) / 64 * 64;  // aligned_alloc needs a multiple of the alignment
+    float* frames = (float*) aligned_alloc(64, bytes ? bytes : 64);
+    if (frames == NULL) {
+        printf("Error: Could not allocate %d frames of %d points\n", count, num_points);
+    }
+    return frames;
+}
+
+// Function to release a frame buffer
+void morph_frames_free(float* frames)
+{
+    free(frames);
+}
+
+// Function to compute a range of frames into a caller-provided buffer
+int morph_plan_render(const MorphPlan* plan, int first_frame, int count, int total_frames, float* frames)
+{
+    int n = plan->num_points;
+    if (count <= 0 || total_frames < 2 || frames == NULL || first_frame < 0 ||
+        first_frame > total_frames - count) {
+        printf("Error: Frames %d to %d are outside an animation of %d frames\n", first_frame,
+               first_frame + count - 1, total_frames);
+        return -1;
+    }
+
+    // Every thread evaluates its frames with the plan's kernel into its own x[]/y[] scratch, then
+    // interleaves them, so frames match morph_plan_evaluate_polygon bit for bit
+    int status = 0;
+    #pragma omp parallel
+    {
+        Polygon scratch = { 0 };
+        int ready = (polygon_init(&scratch, NULL, n) == 0);
+        if (!ready) {
+            #pragma omp atomic write
+            status = -1;
+        }
+        #pragma omp for schedule(static)
+        for (int k = 0; k < count; k++) {
+            if (ready) {
+                float t = (float)(first_frame + k) / (total_frames - 1);  // `t` ranges from 0 to 1 smoothly
+                morph_plan_evaluate_polygon(plan, t, &scratch);
+                polygon_store_xy(&scratch, frames + (size_t)k * n * 2);
+            }
+        }
+        polygon_free(&scratch);
+    }
+    return status;
+}
@@ -0,0 +1,128 @@
+#ifndef MORPH_ENGINE_H
+#define MORPH_ENGINE_H
+
+#include "arena.h"
+#include "polygon.h"    // 64-byte aligned, padded x[] / y[] outlines
+
+// Define a kernel that evaluates one axis of a plan or timeline: count coordinates from the rows
+// of curve coefficients at factor t
+typedef void (*MorphKernel)(const float* const* rows, float t, float* out, int count);
+
+// Define a morph plan: every point follows a quadratic Bézier curve from its source
+// position, pulled by a control point, to its target position
+typedef struct {
+    int num_points;
+    Polygon source;           // positions at t = 0
+    Polygon control;          // Bézier control points
+    Polygon target;           // positions at t = 1
+    int degree;               // 1 when every control point is a midpoint (straight lines), else 2
+    MorphKernel kernel;       // picked once for the degree and padded size, for polygons
+    MorphKernel any_kernel;   // same degree for unpadded caller buffers
+    Arena* arena;             // owner of the storage, NULL when it came from the heap
+} MorphPlan;
+
+// Define a keyframe timeline: every point follows a Catmull-Rom spline through its position in
+// each keyframe. Between keyframes k and k + 1 a coordinate is one cubic in the local factor s,
+// ((a * s + b) * s + c) * s + d, with the coefficients computed once when the timeline is built
+typedef struct {
+    int num_keys;
+    int num_points;
+    int stride;               // num_points padded to whole vectors (polygon_padded)
+    float* key_times;         // when each keyframe is reached, 0 to 1
+    float* coefficients;      // (num_keys - 1) segments x {ax, bx, cx, dx, ay, by, cy, dy} rows of
+                              // stride floats each, 64-byte aligned
+    MorphKernel kernel;       // picked once for the padded size, for polygons
+    MorphKernel any_kernel;   // for unpadded caller buffers
+    Arena* arena;             // owner of the storage, NULL when it came from the heap
+} MorphTimeline;
+
+// Extract circle attributes (cx, cy, r) from the first <circle> of an SVG file
+int extract_circle_info(const char* svg_file, float* cx, float* cy, float* r);
+
+// Extract every vertex of the first <polygon> of an SVG file into a malloc'ed interleaved x,y
+// array (freed by the caller). Returns the number of vertices, or -1 on failure
+int extract_polygon_points(const char* svg_file, float** xy);
+
+// Extract the first three vertices of the first <polygon> of an SVG file
+int extract_triangle_info(const char* svg_file, float triangle[3][2]);
+
+// Quadratic Bézier point for the factor t
+float bezier_point(float p0, float p1, float p2, float t);
+
+// Create a plan from interleaved x,y arrays of num_points entries.
+// A NULL control array makes every control point the midpoint, i.e. a linear morph, and the plan
+// is then evaluated with the cheaper straight-line kernel.
+MorphPlan* morph_plan_create(int num_points, const float* source_xy, const float* control_xy,
+                             const float* target_xy);
+
+// Create the circle-to-triangle plan: num_points samples of the circle, point i heading
+// to triangle vertex i % 3 through the matching control point around the circle
+MorphPlan* morph_plan_circle_to_triangle(float cx, float cy, float r, float triangle[3][2], int num_points);
+
+// Same as morph_plan_create / morph_plan_circle_to_triangle, with the plan carved out of an arena
+// (the heap when arena is NULL). An arena plan is released with its arena
+MorphPlan* morph_plan_create_in(Arena* arena, int num_points, const float* source_xy, const float* control_xy,
+                                const float* target_xy);
+MorphPlan* morph_plan_circle_to_triangle_in(Arena* arena, float cx, float cy, float r, float triangle[3][2],
+                                            int num_points);
+
+// Release a plan (nothing to do for an arena plan)
+void morph_plan_destroy(MorphPlan* plan);
+
+// Compute the points of the shape at factor t into out_x / out_y
+void morph_plan_evaluate(const MorphPlan* plan, float t, float* out_x, float* out_y);
+
+// Same into a polygon of the plan's size, a whole vector at a time (padding included)
+void morph_plan_evaluate_polygon(const MorphPlan* plan, float t, Polygon* out);
+
+// Choose the frames of an adaptive animation among count candidates with factors frame_times:
+// the first and last candidates, and every candidate where some vertex has moved more than
+// tolerance (in SVG units) since the previously chosen one. Writes the chosen candidate indices
+// in increasing order into selected (room for count) and returns how many, or -1 on failure
+int morph_plan_select_frames(const MorphPlan* plan, const float* frame_times, int count, float tolerance,
+                             int* selected);
+
+// Same frame selection for a keyframe timeline
+int morph_timeline_select_frames(const MorphTimeline* timeline, const float* frame_times, int count,
+                                 float tolerance, int* selected);
+
+// Resample a closed outline of count interleaved x,y points to num_points points, keeping the order:
+// every vertex stays and the added points are spread along the edges by length
+void morph_outline_resample(const float* xy, int count, int num_points, float* out);
+
+// Sample a circle evenly as num_points interleaved x,y points, starting at angle 0
+void morph_outline_circle(float cx, float cy, float r, int num_points, float* out);
+
+// Create a timeline through num_keys keyframes of num_points interleaved x,y points each.
+// key_times (increasing, any unit) places the keyframes; NULL spaces them evenly
+MorphTimeline* morph_timeline_create(int num_keys, int num_points, const float* const* keys_xy,
+                                     const float* key_times);
+
+// Same as morph_timeline_create, with the timeline carved out of an arena (the heap when arena is NULL)
+MorphTimeline* morph_timeline_create_in(Arena* arena, int num_keys, int num_points, const float* const* keys_xy,
+                                        const float* key_times);
+
+// Release a timeline (nothing to do for an arena timeline)
+void morph_timeline_destroy(MorphTimeline* timeline);
+
+// Find the segment (keyframe k to k + 1) holding timeline factor t, and the factor s inside it
+void morph_timeline_locate(const MorphTimeline* timeline, float t, int* segment, float* s);
+
+// Compute the points of the shape at timeline factor t into out_x / out_y
+void morph_timeline_evaluate(const MorphTimeline* timeline, float t, float* out_x, float* out_y);
+
+// Same into a polygon of the timeline's size, a whole vector at a time (padding included)
+void morph_timeline_evaluate_polygon(const MorphTimeline* timeline, float t, Polygon* out);
+
+// Allocate an engine-owned, 64-byte aligned buffer for count frames of num_points points
+float* morph_frames_alloc(int count, int num_points);
+
+// Release a buffer from morph_frames_alloc
+void morph_frames_free(float* frames);
+
+// Compute frames [first_frame, first_frame + count) of a total_frames animation into
+// frames (count x num_points x 2 floats, interleaved x,y). Frames are computed in
+// parallel when built with OpenMP. Returns -1 unless the range lies within the animation
+int morph_plan_render(const MorphPlan* plan, int first_frame, int count, int total_frames, float* frames);
+
+#endif
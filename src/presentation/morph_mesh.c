@@ -0,0 +1,1361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "morph_mesh.h"
+
+#define FLIP_PASSES 8       // rounds of edge flips that try to unfold triangles
+#define FRAME_MARGIN 0.1    // gap between the points and the frame, as a share of their extent
+#define SWEEP_ANGLES 24     // directions tried for the strips, 7.5 degrees apart
+#define CAVITY_BAD 1        // triangle states while a point is inserted
+#define CAVITY_GOOD 2
+
+// Define the triangulation while points are inserted: triangle slots are recycled through a free
+// list, and three extra vertices (a triangle around everything) come after the real points
+typedef struct {
+    const double* x;
+    const double* y;
+    int* v;                 // 3 vertices per slot
+    int* n;                 // 3 neighbours per slot
+    unsigned char* alive;
+    unsigned char* state;
+    int count;              // slots in use or freed
+    int capacity;
+    int* free_slots;
+    int num_free;
+    int* bad;               // scratch lists of one insertion
+    int* touched;
+    int* edges;             // boundary edges of the cavity: a, c, outer triangle
+    int* start_of;          // new triangle whose cavity edge starts at a vertex
+    int* end_of;            // new triangle whose cavity edge ends at a vertex
+} MeshBuild;
+
+// Define a point sorted by position, ties broken by index
+typedef struct {
+    double x, y;
+    int index;
+} SortPoint;
+
+// Define a triangle edge sorted by its end vertices, to find the triangle across it
+typedef struct {
+    int low, high;
+    int slot;               // 3 * triangle + the vertex opposite the edge
+} HalfEdge;
+
+// Define the strips of the sweep, in coordinates turned so that the lines through the source points
+// run along x. The chains are the frame bottom (0), one curve per point from the bottom up in the
+// source (1 to num_curves), and the frame top. A curve is a flat line in the source; in the target it
+// stays at its home height except where it bends around the points of the curves on its other side.
+// Chain vertices keep the mesh numbering and are linked left to right
+typedef struct {
+    int num_points;
+    int num_curves;
+    double cos_a, sin_a;
+    double left, bottom, right, top;
+    int* curve_point;       // input point of every curve
+    int* curve_of;          // curve of every input point
+    int* column_point;      // input points left to right in the target
+    double* home;           // target height of every curve away from the bends
+    double* heights;        // target heights of the points, bottom to top
+    int* rank;              // place of every curve's point among those heights
+    int* slot;              // gap between the heights that every curve's home lies in
+    int* low;               // segment tree over the slots: smallest cost below a node
+    int* add;               // and the cost added to the whole node
+    double* block_sum;      // blocks of the isotonic regression of the slots
+    int* block_count;
+    SortPoint* sorted;
+    int num_vertices;
+    int capacity;
+    double* sx;             // source and target position of every vertex, turned
+    double* sy;
+    double* tx;
+    double* ty;
+    int* next;              // next vertex along its chain, -1 at the right end
+    int* head;              // left end of every chain
+    int* triangles;
+    int num_triangles;
+    int triangle_capacity;
+} Sweep;
+
+// Function to measure twice the signed area of a-b-c (positive when counter-clockwise)
+static double orient(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+// Function to test whether p lies inside the circumcircle of the counter-clockwise a-b-c
+static int in_circle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+{
+    double adx = ax - px, ady = ay - py, bdx = bx - px, bdy = by - py, cdx = cx - px, cdy = cy - py;
+    double a2 = adx * adx + ady * ady, b2 = bdx * bdx + bdy * bdy, c2 = cdx * cdx + cdy * cdy;
+    return adx * (bdy * c2 - b2 * cdy) - ady * (bdx * c2 - b2 * cdx) + a2 * (bdx * cdy - bdy * cdx) > 0.0;
+}
+
+// Function to compute the grid cell of a point, clamped to the grid
+static int grid_cell(const MorphMesh* mesh, double x, double y)
+{
+    int column = (int)((x - mesh->grid_x) / mesh->cell_size);
+    int row = (int)((y - mesh->grid_y) / mesh->cell_size);
+    column = column < 0 ? 0 : column >= mesh->columns ? mesh->columns - 1 : column;
+    row = row < 0 ? 0 : row >= mesh->rows ? mesh->rows - 1 : row;
+    return row * mesh->columns + column;
+}
+
+// Function to walk from triangle t towards (x, y), crossing any edge that has the point on its
+// far side, until a triangle holds it or the hull is reached. The first edge tried rotates, so the
+// walk cannot circle forever; max_steps bounds it anyway. Returns the last triangle, or -1 when
+// the step budget ran out
+static int walk(const int* v, const int* n, const double* vx, const double* vy, int t, double x, double y,
+                int max_steps)
+{
+    for (int step = 0; step < max_steps; step++) {
+        int next = -1;
+        for (int k = 0; k < 3; k++) {
+            int i = (k + step) % 3;
+            int a = v[3 * t + (i + 1) % 3], b = v[3 * t + (i + 2) % 3];
+            if (orient(vx[a], vy[a], vx[b], vy[b], x, y) < 0.0) {
+                next = n[3 * t + i];
+                break;
+            }
+        }
+        if (next < 0) {
+            return t;
+        }
+        t = next;
+    }
+    return -1;
+}
+
+// Function to take a triangle slot, growing the build arrays when none is free
+static int build_new_slot(MeshBuild* build)
+{
+    if (build->num_free > 0) {
+        return build->free_slots[--build->num_free];
+    }
+    if (build->count == build->capacity) {
+        int capacity = build->capacity * 2;
+        int* v = (int*) realloc(build->v, (size_t)capacity * 3 * sizeof(int));
+        if (v) {
+            build->v = v;
+        }
+        int* n = (int*) realloc(build->n, (size_t)capacity * 3 * sizeof(int));
+        if (n) {
+            build->n = n;
+        }
+        unsigned char* alive = (unsigned char*) realloc(build->alive, capacity);
+        if (alive) {
+            build->alive = alive;
+        }
+        unsigned char* state = (unsigned char*) realloc(build->state, capacity);
+        if (state) {
+            build->state = state;
+        }
+        int* lists[4] = { build->free_slots, build->bad, build->touched, NULL };
+        for (int l = 0; l < 3; l++) {
+            lists[l] = (int*) realloc(lists[l], (size_t)capacity * sizeof(int));
+        }
+        build->free_slots = lists[0] ? lists[0] : build->free_slots;
+        build->bad = lists[1] ? lists[1] : build->bad;
+        build->touched = lists[2] ? lists[2] : build->touched;
+        int* edges = (int*) realloc(build->edges, (size_t)capacity * 3 * sizeof(int));
+        if (edges) {
+            build->edges = edges;
+        }
+        if (!v || !n || !alive || !state || !lists[0] || !lists[1] || !lists[2] || !edges) {
+            return -1;
+        }
+        build->capacity = capacity;
+    }
+    return build->count++;
+}
+
+// Function to point the neighbour entry of triangle t that faces the edge a-c at triangle value
+static void set_neighbour(int* v, int* n, int t, int a, int c, int value)
+{
+    for (int j = 0; j < 3; j++) {
+        if (v[3 * t + j] != a && v[3 * t + j] != c) {
+            n[3 * t + j] = value;
+            return;
+        }
+    }
+}
+
+// Function to insert vertex p (Bowyer-Watson): every triangle whose circumcircle holds p is
+// removed and the hole is filled with a fan around p. Returns the new triangle nearest p's cell,
+// -2 when p repeats an existing vertex, or -1 on failure
+static int build_insert(MeshBuild* build, int p, int start)
+{
+    double px = build->x[p], py = build->y[p];
+    int t = walk(build->v, build->n, build->x, build->y, start, px, py, 4 * build->count + 16);
+    for (int s = 0; t < 0 && s < build->count; s++) {
+        // The walk gave up (rounding on nearly flat triangles); search every live triangle
+        int* v = build->v + 3 * s;
+        if (build->alive[s] && orient(build->x[v[0]], build->y[v[0]], build->x[v[1]], build->y[v[1]], px, py) >= 0 &&
+            orient(build->x[v[1]], build->y[v[1]], build->x[v[2]], build->y[v[2]], px, py) >= 0 &&
+            orient(build->x[v[2]], build->y[v[2]], build->x[v[0]], build->y[v[0]], px, py) >= 0) {
+            t = s;
+        }
+    }
+    if (t < 0) {
+        return -1;
+    }
+    for (int j = 0; j < 3; j++) {
+        int q = build->v[3 * t + j];
+        if (build->x[q] == px && build->y[q] == py) {
+            return -2;
+        }
+    }
+
+    // Grow the cavity from the triangle that holds p across every edge whose far side also sees p;
+    // a neighbour is tested once, so the edges to the good ones are exactly the cavity boundary
+    int num_bad = 0, num_touched = 0, num_edges = 0;
+    build->bad[num_bad++] = t;
+    build->state[t] = CAVITY_BAD;
+    for (int b = 0; b < num_bad; b++) {
+        int* v = build->v + 3 * build->bad[b];
+        int* n = build->n + 3 * build->bad[b];
+        for (int i = 0; i < 3; i++) {
+            int u = n[i];
+            if (u >= 0 && build->state[u] == 0) {
+                int* w = build->v + 3 * u;
+                if (in_circle(build->x[w[0]], build->y[w[0]], build->x[w[1]], build->y[w[1]],
+                              build->x[w[2]], build->y[w[2]], px, py)) {
+                    build->state[u] = CAVITY_BAD;
+                    build->bad[num_bad++] = u;
+                } else {
+                    build->state[u] = CAVITY_GOOD;
+                    build->touched[num_touched++] = u;
+                }
+            }
+            if (u < 0 || build->state[u] != CAVITY_BAD) {
+                int* edge = build->edges + 3 * num_edges++;
+                edge[0] = v[(i + 1) % 3];
+                edge[1] = v[(i + 2) % 3];
+                edge[2] = u;
+            }
+        }
+    }
+    for (int k = 0; k < num_touched; k++) {
+        build->state[build->touched[k]] = 0;
+    }
+    for (int b = 0; b < num_bad; b++) {
+        build->state[build->bad[b]] = 0;
+        build->alive[build->bad[b]] = 0;
+        build->free_slots[build->num_free++] = build->bad[b];
+    }
+
+    // Fan the boundary edges a-c around p; the fan neighbours are joined once all exist
+    int created = -1;
+    for (int e = 0; e < num_edges; e++) {
+        int a = build->edges[3 * e], c = build->edges[3 * e + 1], outer = build->edges[3 * e + 2];
+        int slot = build_new_slot(build);
+        if (slot < 0) {
+            return -1;
+        }
+        build->v[3 * slot] = p;
+        build->v[3 * slot + 1] = a;
+        build->v[3 * slot + 2] = c;
+        build->n[3 * slot] = outer;
+        build->alive[slot] = 1;
+        build->state[slot] = 0;
+        if (outer >= 0) {
+            set_neighbour(build->v, build->n, outer, a, c, slot);
+        }
+        build->start_of[a] = slot;
+        build->end_of[c] = slot;
+        created = slot;
+    }
+    for (int e = 0; e < num_edges; e++) {
+        int slot = build->start_of[build->edges[3 * e]];
+        build->n[3 * slot + 1] = build->start_of[build->v[3 * slot + 2]];  // across c-p
+        build->n[3 * slot + 2] = build->end_of[build->v[3 * slot + 1]];    // across p-a
+    }
+    return created;
+}
+
+// Function to lay the point location grid over the source bounds, about one vertex per cell
+static void grid_setup(MorphMesh* mesh)
+{
+    double min_x = mesh->source_xy[0], max_x = min_x, min_y = mesh->source_xy[1], max_y = min_y;
+    for (int i = 1; i < mesh->num_vertices; i++) {
+        double x = mesh->source_xy[2 * i], y = mesh->source_xy[2 * i + 1];
+        min_x = x < min_x ? x : min_x;
+        max_x = x > max_x ? x : max_x;
+        min_y = y < min_y ? y : min_y;
+        max_y = y > max_y ? y : max_y;
+    }
+    float width = (float)(max_x - min_x), height = (float)(max_y - min_y);
+    float cell = sqrtf(width * height / mesh->num_vertices);
+    if (!(cell > 0.0f)) {
+        cell = fmaxf(width, height) / mesh->num_vertices;  // Points on one line
+    }
+    if (!(cell > 0.0f)) {
+        cell = 1.0f;  // A single spot
+    }
+    mesh->grid_x = (float)min_x;
+    mesh->grid_y = (float)min_y;
+    mesh->cell_size = cell;
+    mesh->columns = (int)(width / cell) + 1;
+    mesh->rows = (int)(height / cell) + 1;
+}
+
+// Function to order the vertices cell by cell, rows alternating direction, so that each one is
+// inserted next to the previous one (a counting sort, linear in the number of vertices)
+static int* grid_order(const MorphMesh* mesh)
+{
+    int num_cells = mesh->columns * mesh->rows;
+    int* first = (int*) calloc(num_cells + 1, sizeof(int));
+    int* order = (int*) malloc(mesh->num_vertices * sizeof(int));
+    int* rank = (int*) malloc(mesh->num_vertices * sizeof(int));
+    if (!first || !order || !rank) {
+        free(first);
+        free(order);
+        free(rank);
+        return NULL;
+    }
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        int cell = grid_cell(mesh, mesh->source_xy[2 * i], mesh->source_xy[2 * i + 1]);
+        int row = cell / mesh->columns, column = cell % mesh->columns;
+        rank[i] = row * mesh->columns + ((row & 1) ? mesh->columns - 1 - column : column);
+        first[rank[i] + 1]++;
+    }
+    for (int c = 0; c < num_cells; c++) {
+        first[c + 1] += first[c];
+    }
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        order[first[rank[i]]++] = i;
+    }
+    free(first);
+    free(rank);
+    return order;
+}
+
+// Function to point every grid cell at the triangle whose centroid lies in it, or else at the
+// last such triangle before it in scan order
+static void grid_index_triangles(MorphMesh* mesh)
+{
+    int num_cells = mesh->columns * mesh->rows;
+    for (int c = 0; c < num_cells; c++) {
+        mesh->cell_triangle[c] = -1;
+    }
+    for (int t = 0; t < mesh->num_triangles; t++) {
+        double x = 0.0, y = 0.0;
+        for (int j = 0; j < 3; j++) {
+            x += mesh->source_xy[2 * mesh->triangles[3 * t + j]] / 3.0;
+            y += mesh->source_xy[2 * mesh->triangles[3 * t + j] + 1] / 3.0;
+        }
+        mesh->cell_triangle[grid_cell(mesh, x, y)] = t;
+    }
+    int last = mesh->num_triangles > 0 ? 0 : -1;
+    for (int c = 0; c < num_cells; c++) {
+        if (mesh->cell_triangle[c] < 0) {
+            mesh->cell_triangle[c] = last;
+        }
+        last = mesh->cell_triangle[c];
+    }
+}
+
+// Function to test whether a triangle is inside out (or flat) in the source or in the target
+static int folds(const MorphMesh* mesh, const int* v)
+{
+    const double* s = mesh->source_xy;
+    const double* d = mesh->target_xy;
+    return orient(s[2 * v[0]], s[2 * v[0] + 1], s[2 * v[1]], s[2 * v[1] + 1], s[2 * v[2]], s[2 * v[2] + 1]) <= 0.0 ||
+           orient(d[2 * v[0]], d[2 * v[0] + 1], d[2 * v[1]], d[2 * v[1] + 1], d[2 * v[2]], d[2 * v[2] + 1]) <= 0.0;
+}
+
+// Function to flip edges of triangles that fold over on the way to the target: t = (c, a, b) and its
+// neighbour u = (d, b, a) across a-b become (c, a, d) and (c, d, b) when that stays a valid
+// triangulation of the source and leaves fewer of the two folded. Returns how many still fold
+static int unfold_triangles(MorphMesh* mesh)
+{
+    const double* s = mesh->source_xy;
+    int* v = mesh->triangles;
+    int* n = mesh->neighbours;
+    for (int pass = 0; pass < FLIP_PASSES; pass++) {
+        int flips = 0;
+        for (int t = 0; t < mesh->num_triangles; t++) {
+            for (int i = 0; i < 3 && folds(mesh, v + 3 * t); i++) {
+                int u = n[3 * t + i];
+                if (u < 0) {
+                    continue;
+                }
+                int c = v[3 * t + i], a = v[3 * t + (i + 1) % 3], b = v[3 * t + (i + 2) % 3];
+                int j = 0;
+                while (v[3 * u + j] == a || v[3 * u + j] == b) {
+                    j++;
+                }
+                int d = v[3 * u + j];
+                if (orient(s[2 * c], s[2 * c + 1], s[2 * a], s[2 * a + 1], s[2 * d], s[2 * d + 1]) <= 0.0 ||
+                    orient(s[2 * c], s[2 * c + 1], s[2 * d], s[2 * d + 1], s[2 * b], s[2 * b + 1]) <= 0.0) {
+                    continue;  // The quad is not convex in the source
+                }
+                int before = folds(mesh, v + 3 * u) + 1;
+                int first[3] = { c, a, d }, second[3] = { c, d, b };
+                int after = folds(mesh, first) + folds(mesh, second);
+                if (after >= before) {
+                    continue;
+                }
+                int across_ca = n[3 * t + (i + 2) % 3], across_bc = n[3 * t + (i + 1) % 3];
+                int across_ad = n[3 * u + (j + 1) % 3], across_db = n[3 * u + (j + 2) % 3];
+                memcpy(v + 3 * t, first, sizeof(first));
+                memcpy(v + 3 * u, second, sizeof(second));
+                n[3 * t] = across_ad;
+                n[3 * t + 1] = u;
+                n[3 * t + 2] = across_ca;
+                n[3 * u] = across_db;
+                n[3 * u + 1] = across_bc;
+                n[3 * u + 2] = t;
+                if (across_ad >= 0) {
+                    set_neighbour(v, n, across_ad, a, d, t);
+                }
+                if (across_bc >= 0) {
+                    set_neighbour(v, n, across_bc, b, c, u);
+                }
+                flips++;
+                break;
+            }
+        }
+        if (flips == 0) {
+            break;
+        }
+    }
+    int folded = 0;
+    for (int t = 0; t < mesh->num_triangles; t++) {
+        folded += folds(mesh, v + 3 * t);
+    }
+    return folded;
+}
+
+// Function to release the build state
+static void build_free(MeshBuild* build)
+{
+    free((void*)build->x);
+    free((void*)build->y);
+    free(build->v);
+    free(build->n);
+    free(build->alive);
+    free(build->state);
+    free(build->free_slots);
+    free(build->bad);
+    free(build->touched);
+    free(build->edges);
+    free(build->start_of);
+    free(build->end_of);
+}
+
+// Function to triangulate the source vertices, leaving out the duplicate points; a point found to
+// repeat a vertex while it is inserted is flagged as a duplicate too
+static int triangulate(MorphMesh* mesh, const int* order, unsigned char* duplicate)
+{
+    int num_real = mesh->num_vertices;
+    const double* source_xy = mesh->source_xy;
+
+    // A Delaunay triangulation has at most 2 * points triangles; the slots grow if rounding needs more
+    MeshBuild build;
+    memset(&build, 0, sizeof(MeshBuild));
+    int num_vertices = num_real + 3;
+    build.capacity = 2 * num_vertices + 16;
+    double* vx = (double*) malloc(num_vertices * sizeof(double));
+    double* vy = (double*) malloc(num_vertices * sizeof(double));
+    build.x = vx;
+    build.y = vy;
+    build.v = (int*) malloc((size_t)build.capacity * 3 * sizeof(int));
+    build.n = (int*) malloc((size_t)build.capacity * 3 * sizeof(int));
+    build.alive = (unsigned char*) calloc(build.capacity, 1);
+    build.state = (unsigned char*) calloc(build.capacity, 1);
+    build.free_slots = (int*) malloc(build.capacity * sizeof(int));
+    build.bad = (int*) malloc(build.capacity * sizeof(int));
+    build.touched = (int*) malloc(build.capacity * sizeof(int));
+    build.edges = (int*) malloc((size_t)build.capacity * 3 * sizeof(int));
+    build.start_of = (int*) malloc(num_vertices * sizeof(int));
+    build.end_of = (int*) malloc(num_vertices * sizeof(int));
+    int status = (vx && vy && build.v && build.n && build.alive && build.state && build.free_slots && build.bad &&
+                  build.touched && build.edges && build.start_of && build.end_of)
+                 ? 0 : -1;
+
+    if (status == 0) {
+        // The first triangle holds every point with a wide margin
+        for (int i = 0; i < num_real; i++) {
+            vx[i] = source_xy[2 * i];
+            vy[i] = source_xy[2 * i + 1];
+        }
+        double size = fmax(mesh->columns, mesh->rows) * (double)mesh->cell_size;
+        double mid_x = mesh->grid_x + mesh->columns * (double)mesh->cell_size / 2;
+        double mid_y = mesh->grid_y + mesh->rows * (double)mesh->cell_size / 2;
+        vx[num_real] = mid_x - 20 * size;
+        vy[num_real] = mid_y - 20 * size;
+        vx[num_real + 1] = mid_x + 20 * size;
+        vy[num_real + 1] = mid_y - 20 * size;
+        vx[num_real + 2] = mid_x;
+        vy[num_real + 2] = mid_y + 20 * size;
+        for (int j = 0; j < 3; j++) {
+            build.v[j] = num_real + j;
+            build.n[j] = -1;
+        }
+        build.alive[0] = 1;
+        build.count = 1;
+        for (int c = 0; c < mesh->columns * mesh->rows; c++) {
+            mesh->cell_triangle[c] = -1;
+        }
+    }
+
+    // Insert the points cell by cell, each walk starting from the last triangle made in its cell
+    int last = 0;
+    for (int k = 0; k < num_real && status == 0; k++) {
+        int p = order[k];
+        if (p < mesh->num_points && duplicate[p]) {
+            continue;
+        }
+        int cell = grid_cell(mesh, vx[p], vy[p]);
+        int start = mesh->cell_triangle[cell];
+        if (start < 0 || !build.alive[start]) {
+            start = last;
+        }
+        int created = build_insert(&build, p, start);
+        if (created == -2) {
+            duplicate[p] = 1;
+            mesh->num_duplicates++;
+        } else if (created < 0) {
+            printf("Error: Could not insert point %d into the mesh\n", p);
+            status = -1;
+        } else {
+            mesh->cell_triangle[cell] = last = created;
+        }
+    }
+
+    // Keep the triangles between mesh vertices, renumbered, with neighbours outside them cut off
+    int* index = (status == 0) ? (int*) malloc(build.count * sizeof(int)) : NULL;
+    if (index) {
+        for (int t = 0; t < build.count; t++) {
+            int* v = build.v + 3 * t;
+            index[t] = (build.alive[t] && v[0] < num_real && v[1] < num_real && v[2] < num_real)
+                       ? mesh->num_triangles++ : -1;
+        }
+        mesh->triangles = (int*) malloc((size_t)(mesh->num_triangles + 1) * 3 * sizeof(int));
+        mesh->neighbours = (int*) malloc((size_t)(mesh->num_triangles + 1) * 3 * sizeof(int));
+        if (!mesh->triangles || !mesh->neighbours) {
+            status = -1;
+        }
+        for (int t = 0; t < build.count && status == 0; t++) {
+            if (index[t] >= 0) {
+                for (int j = 0; j < 3; j++) {
+                    int u = build.n[3 * t + j];
+                    mesh->triangles[3 * index[t] + j] = build.v[3 * t + j];
+                    mesh->neighbours[3 * index[t] + j] = u >= 0 ? index[u] : -1;
+                }
+            }
+        }
+    } else {
+        status = -1;
+    }
+    free(index);
+    build_free(&build);
+    return status;
+}
+
+
+// Comparison function for qsort on positions
+static int compare_points(const void* a, const void* b)
+{
+    const SortPoint* p = (const SortPoint*)a;
+    const SortPoint* q = (const SortPoint*)b;
+    if (p->x != q->x) {
+        return p->x < q->x ? -1 : 1;
+    }
+    if (p->y != q->y) {
+        return p->y < q->y ? -1 : 1;
+    }
+    return p->index - q->index;
+}
+
+// Comparison function for qsort on edges
+static int compare_edges(const void* a, const void* b)
+{
+    const HalfEdge* e = (const HalfEdge*)a;
+    const HalfEdge* f = (const HalfEdge*)b;
+    if (e->low != f->low) {
+        return e->low < f->low ? -1 : 1;
+    }
+    return e->high != f->high ? (e->high < f->high ? -1 : 1) : e->slot - f->slot;
+}
+
+// Function to flag every input point whose position in xy repeats an earlier point's
+static void mark_duplicates(const double* xy, int num_points, unsigned char* duplicate, SortPoint* sorted)
+{
+    for (int i = 0; i < num_points; i++) {
+        sorted[i].x = xy[2 * i];
+        sorted[i].y = xy[2 * i + 1];
+        sorted[i].index = i;
+    }
+    qsort(sorted, num_points, sizeof(SortPoint), compare_points);
+    for (int i = 1; i < num_points; i++) {
+        if (sorted[i].x == sorted[i - 1].x && sorted[i].y == sorted[i - 1].y) {
+            duplicate[sorted[i].index] = 1;
+        }
+    }
+}
+
+// Function to put the 4 frame corners after the input points: the bounds of the source and the
+// target with a margin, at the same place in both, counter-clockwise from the bottom left
+static void set_frame(MorphMesh* mesh)
+{
+    double min_x = mesh->source_xy[0], max_x = min_x, min_y = mesh->source_xy[1], max_y = min_y;
+    for (int i = 0; i < 2 * mesh->num_points; i++) {
+        const double* xy = (i < mesh->num_points) ? mesh->source_xy + 2 * i
+                                                 : mesh->target_xy + 2 * (i - mesh->num_points);
+        min_x = xy[0] < min_x ? xy[0] : min_x;
+        max_x = xy[0] > max_x ? xy[0] : max_x;
+        min_y = xy[1] < min_y ? xy[1] : min_y;
+        max_y = xy[1] > max_y ? xy[1] : max_y;
+    }
+    double margin = FRAME_MARGIN * fmax(max_x - min_x, max_y - min_y);
+    if (!(margin > 0.0)) {
+        margin = 1.0;
+    }
+    double corners[8] = { min_x - margin, min_y - margin, max_x + margin, min_y - margin,
+                         max_x + margin, max_y + margin, min_x - margin, max_y + margin };
+    memcpy(mesh->source_xy + 2 * mesh->num_points, corners, sizeof(corners));
+    memcpy(mesh->target_xy + 2 * mesh->num_points, corners, sizeof(corners));
+}
+
+// Function to test whether the mesh ends at the frame: every edge without a triangle across it
+// joins two frame corners
+static int on_frame(const MorphMesh* mesh)
+{
+    for (int t = 0; t < mesh->num_triangles; t++) {
+        for (int i = 0; i < 3; i++) {
+            if (mesh->neighbours[3 * t + i] < 0 && (mesh->triangles[3 * t + (i + 1) % 3] < mesh->num_points ||
+                                                    mesh->triangles[3 * t + (i + 2) % 3] < mesh->num_points)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Function to join every triangle to those across its edges, by sorting the edges
+static int link_neighbours(MorphMesh* mesh)
+{
+    int num_edges = 3 * mesh->num_triangles;
+    HalfEdge* edges = (HalfEdge*) malloc((size_t)num_edges * sizeof(HalfEdge));
+    if (edges == NULL) {
+        return -1;
+    }
+    for (int e = 0; e < num_edges; e++) {
+        int a = mesh->triangles[e - e % 3 + (e + 1) % 3], b = mesh->triangles[e - e % 3 + (e + 2) % 3];
+        edges[e].low = a < b ? a : b;
+        edges[e].high = a < b ? b : a;
+        edges[e].slot = e;
+        mesh->neighbours[e] = -1;
+    }
+    qsort(edges, num_edges, sizeof(HalfEdge), compare_edges);
+    for (int e = 0; e + 1 < num_edges; e++) {
+        if (edges[e].low == edges[e + 1].low && edges[e].high == edges[e + 1].high) {
+            mesh->neighbours[edges[e].slot] = edges[e + 1].slot / 3;
+            mesh->neighbours[edges[e + 1].slot] = edges[e].slot / 3;
+            e++;
+        }
+    }
+    free(edges);
+    return 0;
+}
+
+// Function to add a cost to the slots from..to of the segment tree node that covers lo..hi
+static void slot_add(Sweep* sweep, int node, int lo, int hi, int from, int to, int value)
+{
+    if (to < lo || hi < from) {
+        return;
+    }
+    if (from <= lo && hi <= to) {
+        sweep->add[node] += value;
+        sweep->low[node] += value;
+        return;
+    }
+    int mid = (lo + hi) / 2;
+    slot_add(sweep, 2 * node, lo, mid, from, to, value);
+    slot_add(sweep, 2 * node + 1, mid + 1, hi, from, to, value);
+    int least = sweep->low[2 * node] < sweep->low[2 * node + 1] ? sweep->low[2 * node] : sweep->low[2 * node + 1];
+    sweep->low[node] = sweep->add[node] + least;
+}
+
+// Function to find the first slot of the smallest cost
+static int slot_best(const Sweep* sweep)
+{
+    int node = 1, lo = 0, hi = sweep->num_curves;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sweep->low[2 * node] <= sweep->low[2 * node + 1]) {
+            node = 2 * node;
+            hi = mid;
+        } else {
+            node = 2 * node + 1;
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+// Function to release the sweep state
+static void sweep_free(Sweep* sweep)
+{
+    free(sweep->curve_point);
+    free(sweep->curve_of);
+    free(sweep->column_point);
+    free(sweep->home);
+    free(sweep->heights);
+    free(sweep->rank);
+    free(sweep->slot);
+    free(sweep->low);
+    free(sweep->add);
+    free(sweep->block_sum);
+    free(sweep->block_count);
+    free(sweep->sorted);
+    free(sweep->sx);
+    free(sweep->sy);
+    free(sweep->tx);
+    free(sweep->ty);
+    free(sweep->next);
+    free(sweep->head);
+    free(sweep->triangles);
+}
+
+// Function to allocate the sweep state for num_curves of the num_points input points
+static int sweep_open(Sweep* sweep, int num_points, int num_curves)
+{
+    memset(sweep, 0, sizeof(Sweep));
+    sweep->num_points = num_points;
+    sweep->num_curves = num_curves;
+    sweep->capacity = 2 * (num_points + 4);
+    sweep->triangle_capacity = 4 * (num_points + 4);
+    sweep->curve_point = (int*) malloc(num_curves * sizeof(int));
+    sweep->curve_of = (int*) malloc(num_points * sizeof(int));
+    sweep->column_point = (int*) malloc(num_curves * sizeof(int));
+    sweep->home = (double*) malloc(num_curves * sizeof(double));
+    sweep->heights = (double*) malloc(num_curves * sizeof(double));
+    sweep->rank = (int*) malloc(num_curves * sizeof(int));
+    sweep->slot = (int*) malloc(num_curves * sizeof(int));
+    sweep->low = (int*) malloc(4 * (num_curves + 1) * sizeof(int));
+    sweep->add = (int*) malloc(4 * (num_curves + 1) * sizeof(int));
+    sweep->block_sum = (double*) malloc(num_curves * sizeof(double));
+    sweep->block_count = (int*) malloc(num_curves * sizeof(int));
+    sweep->sorted = (SortPoint*) malloc(num_points * sizeof(SortPoint));
+    sweep->sx = (double*) malloc(sweep->capacity * sizeof(double));
+    sweep->sy = (double*) malloc(sweep->capacity * sizeof(double));
+    sweep->tx = (double*) malloc(sweep->capacity * sizeof(double));
+    sweep->ty = (double*) malloc(sweep->capacity * sizeof(double));
+    sweep->next = (int*) malloc(sweep->capacity * sizeof(int));
+    sweep->head = (int*) malloc((num_curves + 2) * sizeof(int));
+    sweep->triangles = (int*) malloc((size_t)sweep->triangle_capacity * 3 * sizeof(int));
+    if (!sweep->curve_point || !sweep->curve_of || !sweep->column_point || !sweep->home || !sweep->heights ||
+        !sweep->rank || !sweep->slot || !sweep->low || !sweep->add || !sweep->block_sum || !sweep->block_count ||
+        !sweep->sorted || !sweep->sx || !sweep->sy || !sweep->tx || !sweep->ty || !sweep->next || !sweep->head ||
+        !sweep->triangles) {
+        sweep_free(sweep);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to find the curves that bend around the point of column c (1 to num_curves): those on
+// the other side of the point's target height than their own side of its curve. They go evenly
+// between *lo and *hi; returns how many there are, the lowest in *first
+static int sweep_bent(const Sweep* sweep, int c, int* first, double* lo, double* hi)
+{
+    int p = sweep->column_point[c - 1], own = sweep->curve_of[p];
+    double y = sweep->ty[p];
+    int above = 0, end = sweep->num_curves;  // first curve with a home above the point
+    while (above < end) {
+        int mid = (above + end) / 2;
+        if (sweep->home[mid] > y) {
+            end = mid;
+        } else {
+            above = mid + 1;
+        }
+    }
+    if (above < own) {
+        *first = above;
+        *lo = above > 0 ? sweep->home[above - 1] : sweep->bottom;
+        *hi = y;
+        return own - above;
+    }
+    if (above > own + 1) {
+        *first = own + 1;
+        *lo = y;
+        *hi = above < sweep->num_curves ? sweep->home[above] : sweep->top;
+        return above - 1 - own;
+    }
+    return 0;
+}
+
+// Function to set up the sweep along a direction: turn the points, order the curves and the
+// columns, and choose the homes so that few curves have to bend (for every curve the slot between
+// the target heights that the fewest points of other curves are on the wrong side of, made
+// non-decreasing by isotonic regression). Returns how many bends that takes, or -1 when two points
+// line up along the direction
+static long long sweep_setup(Sweep* sweep, const MorphMesh* mesh, const unsigned char* duplicate, double angle)
+{
+    int m = sweep->num_curves;
+    sweep->cos_a = cos(angle);
+    sweep->sin_a = sin(angle);
+    int k = 0;
+    for (int i = 0; i < sweep->num_points; i++) {
+        const double* s = mesh->source_xy + 2 * i;
+        const double* d = mesh->target_xy + 2 * i;
+        sweep->sx[i] = s[0] * sweep->cos_a + s[1] * sweep->sin_a;
+        sweep->sy[i] = -s[0] * sweep->sin_a + s[1] * sweep->cos_a;
+        sweep->tx[i] = d[0] * sweep->cos_a + d[1] * sweep->sin_a;
+        sweep->ty[i] = -d[0] * sweep->sin_a + d[1] * sweep->cos_a;
+        sweep->next[i] = -1;
+        if (!duplicate[i]) {
+            if (k == 0) {
+                sweep->left = sweep->right = sweep->sx[i];
+                sweep->bottom = sweep->top = sweep->sy[i];
+            }
+            sweep->left = fmin(sweep->left, fmin(sweep->sx[i], sweep->tx[i]));
+            sweep->right = fmax(sweep->right, fmax(sweep->sx[i], sweep->tx[i]));
+            sweep->bottom = fmin(sweep->bottom, fmin(sweep->sy[i], sweep->ty[i]));
+            sweep->top = fmax(sweep->top, fmax(sweep->sy[i], sweep->ty[i]));
+            sweep->sorted[k].x = sweep->sy[i];
+            sweep->sorted[k].y = 0.0;
+            sweep->sorted[k++].index = i;
+        }
+    }
+    double margin = FRAME_MARGIN * fmax(sweep->right - sweep->left, sweep->top - sweep->bottom);
+    margin = margin > 0.0 ? margin : 1.0;
+    sweep->left -= margin;
+    sweep->right += margin;
+    sweep->bottom -= margin;
+    sweep->top += margin;
+
+    // Curves from the bottom up in the source, columns from left to right in the target
+    qsort(sweep->sorted, m, sizeof(SortPoint), compare_points);
+    for (int j = 0; j < m; j++) {
+        if (j > 0 && sweep->sorted[j].x == sweep->sorted[j - 1].x) {
+            return -1;
+        }
+        sweep->curve_point[j] = sweep->sorted[j].index;
+        sweep->curve_of[sweep->sorted[j].index] = j;
+        sweep->sorted[j].x = sweep->tx[sweep->sorted[j].index];
+    }
+    qsort(sweep->sorted, m, sizeof(SortPoint), compare_points);
+    for (int c = 0; c < m; c++) {
+        if (c > 0 && sweep->sorted[c].x == sweep->sorted[c - 1].x) {
+            return -1;
+        }
+        sweep->column_point[c] = sweep->sorted[c].index;
+    }
+    for (int j = 0; j < m; j++) {
+        sweep->sorted[j].x = sweep->ty[sweep->curve_point[j]];
+        sweep->sorted[j].index = j;
+    }
+    qsort(sweep->sorted, m, sizeof(SortPoint), compare_points);
+    for (int r = 0; r < m; r++) {
+        if (r > 0 && sweep->sorted[r].x == sweep->sorted[r - 1].x) {
+            return -1;
+        }
+        sweep->heights[r] = sweep->sorted[r].x;
+        sweep->rank[sweep->sorted[r].index] = r;
+    }
+
+    // Slot s (0 to m) is the gap just below heights[s]. Curve j costs one bend for every point of a
+    // curve above it whose height is below the slot, and of a curve below it whose height is above
+    memset(sweep->low, 0, 4 * (m + 1) * sizeof(int));
+    memset(sweep->add, 0, 4 * (m + 1) * sizeof(int));
+    for (int j = 1; j < m; j++) {
+        slot_add(sweep, 1, 0, m, sweep->rank[j] + 1, m, 1);
+    }
+    for (int j = 0; j < m; j++) {
+        if (j > 0) {
+            slot_add(sweep, 1, 0, m, sweep->rank[j] + 1, m, -1);
+            slot_add(sweep, 1, 0, m, 0, sweep->rank[j - 1], 1);
+        }
+        sweep->slot[j] = slot_best(sweep);
+    }
+    int num_blocks = 0;
+    for (int j = 0; j < m; j++) {
+        sweep->block_sum[num_blocks] = sweep->slot[j];
+        sweep->block_count[num_blocks++] = 1;
+        while (num_blocks > 1 && sweep->block_sum[num_blocks - 2] * sweep->block_count[num_blocks - 1] >
+                                 sweep->block_sum[num_blocks - 1] * sweep->block_count[num_blocks - 2]) {
+            sweep->block_sum[num_blocks - 2] += sweep->block_sum[num_blocks - 1];
+            sweep->block_count[num_blocks - 2] += sweep->block_count[num_blocks - 1];
+            num_blocks--;
+        }
+    }
+    for (int b = 0, j = 0; b < num_blocks; b++) {
+        int s = (int)floor(sweep->block_sum[b] / sweep->block_count[b] + 0.5);
+        for (int q = 0; q < sweep->block_count[b]; q++) {
+            sweep->slot[j++] = s;
+        }
+    }
+
+    // Curves that share a slot are spread evenly over its gap
+    for (int j = 0; j < m;) {
+        int s = sweep->slot[j], count = 1;
+        while (j + count < m && sweep->slot[j + count] == s) {
+            count++;
+        }
+        double lo = s == 0 ? sweep->bottom : sweep->heights[s - 1];
+        double hi = s == m ? sweep->top : sweep->heights[s];
+        if (!(hi > lo)) {
+            return -1;
+        }
+        for (int q = 0; q < count; q++) {
+            sweep->home[j + q] = lo + (hi - lo) * (q + 1) / (count + 1);
+        }
+        j += count;
+    }
+    long long bends = 0;
+    for (int c = 1; c <= m; c++) {
+        int first;
+        double lo, hi;
+        bends += sweep_bent(sweep, c, &first, &lo, &hi);
+    }
+    return bends;
+}
+
+// Function to add a Steiner vertex at turned source and target positions; returns its index, or -1
+// when the arrays cannot grow
+static int sweep_vertex(Sweep* sweep, double sx, double sy, double tx, double ty)
+{
+    if (sweep->num_vertices == sweep->capacity) {
+        int capacity = 2 * sweep->capacity;
+        double** arrays[4] = { &sweep->sx, &sweep->sy, &sweep->tx, &sweep->ty };
+        for (int a = 0; a < 4; a++) {
+            double* grown = (double*) realloc(*arrays[a], (size_t)capacity * sizeof(double));
+            if (grown == NULL) {
+                return -1;
+            }
+            *arrays[a] = grown;
+        }
+        int* next = (int*) realloc(sweep->next, (size_t)capacity * sizeof(int));
+        if (next == NULL) {
+            return -1;
+        }
+        sweep->next = next;
+        sweep->capacity = capacity;
+    }
+    int k = sweep->num_vertices++;
+    sweep->sx[k] = sx;
+    sweep->sy[k] = sy;
+    sweep->tx[k] = tx;
+    sweep->ty[k] = ty;
+    sweep->next[k] = -1;
+    return k;
+}
+
+// Function to split the chain edge that starts at vertex a where it reaches target x, moving the
+// new vertex's source and target along the edge alike. Returns the new vertex, or -1 when x is not
+// inside the edge
+static int sweep_split(Sweep* sweep, int a, double x)
+{
+    int b = sweep->next[a];
+    if (b < 0 || !(x > sweep->tx[a] && x < sweep->tx[b])) {
+        return -1;
+    }
+    double f = (x - sweep->tx[a]) / (sweep->tx[b] - sweep->tx[a]);
+    int k = sweep_vertex(sweep, sweep->sx[a] + f * (sweep->sx[b] - sweep->sx[a]),
+                         sweep->sy[a] + f * (sweep->sy[b] - sweep->sy[a]), x,
+                         sweep->ty[a] + f * (sweep->ty[b] - sweep->ty[a]));
+    if (k >= 0) {
+        sweep->next[k] = b;
+        sweep->next[a] = k;
+    }
+    return k;
+}
+
+// Function to measure twice the signed target area of a-b-c
+static double sweep_turn(const Sweep* sweep, int a, int b, int c)
+{
+    return orient(sweep->tx[a], sweep->ty[a], sweep->tx[b], sweep->ty[b], sweep->tx[c], sweep->ty[c]);
+}
+
+// Function to triangulate the strip between two chains, merging their vertices from left to right.
+// Where the next triangle would be inside out in the target, a vertex is added on one chain straight
+// across from the current vertex of the other. Returns how many were added, or -1 on failure
+static int sweep_strip(Sweep* sweep, int lower, int upper)
+{
+    int a = sweep->head[lower], b = sweep->head[upper], added = 0;
+    while (sweep->next[a] >= 0 || sweep->next[b] >= 0) {
+        int na = sweep->next[a], nb = sweep->next[b];
+        int c = (nb < 0 || (na >= 0 && sweep->tx[na] <= sweep->tx[nb])) ? na : nb;
+        if (sweep_turn(sweep, a, c, b) <= 0.0) {
+            c = sweep->tx[b] > sweep->tx[a] ? sweep_split(sweep, a, sweep->tx[b]) : sweep_split(sweep, b, sweep->tx[a]);
+            if (c < 0 || sweep_turn(sweep, a, c, b) <= 0.0) {
+                return -1;
+            }
+            added++;
+        }
+        if (sweep->num_triangles == sweep->triangle_capacity) {
+            int capacity = 2 * sweep->triangle_capacity;
+            int* triangles = (int*) realloc(sweep->triangles, (size_t)capacity * 3 * sizeof(int));
+            if (triangles == NULL) {
+                return -1;
+            }
+            sweep->triangles = triangles;
+            sweep->triangle_capacity = capacity;
+        }
+        int* t = sweep->triangles + 3 * sweep->num_triangles++;
+        t[0] = a;
+        t[1] = c;
+        t[2] = b;
+        if (c == sweep->next[a]) {
+            a = c;
+        } else {
+            b = c;
+        }
+    }
+    return added;
+}
+
+// Function to add the next vertex of a curve at target (x, y); its source is on the curve's line,
+// where the curve's source x maps the frame sides to themselves and the target x of its point to
+// the source x of its point
+static int sweep_curve_vertex(Sweep* sweep, int point, int* last, double x, double y)
+{
+    double px = sweep->tx[point], sx = sweep->sx[point];
+    double source_x = x <= px ? sweep->left + (x - sweep->left) * (sx - sweep->left) / (px - sweep->left)
+                              : sx + (x - px) * (sweep->right - sx) / (sweep->right - px);
+    int k = sweep_vertex(sweep, source_x, sweep->sy[point], x, y);
+    if (k >= 0) {
+        sweep->next[*last] = k;
+        *last = k;
+    }
+    return k;
+}
+
+// Function to lay out the chains of the set-up sweep and triangulate the strips between them,
+// adding vertices until no strip needs any more
+static int sweep_build(Sweep* sweep)
+{
+    int m = sweep->num_curves, n = sweep->num_points;
+    sweep->num_vertices = n + 4;
+    double corners[8] = { sweep->left, sweep->bottom, sweep->right, sweep->bottom,
+                          sweep->right, sweep->top, sweep->left, sweep->top };
+    for (int j = 0; j < 4; j++) {
+        sweep->sx[n + j] = sweep->tx[n + j] = corners[2 * j];
+        sweep->sy[n + j] = sweep->ty[n + j] = corners[2 * j + 1];
+    }
+    sweep->head[0] = n;
+    sweep->next[n] = n + 1;
+    sweep->next[n + 1] = -1;
+    sweep->head[m + 1] = n + 3;
+    sweep->next[n + 3] = n + 2;
+    sweep->next[n + 2] = -1;
+
+    // The columns every curve has a bend or its own point at, in order
+    int* first = (int*) calloc(m + 2, sizeof(int));
+    if (first == NULL) {
+        return -1;
+    }
+    for (int c = 1; c <= m; c++) {
+        int from;
+        double lo, hi;
+        int count = sweep_bent(sweep, c, &from, &lo, &hi);
+        if (count > 0) {
+            first[from + 1] += 1;
+            first[from + count + 1] -= 1;
+        }
+        first[sweep->curve_of[sweep->column_point[c - 1]] + 1] += 1;
+        first[sweep->curve_of[sweep->column_point[c - 1]] + 2] -= 1;
+    }
+    for (int j = 1; j <= m; j++) {
+        first[j] += first[j - 1];
+    }
+    for (int j = 0; j < m; j++) {
+        first[j + 1] += first[j];
+    }
+    int* column = (int*) malloc(((size_t)first[m] + 1) * sizeof(int));
+    double* value = (double*) malloc(((size_t)first[m] + 1) * sizeof(double));
+    int* fill = (int*) malloc((m + 1) * sizeof(int));
+    int status = (column && value && fill) ? 0 : -1;
+    if (status == 0) {
+        memcpy(fill, first, (m + 1) * sizeof(int));
+        for (int c = 1; c <= m; c++) {
+            int p = sweep->column_point[c - 1], from;
+            double lo, hi;
+            int count = sweep_bent(sweep, c, &from, &lo, &hi);
+            for (int q = 0; q < count; q++) {
+                column[fill[from + q]] = c;
+                value[fill[from + q]++] = lo + (hi - lo) * (q + 1) / (count + 1);
+            }
+            column[fill[sweep->curve_of[p]]] = c;
+            value[fill[sweep->curve_of[p]]++] = sweep->ty[p];
+        }
+    }
+
+    // Every curve runs at its home height from the left side to the right side of the frame, and
+    // back to it one column before and after its bends
+    for (int j = 0; j < m && status == 0; j++) {
+        int point = sweep->curve_point[j], last = -1, last_column = 0;
+        double home = sweep->home[j];
+        int k = sweep_vertex(sweep, sweep->left, sweep->sy[point], sweep->left, home);
+        sweep->head[j + 1] = last = k;
+        for (int e = first[j]; e < first[j + 1] && k >= 0; e++) {
+            int c = column[e], after = e + 1 < first[j + 1] ? column[e + 1] : m + 1;
+            if (c - 1 > last_column) {
+                k = sweep_curve_vertex(sweep, point, &last, sweep->tx[sweep->column_point[c - 2]], home);
+            }
+            if (k >= 0 && sweep->column_point[c - 1] == point) {
+                sweep->next[last] = point;
+                last = point;
+            } else if (k >= 0) {
+                k = sweep_curve_vertex(sweep, point, &last, sweep->tx[sweep->column_point[c - 1]], value[e]);
+            }
+            last_column = c;
+            if (k >= 0 && c + 1 < after) {
+                k = sweep_curve_vertex(sweep, point, &last, sweep->tx[sweep->column_point[c]], home);
+                last_column = c + 1;
+            }
+        }
+        if (k >= 0) {
+            k = sweep_vertex(sweep, sweep->right, sweep->sy[point], sweep->right, home);
+        }
+        if (k < 0) {
+            status = -1;
+        } else {
+            sweep->next[last] = k;
+        }
+    }
+    free(first);
+    free(column);
+    free(value);
+    free(fill);
+
+    // A vertex added on a chain changes the strip on its other side too, so the strips are swept
+    // again, alternately upwards and downwards, until none adds any
+    int added = 1;
+    for (int pass = 0; added > 0 && status == 0; pass++) {
+        added = 0;
+        sweep->num_triangles = 0;
+        for (int i = 1; i <= m + 1 && status == 0; i++) {
+            int strip = (pass & 1) ? m + 2 - i : i;
+            int count = sweep_strip(sweep, strip - 1, strip);
+            status = count < 0 ? -1 : 0;
+            added += count;
+        }
+    }
+    return status;
+}
+
+// Function to make the swept strips the mesh: vertices turned back, and every triangle checked to
+// be counter-clockwise in the source and the target as stored
+static int sweep_store(const Sweep* sweep, MorphMesh* mesh)
+{
+    int n = sweep->num_points, num_vertices = sweep->num_vertices, num_triangles = sweep->num_triangles;
+    double* source_xy = (double*) malloc((size_t)num_vertices * 2 * sizeof(double));
+    double* target_xy = (double*) malloc((size_t)num_vertices * 2 * sizeof(double));
+    int* triangles = (int*) malloc((size_t)num_triangles * 3 * sizeof(int));
+    int* neighbours = (int*) malloc((size_t)num_triangles * 3 * sizeof(int));
+    if (!source_xy || !target_xy || !triangles || !neighbours) {
+        free(source_xy);
+        free(target_xy);
+        free(triangles);
+        free(neighbours);
+        return -1;
+    }
+    memcpy(source_xy, mesh->source_xy, (size_t)n * 2 * sizeof(double));
+    memcpy(target_xy, mesh->target_xy, (size_t)n * 2 * sizeof(double));
+    for (int k = n; k < num_vertices; k++) {
+        source_xy[2 * k] = sweep->sx[k] * sweep->cos_a - sweep->sy[k] * sweep->sin_a;
+        source_xy[2 * k + 1] = sweep->sx[k] * sweep->sin_a + sweep->sy[k] * sweep->cos_a;
+        target_xy[2 * k] = sweep->tx[k] * sweep->cos_a - sweep->ty[k] * sweep->sin_a;
+        target_xy[2 * k + 1] = sweep->tx[k] * sweep->sin_a + sweep->ty[k] * sweep->cos_a;
+    }
+    memcpy(triangles, sweep->triangles, (size_t)num_triangles * 3 * sizeof(int));
+    free(mesh->source_xy);
+    free(mesh->target_xy);
+    free(mesh->triangles);
+    free(mesh->neighbours);
+    mesh->source_xy = source_xy;
+    mesh->target_xy = target_xy;
+    mesh->triangles = triangles;
+    mesh->neighbours = neighbours;
+    mesh->num_vertices = num_vertices;
+    mesh->num_triangles = num_triangles;
+    mesh->num_folded = 0;
+    for (int t = 0; t < num_triangles; t++) {
+        mesh->num_folded += folds(mesh, triangles + 3 * t);
+    }
+    return mesh->num_folded == 0 ? link_neighbours(mesh) : -1;
+}
+
+// Function to rebuild the mesh from strips when flips leave triangles folded. Directions are tried
+// from the one that takes the fewest bends; returns 0 once one gives a mesh without folds
+static int sweep_mesh(MorphMesh* mesh, const unsigned char* duplicate)
+{
+    int num_curves = 0;
+    for (int i = 0; i < mesh->num_points; i++) {
+        num_curves += !duplicate[i];
+    }
+    Sweep sweep;
+    if (sweep_open(&sweep, mesh->num_points, num_curves) < 0) {
+        return -1;
+    }
+    double angle[SWEEP_ANGLES];
+    long long bends[SWEEP_ANGLES];
+    for (int k = 0; k < SWEEP_ANGLES; k++) {
+        angle[k] = (k + 0.05) * M_PI / SWEEP_ANGLES;  // off the axes, where points tend to line up
+        bends[k] = sweep_setup(&sweep, mesh, duplicate, angle[k]);
+    }
+    int status = -1;
+    while (status < 0) {
+        int best = -1;
+        for (int k = 0; k < SWEEP_ANGLES; k++) {
+            if (bends[k] >= 0 && (best < 0 || bends[k] < bends[best])) {
+                best = k;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        bends[best] = -1;
+        sweep_setup(&sweep, mesh, duplicate, angle[best]);
+        if (sweep_build(&sweep) == 0) {
+            status = sweep_store(&sweep, mesh);
+        }
+    }
+    sweep_free(&sweep);
+    return status;
+}
+
+// Function to triangulate the source points and pair them with the target
+MorphMesh* morph_mesh_create(int num_points, const float* source_xy, const float* target_xy)
+{
+    MorphMesh* mesh = (MorphMesh*) calloc(1, sizeof(MorphMesh));
+    if (mesh == NULL || num_points < 1) {
+        printf("Error: Could not create a mesh of %d points\n", num_points);
+        free(mesh);
+        return NULL;
+    }
+    mesh->num_points = num_points;
+    mesh->num_vertices = num_points + 4;
+    mesh->source_xy = (double*) malloc((size_t)mesh->num_vertices * 2 * sizeof(double));
+    mesh->target_xy = (double*) malloc((size_t)mesh->num_vertices * 2 * sizeof(double));
+    unsigned char* duplicate = (unsigned char*) calloc(num_points, 1);
+    SortPoint* sorted = (SortPoint*) malloc(num_points * sizeof(SortPoint));
+    if (!mesh->source_xy || !mesh->target_xy || !duplicate || !sorted) {
+        printf("Error: Could not allocate a mesh of %d points\n", num_points);
+        free(duplicate);
+        free(sorted);
+        morph_mesh_destroy(mesh);
+        return NULL;
+    }
+    for (int i = 0; i < 2 * num_points; i++) {
+        mesh->source_xy[i] = source_xy[i];
+        mesh->target_xy[i] = target_xy[i];
+    }
+    mark_duplicates(mesh->source_xy, num_points, duplicate, sorted);
+    mark_duplicates(mesh->target_xy, num_points, duplicate, sorted);
+    free(sorted);
+    for (int i = 0; i < num_points; i++) {
+        mesh->num_duplicates += duplicate[i];
+    }
+    set_frame(mesh);
+
+    // The Delaunay mesh of the points and the frame corners, with flips, usually has no folds
+    grid_setup(mesh);
+    mesh->cell_triangle = (int*) malloc((size_t)mesh->columns * mesh->rows * sizeof(int));
+    int* order = grid_order(mesh);
+    int status = (mesh->cell_triangle && order) ? triangulate(mesh, order, duplicate) : -1;
+    free(order);
+    if (status == 0) {
+        mesh->num_folded = unfold_triangles(mesh);
+    }
+
+    // Otherwise the strips hold every point, with as many Steiner points as the pairing needs
+    if (status == 0 && (mesh->num_folded > 0 || !on_frame(mesh))) {
+        status = sweep_mesh(mesh, duplicate);
+        if (status == 0) {
+            grid_setup(mesh);
+            free(mesh->cell_triangle);
+            mesh->cell_triangle = (int*) malloc((size_t)mesh->columns * mesh->rows * sizeof(int));
+            status = mesh->cell_triangle ? 0 : -1;
+        }
+    }
+    free(duplicate);
+    if (status == -1) {
+        printf("Error: Could not triangulate %d points\n", num_points);
+        morph_mesh_destroy(mesh);
+        return NULL;
+    }
+    grid_index_triangles(mesh);
+    return mesh;
+}
+
+// Function to release a mesh
+void morph_mesh_destroy(MorphMesh* mesh)
+{
+    if (mesh == NULL) {
+        return;
+    }
+    free(mesh->source_xy);
+    free(mesh->target_xy);
+    free(mesh->triangles);
+    free(mesh->neighbours);
+    free(mesh->cell_triangle);
+    free(mesh);
+}
+
+// Function to test whether the source triangle t holds (x, y), edges included
+static int holds(const MorphMesh* mesh, int t, double x, double y)
+{
+    const double* s = mesh->source_xy;
+    for (int i = 0; i < 3; i++) {
+        int a = mesh->triangles[3 * t + (i + 1) % 3], b = mesh->triangles[3 * t + (i + 2) % 3];
+        if (orient(s[2 * a], s[2 * a + 1], s[2 * b], s[2 * b + 1], x, y) < 0.0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Function to find the source triangle holding a point, and the point's barycentric weights
+int morph_mesh_locate(const MorphMesh* mesh, float x, float y, float weights[3])
+{
+    // Walk from the triangle kept for the point's cell, as during the build; the mesh is convex, so
+    // a walk that would leave it across the frame means the point is outside
+    const double* s = mesh->source_xy;
+    int t = mesh->num_triangles > 0 ? mesh->cell_triangle[grid_cell(mesh, x, y)] : -1;
+    int found = -1, outside = t < 0;
+    for (int step = 0; found < 0 && !outside && step < 4 * mesh->num_triangles + 16; step++) {
+        int crossed = -1;
+        for (int k = 0; k < 3 && crossed < 0; k++) {
+            int i = (k + step) % 3;
+            int a = mesh->triangles[3 * t + (i + 1) % 3], b = mesh->triangles[3 * t + (i + 2) % 3];
+            if (orient(s[2 * a], s[2 * a + 1], s[2 * b], s[2 * b + 1], x, y) < 0.0) {
+                crossed = i;
+            }
+        }
+        if (crossed < 0) {
+            found = t;
+        } else if (mesh->neighbours[3 * t + crossed] < 0) {
+            outside = 1;
+        } else {
+            t = mesh->neighbours[3 * t + crossed];
+        }
+    }
+    for (int u = 0; found < 0 && !outside && u < mesh->num_triangles; u++) {
+        // The walk gave up (rounding on nearly flat triangles); test every triangle
+        found = holds(mesh, u, x, y) ? u : -1;
+    }
+    if (found < 0) {
+        return -1;
+    }
+    const int* v = mesh->triangles + 3 * found;
+    double area = orient(s[2 * v[0]], s[2 * v[0] + 1], s[2 * v[1]], s[2 * v[1] + 1], s[2 * v[2]], s[2 * v[2] + 1]);
+    weights[0] = (float)(orient(s[2 * v[1]], s[2 * v[1] + 1], s[2 * v[2]], s[2 * v[2] + 1], x, y) / area);
+    weights[1] = (float)(orient(s[2 * v[2]], s[2 * v[2] + 1], s[2 * v[0]], s[2 * v[0] + 1], x, y) / area);
+    weights[2] = 1.0f - weights[0] - weights[1];
+    return found;
+}
+
+// Function to place a bound point among the moved corners of its triangle
+void morph_mesh_place(const MorphMesh* mesh, const float* points_x, const float* points_y, int triangle,
+                      const float weights[3], float* x, float* y)
+{
+    const int* v = mesh->triangles + 3 * triangle;
+    *x = weights[0] * points_x[v[0]] + weights[1] * points_x[v[1]] + weights[2] * points_x[v[2]];
+    *y = weights[0] * points_y[v[0]] + weights[1] * points_y[v[1]] + weights[2] * points_y[v[2]];
+}
@@ -0,0 +1,51 @@
+#ifndef MORPH_MESH_H
+#define MORPH_MESH_H
+
+// Define a compatible triangulation of a source and a target point set: point i of the source
+// corresponds to point i of the target, and one list of triangles connects both so that every
+// triangle is counter-clockwise in the source and in the target. Four frame corners around both
+// sets are shared, so the hulls match. The mesh is the Delaunay triangulation of the source with
+// edges flipped where a triangle is inside out in the target. When flips are not enough, the frame
+// is cut into strips by a line through every source point, and the same strips are laid out in the
+// target between bent curves through the target points; the bends are Steiner points, whose number
+// grows with how much the pairing shuffles the points. Vertices move in straight lines, so a
+// triangle can still pass through flat on the way
+typedef struct {
+    int num_points;         // input points, the first vertices
+    int num_vertices;       // input points, the 4 frame corners, then the Steiner points
+    double* source_xy;      // interleaved x,y of every vertex (the input points are copies); double,
+    double* target_xy;      // as Steiner points in crowded strips lie closer than float resolution
+    int num_triangles;
+    int* triangles;         // 3 vertex indices per triangle, counter-clockwise in the source
+    int* neighbours;        // 3 per triangle: across the edge opposite each vertex, -1 on the frame
+    int num_duplicates;     // points that repeat an earlier one in the source or the target; no
+                            // triangle uses them, as no mesh can keep them apart
+    int num_folded;         // triangles inside out in the source or the target (0 once the mesh is built)
+    // Uniform grid over the source bounds, about one vertex per cell; every cell keeps a triangle
+    // near it, where point location starts walking
+    float grid_x, grid_y;
+    float cell_size;
+    int columns, rows;
+    int* cell_triangle;
+} MorphMesh;
+
+// Triangulate num_points interleaved x,y source points and pair them with the target points.
+// Points are inserted one grid cell after another and located from their cell, so the Delaunay
+// mesh is set up in near-linear time; the strips take time in proportion to their Steiner points.
+// Returns NULL on failure
+MorphMesh* morph_mesh_create(int num_points, const float* source_xy, const float* target_xy);
+
+// Release a mesh
+void morph_mesh_destroy(MorphMesh* mesh);
+
+// Find the source triangle holding (x, y) and its barycentric weights, walking from the triangle
+// kept for the point's grid cell. Returns the triangle index, or -1 for a point outside the mesh
+int morph_mesh_locate(const MorphMesh* mesh, float x, float y, float weights[3]);
+
+// Place a point bound to a triangle by morph_mesh_locate in a frame whose vertex positions are
+// points_x / points_y: the same weights on the moved corners, so every triangle's interior
+// follows it affinely
+void morph_mesh_place(const MorphMesh* mesh, const float* points_x, const float* points_y, int triangle,
+                      const float weights[3], float* x, float* y);
+
+#endif
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include "paint.h"
+#include "svg_scan.h"    // attributes are read from the mapped file, like the geometry
+#include "svg_format.h"  // short opacity and width values
+
+#define LINEAR_TABLE_SIZE 4096   // Linear light is quantized to 12 bits for the way back
+
+static float srgb_table[256];                          // 8-bit sRGB -> linear
+static unsigned char linear_table[LINEAR_TABLE_SIZE];  // 12-bit linear -> 8-bit sRGB
+static int tables_ready = 0;
+
+// Define a named CSS color
+typedef struct {
+    const char* name;
+    unsigned int rgb;  // 0xRRGGBB
+} NamedColor;
+
+// Common CSS color names (the ones the tc_* test cases and our drawings use)
+static const NamedColor named_colors[] = {
+    { "black", 0x000000 }, { "white", 0xFFFFFF }, { "red", 0xFF0000 }, { "green", 0x008000 },
+    { "blue", 0x0000FF }, { "yellow", 0xFFFF00 }, { "cyan", 0x00FFFF }, { "aqua", 0x00FFFF },
+    { "magenta", 0xFF00FF }, { "fuchsia", 0xFF00FF }, { "gray", 0x808080 }, { "grey", 0x808080 },
+    { "silver", 0xC0C0C0 }, { "maroon", 0x800000 }, { "olive", 0x808000 }, { "lime", 0x00FF00 },
+    { "teal", 0x008080 }, { "navy", 0x000080 }, { "purple", 0x800080 }, { "orange", 0xFFA500 },
+    { "pink", 0xFFC0CB }, { "brown", 0xA52A2A }, { "gold", 0xFFD700 }, { "indigo", 0x4B0082 },
+    { "violet", 0xEE82EE }, { "darkgreen", 0x006400 }, { "darkblue", 0x00008B }, { "darkred", 0x8B0000 },
+    { "lightgray", 0xD3D3D3 }, { "lightgrey", 0xD3D3D3 }, { "darkgray", 0xA9A9A9 }, { "darkgrey", 0xA9A9A9 }
+};
+
+// Function to fill both conversion tables with the exact sRGB transfer curve
+void paint_tables_init(void)
+{
+    if (tables_ready) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        double c = i / 255.0;
+        srgb_table[i] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+    }
+    for (int i = 0; i < LINEAR_TABLE_SIZE; i++) {
+        double l = (double)i / (LINEAR_TABLE_SIZE - 1);
+        double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+        linear_table[i] = (unsigned char)lrint(c * 255.0);
+    }
+    tables_ready = 1;
+}
+
+// Function to look up the linear value of an sRGB channel
+float srgb_to_linear(int value)
+{
+    return srgb_table[value < 0 ? 0 : (value > 255 ? 255 : value)];
+}
+
+// Function to look up the sRGB byte of a linear channel
+unsigned char linear_to_srgb(float value)
+{
+    int index = (int)(value * (LINEAR_TABLE_SIZE - 1) + 0.5f);
+    return linear_table[index < 0 ? 0 : (index > LINEAR_TABLE_SIZE - 1 ? LINEAR_TABLE_SIZE - 1 : index)];
+}
+
+// Function to convert an SVG color string to channels
+int parse_svg_color(const char* text, float* r, float* g, float* b)
+{
+    while (*text == ' ') text++;
+    if (text[0] == '#') {
+        unsigned int value;
+        size_t length = strlen(text + 1);
+        if (sscanf(text + 1, "%x", &value) != 1) {
+            return -1;
+        }
+        if (length == 3) {
+            // #rgb is shorthand for #rrggbb
+            *r = (float)(((value >> 8) & 0xF) * 17);
+            *g = (float)(((value >> 4) & 0xF) * 17);
+            *b = (float)((value & 0xF) * 17);
+            return 0;
+        }
+        if (length == 6) {
+            *r = (float)((value >> 16) & 0xFF);
+            *g = (float)((value >> 8) & 0xFF);
+            *b = (float)(value & 0xFF);
+            return 0;
+        }
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(named_colors) / sizeof(named_colors[0]); i++) {
+        if (strcasecmp(text, named_colors[i].name) == 0) {
+            *r = (float)((named_colors[i].rgb >> 16) & 0xFF);
+            *g = (float)((named_colors[i].rgb >> 8) & 0xFF);
+            *b = (float)(named_colors[i].rgb & 0xFF);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Function to read one color attribute into linear channels and an alpha
+static void read_color(const SvgSpan* tag, const char* name, const char* opacity_name,
+                       int has_default, float* rgb, float* alpha)
+{
+    char value[64];
+    float r = 0, g = 0, b = 0;
+    *alpha = has_default ? 1.0f : 0.0f;  // Fill defaults to black, stroke to none
+    if (svg_attribute_copy(tag, name, value, sizeof(value)) == 0) {
+        if (strcmp(value, "none") == 0) {
+            *alpha = 0.0f;
+        } else if (parse_svg_color(value, &r, &g, &b) == 0) {
+            *alpha = 1.0f;
+        } else {
+            printf("Warning: Unknown color name '%s'. Using black.\n", value);
+            *alpha = 1.0f;
+        }
+    }
+    rgb[0] = srgb_to_linear((int)r);
+    rgb[1] = srgb_to_linear((int)g);
+    rgb[2] = srgb_to_linear((int)b);
+
+    float opacity;
+    if (svg_attribute_float(tag, opacity_name, &opacity) == 0) {
+        *alpha *= opacity;
+    }
+}
+
+// Function to read the paint of the first matching element of an SVG file
+int extract_paint_info(const char* svg_file, const char* element, float paint[PAINT_NUM_CHANNELS])
+{
+    paint_tables_init();
+    SvgFile file;
+    if (svg_file_map(svg_file, &file) == -1) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    SvgSpan tag;
+    int status = svg_find_element(&file, element, &offset, &tag);
+    if (status == 0) {
+        read_color(&tag, "fill", "fill-opacity", 1, &paint[PAINT_FILL_R], &paint[PAINT_FILL_ALPHA]);
+        read_color(&tag, "stroke", "stroke-opacity", 0, &paint[PAINT_STROKE_R], &paint[PAINT_STROKE_ALPHA]);
+        if (svg_attribute_float(&tag, "stroke-width", &paint[PAINT_STROKE_WIDTH]) == -1) {
+            paint[PAINT_STROKE_WIDTH] = 1.0f;
+        }
+        if (svg_attribute_float(&tag, "opacity", &paint[PAINT_OPACITY]) == -1) {
+            paint[PAINT_OPACITY] = 1.0f;
+        }
+    }
+
+    svg_file_unmap(&file);
+    return status;
+}
+
+// Function to allocate the channel arrays of a paint set
+int paint_set_init(PaintSet* set, int capacity)
+{
+    paint_tables_init();
+    memset(set, 0, sizeof(PaintSet));
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+        set->channels[c] = (float*) malloc(capacity * sizeof(float));
+        if (set->channels[c] == NULL) {
+            printf("Error: Could not allocate paint for %d elements\n", capacity);
+            paint_set_free(set);
+            return -1;
+        }
+    }
+    set->capacity = capacity;
+    return 0;
+}
+
+// Function to release the channel arrays
+void paint_set_free(PaintSet* set)
+{
+    for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+        free(set->channels[c]);
+        set->channels[c] = NULL;
+    }
+    set->count = 0;
+    set->capacity = 0;
+}
+
+// Function to append one element's paint, doubling the arrays when full
+int paint_set_add(PaintSet* set, const float paint[PAINT_NUM_CHANNELS])
+{
+    if (set->count == set->capacity) {
+        int capacity = set->capacity * 2;
+        for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+            float* grown = (float*) realloc(set->channels[c], capacity * sizeof(float));
+            if (grown == NULL) {
+                printf("Error: Could not grow paint to %d elements\n", capacity);
+                return -1;
+            }
+            set->channels[c] = grown;
+        }
+        set->capacity = capacity;
+    }
+    for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+        set->channels[c][set->count] = paint[c];
+    }
+    set->count++;
+    return 0;
+}
+
+// Function to copy the color of a visible paint onto its invisible counterpart
+static void pair_color(PaintSet* start, PaintSet* final, int first_channel, int alpha_channel)
+{
+    for (int i = 0; i < start->count && i < final->count; i++) {
+        PaintSet* hidden = NULL;
+        PaintSet* shown = NULL;
+        if (start->channels[alpha_channel][i] == 0.0f && final->channels[alpha_channel][i] > 0.0f) {
+            hidden = start;
+            shown = final;
+        } else if (final->channels[alpha_channel][i] == 0.0f && start->channels[alpha_channel][i] > 0.0f) {
+            hidden = final;
+            shown = start;
+        }
+        if (hidden) {
+            for (int c = first_channel; c < first_channel + 3; c++) {
+                hidden->channels[c][i] = shown->channels[c][i];
+            }
+        }
+    }
+}
+
+// Function to make "none" fills and strokes fade in or out instead of blending toward black
+void paint_set_pair(PaintSet* start, PaintSet* final)
+{
+    pair_color(start, final, PAINT_FILL_R, PAINT_FILL_ALPHA);
+    pair_color(start, final, PAINT_STROKE_R, PAINT_STROKE_ALPHA);
+}
+
+// Function to blend every paint channel; each channel is one contiguous SIMD loop
+void paint_set_interpolate(const PaintSet* start, const PaintSet* final, float t, PaintSet* out)
+{
+    int n = start->count;
+    out->count = n;
+    for (int c = 0; c < PAINT_NUM_CHANNELS; c++) {
+        const float* restrict from = start->channels[c];
+        const float* restrict to = final->channels[c];
+        float* restrict result = out->channels[c];
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            result[i] = from[i] + (to[i] - from[i]) * t;
+        }
+    }
+}
+
+// Function to turn linear paint into 8-bit sRGB colors for every element
+void paint_set_encode(const PaintSet* set, Color* fills, Color* strokes)
+{
+    const float* const* ch = (const float* const*) set->channels;
+    for (int i = 0; i < set->count; i++) {
+        float opacity = ch[PAINT_OPACITY][i];
+        if (fills) {
+            fills[i].r = linear_to_srgb(ch[PAINT_FILL_R][i]);
+            fills[i].g = linear_to_srgb(ch[PAINT_FILL_G][i]);
+            fills[i].b = linear_to_srgb(ch[PAINT_FILL_B][i]);
+            fills[i].a = (unsigned char)lrintf(fminf(fmaxf(ch[PAINT_FILL_ALPHA][i] * opacity, 0.0f), 1.0f) * 255.0f);
+        }
+        if (strokes) {
+            strokes[i].r = linear_to_srgb(ch[PAINT_STROKE_R][i]);
+            strokes[i].g = linear_to_srgb(ch[PAINT_STROKE_G][i]);
+            strokes[i].b = linear_to_srgb(ch[PAINT_STROKE_B][i]);
+            strokes[i].a = (unsigned char)lrintf(fminf(fmaxf(ch[PAINT_STROKE_ALPHA][i] * opacity, 0.0f), 1.0f) * 255.0f);
+        }
+    }
+}
+
+// Function to write one element's paint as SVG attributes
+int paint_format_attributes(const PaintSet* set, int index, char* buffer, size_t size)
+{
+    static const CoordFormat amount = { 3, 0.0f };  // Opacities and widths keep 3 decimals at most
+    const float* const* ch = (const float* const*) set->channels;
+    char number[32];
+    float fill_alpha = ch[PAINT_FILL_ALPHA][index];
+    float stroke_alpha = ch[PAINT_STROKE_ALPHA][index];
+    int length = 0;
+
+    if (fill_alpha <= 0.0f) {
+        length += snprintf(buffer + length, size - length, "fill='none'");
+    } else {
+        length += snprintf(buffer + length, size - length, "fill='#%02x%02x%02x'",
+                           linear_to_srgb(ch[PAINT_FILL_R][index]), linear_to_srgb(ch[PAINT_FILL_G][index]),
+                           linear_to_srgb(ch[PAINT_FILL_B][index]));
+        if (fill_alpha < 1.0f) {
+            format_number(number, fill_alpha, &amount);
+            length += snprintf(buffer + length, size - length, " fill-opacity='%s'", number);
+        }
+    }
+    if (stroke_alpha > 0.0f && (size_t)length < size) {
+        format_number(number, ch[PAINT_STROKE_WIDTH][index], &amount);
+        length += snprintf(buffer + length, size - length, " stroke='#%02x%02x%02x' stroke-width='%s'",
+                           linear_to_srgb(ch[PAINT_STROKE_R][index]), linear_to_srgb(ch[PAINT_STROKE_G][index]),
+                           linear_to_srgb(ch[PAINT_STROKE_B][index]), number);
+        if (stroke_alpha < 1.0f && (size_t)length < size) {
+            format_number(number, stroke_alpha, &amount);
+            length += snprintf(buffer + length, size - length, " stroke-opacity='%s'", number);
+        }
+    }
+    if (ch[PAINT_OPACITY][index] < 1.0f && (size_t)length < size) {
+        format_number(number, ch[PAINT_OPACITY][index], &amount);
+        length += snprintf(buffer + length, size - length, " opacity='%s'", number);
+    }
+    return length;
+}
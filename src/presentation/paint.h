@@ -0,0 +1,66 @@
+#ifndef PAINT_H
+#define PAINT_H
+
+#include <stddef.h>
+#include "raster.h"   // Color
+
+// Paint attributes of an element; colors are kept in linear light so blends look even
+typedef enum {
+    PAINT_FILL_R,
+    PAINT_FILL_G,
+    PAINT_FILL_B,
+    PAINT_FILL_ALPHA,     // fill-opacity, 0 for fill="none"
+    PAINT_STROKE_R,
+    PAINT_STROKE_G,
+    PAINT_STROKE_B,
+    PAINT_STROKE_ALPHA,   // stroke-opacity, 0 for stroke="none"
+    PAINT_STROKE_WIDTH,
+    PAINT_OPACITY,
+    PAINT_NUM_CHANNELS
+} PaintChannel;
+
+// Define the paint of many elements, one contiguous array per channel
+typedef struct {
+    int count;
+    int capacity;
+    float* channels[PAINT_NUM_CHANNELS];
+} PaintSet;
+
+// Build the sRGB <-> linear lookup tables; call once before any threads start
+void paint_tables_init(void);
+
+// Convert one 8-bit sRGB channel to linear light (table lookup)
+float srgb_to_linear(int value);
+
+// Convert one linear-light channel back to 8-bit sRGB (table lookup)
+unsigned char linear_to_srgb(float value);
+
+// Parse an SVG color ("#rgb", "#rrggbb" or a CSS color name) into 0-255 sRGB channels
+int parse_svg_color(const char* text, float* r, float* g, float* b);
+
+// Read fill, stroke, stroke-width and opacity of the first `element` in an SVG file,
+// using the SVG defaults (black fill, no stroke) for missing attributes
+int extract_paint_info(const char* svg_file, const char* element, float paint[PAINT_NUM_CHANNELS]);
+
+// Allocate room for capacity elements, returns 0 on success and -1 on failure
+int paint_set_init(PaintSet* set, int capacity);
+
+// Release the channel arrays
+void paint_set_free(PaintSet* set);
+
+// Append one element's paint
+int paint_set_add(PaintSet* set, const float paint[PAINT_NUM_CHANNELS]);
+
+// Give "none" paints the color of the other side so only their opacity fades
+void paint_set_pair(PaintSet* start, PaintSet* final);
+
+// Blend every channel of every element at factor t into out (room for start->count)
+void paint_set_interpolate(const PaintSet* start, const PaintSet* final, float t, PaintSet* out);
+
+// Convert every element to 8-bit sRGB fill and stroke colors (alpha includes opacity)
+void paint_set_encode(const PaintSet* set, Color* fills, Color* strokes);
+
+// Format the paint of element `index` as SVG attributes, returns the number of characters
+int paint_format_attributes(const PaintSet* set, int index, char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "spsc_ring.h"
+#include "pipeline.h"
+
+struct Pipeline {
+    PipelineCallbacks callbacks;
+    void* context;
+    int num_workers;
+    SpscRing* items;           // caller -> serialize thread i
+    SpscRing* outputs;         // serialize thread i -> I/O thread
+    pthread_t* workers;
+    void** states;             // scratch state of every serialize thread
+    pthread_t writer;
+    int num_started;           // serialize threads running
+    int writer_started;
+    long submitted;            // items handed in by the caller (caller only)
+    long total;                // final item count, set before closing
+    int closing;
+    int failed;
+};
+
+// Define what a serialize thread needs to know about itself
+typedef struct {
+    Pipeline* pipeline;
+    int index;
+} PipelineWorkerArgs;
+
+// Function to tell whether any stage has failed
+static int pipeline_failed(Pipeline* pipeline)
+{
+    return __atomic_load_n(&pipeline->failed, __ATOMIC_ACQUIRE);
+}
+
+// Function to serialize the items of one ring pair until the caller closes the pipeline
+static void* pipeline_worker(void* arg)
+{
+    PipelineWorkerArgs* args = (PipelineWorkerArgs*) arg;
+    Pipeline* pipeline = args->pipeline;
+    SpscRing* items = &pipeline->items[args->index];
+    SpscRing* outputs = &pipeline->outputs[args->index];
+    void* worker = pipeline->states[args->index];
+    free(args);
+
+    int round = 0;
+    while (!pipeline_failed(pipeline)) {
+        const void* item = spsc_ring_peek(items);
+        if (item == NULL) {
+            // The caller publishes its last item before it sets closing
+            if (__atomic_load_n(&pipeline->closing, __ATOMIC_ACQUIRE) && spsc_ring_peek(items) == NULL) {
+                break;
+            }
+            spsc_ring_wait(&round);
+            continue;
+        }
+        void* out = spsc_ring_claim(outputs);
+        if (out == NULL) {
+            spsc_ring_wait(&round);
+            continue;
+        }
+        round = 0;
+        if (pipeline->callbacks.serialize(pipeline->context, worker, item, out) == -1) {
+            __atomic_store_n(&pipeline->failed, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        spsc_ring_publish(outputs);
+        spsc_ring_release(items);
+    }
+    return NULL;
+}
+
+// Function to write the outputs in submission order: output n waits in ring n % num_workers
+static void* pipeline_writer(void* arg)
+{
+    Pipeline* pipeline = (Pipeline*) arg;
+    int round = 0;
+    for (long n = 0; !pipeline_failed(pipeline);) {
+        SpscRing* outputs = &pipeline->outputs[n % pipeline->num_workers];
+        const void* out = spsc_ring_peek(outputs);
+        if (out == NULL) {
+            if (__atomic_load_n(&pipeline->closing, __ATOMIC_ACQUIRE) &&
+                n == __atomic_load_n(&pipeline->total, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            spsc_ring_wait(&round);
+            continue;
+        }
+        round = 0;
+        if (pipeline->callbacks.write(pipeline->context, out) == -1) {
+            __atomic_store_n(&pipeline->failed, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        spsc_ring_release(outputs);
+        n++;
+    }
+    return NULL;
+}
+
+// Function to allocate zeroed rings on a cache line boundary, which calloc does not promise and the
+// rings' _Alignas(64) counters rely on
+static SpscRing* ring_array_alloc(int count)
+{
+    size_t bytes = ((size_t)count * sizeof(SpscRing) + 63) / 64 * 64;  // aligned_alloc takes whole lines
+    SpscRing* rings = (SpscRing*) aligned_alloc(64, bytes);
+    if (rings) {
+        memset(rings, 0, bytes);
+    }
+    return rings;
+}
+
+// Function to size the rings from the budget and start the stage threads
+Pipeline* pipeline_open(const PipelineCallbacks* callbacks, void* context, int serialize_threads,
+                        size_t item_size, size_t out_size, size_t memory_budget)
+{
+    if (serialize_threads < 1) {
+        serialize_threads = 1;
+    }
+    Pipeline* pipeline = (Pipeline*) calloc(1, sizeof(Pipeline));
+    if (pipeline == NULL) {
+        printf("Error: Could not allocate the pipeline\n");
+        return NULL;
+    }
+    pipeline->callbacks = *callbacks;
+    pipeline->context = context;
+    pipeline->num_workers = serialize_threads;
+    pipeline->items = ring_array_alloc(serialize_threads);
+    pipeline->outputs = ring_array_alloc(serialize_threads);
+    pipeline->workers = (pthread_t*) calloc(serialize_threads, sizeof(pthread_t));
+    pipeline->states = (void**) calloc(serialize_threads, sizeof(void*));
+    if (pipeline->items == NULL || pipeline->outputs == NULL || pipeline->workers == NULL ||
+        pipeline->states == NULL) {
+        printf("Error: Could not allocate the pipeline\n");
+        pipeline_close(pipeline);
+        return NULL;
+    }
+
+    // Every ring pair gets the same power-of-two slot count that keeps all of them within the budget
+    size_t pair_bytes = (size_t)serialize_threads * (item_size + out_size);
+    size_t slots = 2;
+    while (slots < 1024 && slots * 2 * pair_bytes <= memory_budget) {
+        slots *= 2;
+    }
+    if (slots * pair_bytes > memory_budget) {
+        printf("Warning: The pipeline needs %zu KB, above its memory budget\n", slots * pair_bytes / 1024);
+    }
+    for (int i = 0; i < serialize_threads; i++) {
+        if (spsc_ring_init(&pipeline->items[i], slots, item_size) == -1 ||
+            spsc_ring_init(&pipeline->outputs[i], slots, out_size) == -1) {
+            pipeline_close(pipeline);
+            return NULL;
+        }
+    }
+
+    // Scratch state is set up here, before any thread runs, so the stages start out fully allocated
+    for (int i = 0; callbacks->worker_init && i < serialize_threads; i++) {
+        if ((pipeline->states[i] = callbacks->worker_init(context)) == NULL) {
+            printf("Error: Could not set up serialize thread %d\n", i);
+            pipeline_close(pipeline);
+            return NULL;
+        }
+    }
+
+    for (int i = 0; i < serialize_threads; i++) {
+        PipelineWorkerArgs* args = (PipelineWorkerArgs*) malloc(sizeof(PipelineWorkerArgs));
+        if (args == NULL) {
+            printf("Error: Could not start serialize thread %d\n", i);
+            pipeline_close(pipeline);
+            return NULL;
+        }
+        args->pipeline = pipeline;
+        args->index = i;
+        if (pthread_create(&pipeline->workers[i], NULL, pipeline_worker, args) != 0) {
+            printf("Error: Could not start serialize thread %d\n", i);
+            free(args);
+            pipeline_close(pipeline);
+            return NULL;
+        }
+        pipeline->num_started++;
+    }
+    if (pthread_create(&pipeline->writer, NULL, pipeline_writer, pipeline) != 0) {
+        printf("Error: Could not start the pipeline writer thread\n");
+        pipeline_close(pipeline);
+        return NULL;
+    }
+    pipeline->writer_started = 1;
+    return pipeline;
+}
+
+// Function to wait for room in the ring of the next item
+void* pipeline_claim(Pipeline* pipeline)
+{
+    SpscRing* items = &pipeline->items[pipeline->submitted % pipeline->num_workers];
+    int round = 0;
+    for (;;) {
+        if (pipeline_failed(pipeline)) {
+            return NULL;
+        }
+        void* item = spsc_ring_claim(items);
+        if (item) {
+            return item;
+        }
+        spsc_ring_wait(&round);
+    }
+}
+
+// Function to publish the claimed item
+void pipeline_submit(Pipeline* pipeline)
+{
+    spsc_ring_publish(&pipeline->items[pipeline->submitted % pipeline->num_workers]);
+    pipeline->submitted++;
+}
+
+// Function to drain and stop every stage
+int pipeline_close(Pipeline* pipeline)
+{
+    __atomic_store_n(&pipeline->total, pipeline->submitted, __ATOMIC_RELEASE);
+    __atomic_store_n(&pipeline->closing, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < pipeline->num_started; i++) {
+        pthread_join(pipeline->workers[i], NULL);
+    }
+    if (pipeline->writer_started) {
+        pthread_join(pipeline->writer, NULL);
+    }
+    int status = pipeline_failed(pipeline) ? -1 : 0;
+    for (int i = 0; pipeline->items && i < pipeline->num_workers; i++) {
+        spsc_ring_free(&pipeline->items[i]);
+    }
+    for (int i = 0; pipeline->outputs && i < pipeline->num_workers; i++) {
+        spsc_ring_free(&pipeline->outputs[i]);
+    }
+    for (int i = 0; pipeline->states && pipeline->callbacks.worker_free && i < pipeline->num_workers; i++) {
+        if (pipeline->states[i]) {
+            pipeline->callbacks.worker_free(pipeline->states[i]);
+        }
+    }
+    free(pipeline->states);
+    free(pipeline->items);
+    free(pipeline->outputs);
+    free(pipeline->workers);
+    free(pipeline);
+    return status;
+}
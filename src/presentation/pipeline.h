@@ -0,0 +1,37 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+
+// Define what the pipeline does with an item. serialize runs on the serialize threads, write on
+// the single I/O thread, in submission order
+typedef struct {
+    int (*serialize)(void* context, void* worker, const void* item, void* out);  // returns 0 or -1
+    int (*write)(void* context, const void* out);                                // returns 0 or -1
+    void* (*worker_init)(void* context);     // scratch state of one serialize thread, NULL on failure
+    void (*worker_free)(void* worker);       // both are optional and run on the caller's thread
+} PipelineCallbacks;
+
+// Opaque pipeline state (rings and stage threads)
+typedef struct Pipeline Pipeline;
+
+// Start a three-stage pipeline: the caller computes items (item_size bytes), serialize_threads
+// threads turn them into outputs (out_size bytes) and one I/O thread writes the outputs in the
+// order the items were submitted. Item n travels through the ring pair n % serialize_threads,
+// each ring having a single producer and a single consumer, so no stage takes a lock.
+// memory_budget bounds the bytes of all rings together; every ring gets at least 2 slots
+Pipeline* pipeline_open(const PipelineCallbacks* callbacks, void* context, int serialize_threads,
+                        size_t item_size, size_t out_size, size_t memory_budget);
+
+// Slot for the next item; the caller fills it and calls pipeline_submit. Waits while the next
+// ring is full; returns NULL once a stage has failed
+void* pipeline_claim(Pipeline* pipeline);
+
+// Hand the claimed item to its serialize thread
+void pipeline_submit(Pipeline* pipeline);
+
+// Let every submitted item through, stop the threads and release the rings. Returns 0, or -1
+// if a stage failed
+int pipeline_close(Pipeline* pipeline);
+
+#endif
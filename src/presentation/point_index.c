@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include "point_index.h"
+
+// Define a source point waiting to be matched, ordered by its distance to the nearest target
+typedef struct {
+    float distance2;
+    int source;
+} MatchOrder;
+
+// Function to swap two tree slots
+static void swap_slots(PointIndex* index, int a, int b)
+{
+    float x = index->xy[2 * a], y = index->xy[2 * a + 1];
+    int id = index->ids[a];
+    index->xy[2 * a] = index->xy[2 * b];
+    index->xy[2 * a + 1] = index->xy[2 * b + 1];
+    index->ids[a] = index->ids[b];
+    index->xy[2 * b] = x;
+    index->xy[2 * b + 1] = y;
+    index->ids[b] = id;
+}
+
+// Function to move the point of rank k along one axis into slot k of [lo, hi), smaller
+// coordinates before it and larger ones after (quickselect, linear on average)
+static void select_rank(PointIndex* index, int lo, int hi, int k, int axis)
+{
+    const float* xy = index->xy;
+    hi--;
+    while (hi > lo) {
+        // Median of three as the pivot keeps sorted input linear
+        int mid = lo + (hi - lo) / 2;
+        if (xy[2 * mid + axis] < xy[2 * lo + axis]) {
+            swap_slots(index, mid, lo);
+        }
+        if (xy[2 * hi + axis] < xy[2 * lo + axis]) {
+            swap_slots(index, hi, lo);
+        }
+        if (xy[2 * hi + axis] < xy[2 * mid + axis]) {
+            swap_slots(index, hi, mid);
+        }
+        float pivot = xy[2 * mid + axis];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (xy[2 * i + axis] < pivot) {
+                i++;
+            }
+            while (xy[2 * j + axis] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                swap_slots(index, i++, j--);
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+// Function to build the subtree over [lo, hi), split across its wider extent
+static void build_range(PointIndex* index, int lo, int hi)
+{
+    while (hi > lo) {
+        float min_x = FLT_MAX, max_x = -FLT_MAX, min_y = FLT_MAX, max_y = -FLT_MAX;
+        for (int i = lo; i < hi; i++) {
+            float x = index->xy[2 * i], y = index->xy[2 * i + 1];
+            min_x = x < min_x ? x : min_x;
+            max_x = x > max_x ? x : max_x;
+            min_y = y < min_y ? y : min_y;
+            max_y = y > max_y ? y : max_y;
+        }
+        int axis = (max_y - min_y > max_x - min_x);
+        int mid = lo + (hi - lo) / 2;
+        select_rank(index, lo, hi, mid, axis);
+        index->axis[mid] = (unsigned char)axis;
+        index->live[mid] = hi - lo;
+        build_range(index, lo, mid);
+        lo = mid + 1;  // The right half continues the loop instead of recursing
+    }
+}
+
+// Function to build the tree over a point set
+PointIndex* point_index_build(const float* xy, int num_points)
+{
+    PointIndex* index = (PointIndex*) calloc(1, sizeof(PointIndex));
+    if (index == NULL || num_points < 0) {
+        free(index);
+        return NULL;
+    }
+    index->num_points = num_points;
+    index->xy = (float*) malloc(((size_t)num_points + 1) * 2 * sizeof(float));
+    index->ids = (int*) malloc(((size_t)num_points + 1) * sizeof(int));
+    index->axis = (unsigned char*) malloc((size_t)num_points + 1);
+    index->live = (int*) malloc(((size_t)num_points + 1) * sizeof(int));
+    index->slots = (int*) malloc(((size_t)num_points + 1) * sizeof(int));
+    if (!index->xy || !index->ids || !index->axis || !index->live || !index->slots) {
+        printf("Error: Could not allocate an index of %d points\n", num_points);
+        point_index_destroy(index);
+        return NULL;
+    }
+    memcpy(index->xy, xy, (size_t)num_points * 2 * sizeof(float));
+    for (int i = 0; i < num_points; i++) {
+        index->ids[i] = i;
+    }
+    build_range(index, 0, num_points);
+    for (int i = 0; i < num_points; i++) {
+        index->slots[index->ids[i]] = i;
+    }
+    return index;
+}
+
+// Function to release a tree
+void point_index_destroy(PointIndex* index)
+{
+    if (index == NULL) {
+        return;
+    }
+    free(index->xy);
+    free(index->ids);
+    free(index->axis);
+    free(index->live);
+    free(index->slots);
+    free(index);
+}
+
+// Function to search the subtree over [lo, hi) for a point nearer than *best_distance2, visiting
+// the side of each split that holds (x, y) first and the other side only if the split is near
+static void search_range(const PointIndex* index, int lo, int hi, float x, float y, int* best,
+                         float* best_distance2)
+{
+    while (hi > lo) {
+        int mid = lo + (hi - lo) / 2;
+        if (index->live[mid] == 0) {
+            return;  // Every point of this subtree was removed
+        }
+        float dx = index->xy[2 * mid] - x, dy = index->xy[2 * mid + 1] - y;
+        float distance2 = dx * dx + dy * dy;
+        if (index->ids[mid] >= 0 && distance2 < *best_distance2) {
+            *best_distance2 = distance2;
+            *best = mid;
+        }
+        float offset = index->axis[mid] ? -dy : -dx;  // query minus split coordinate
+        int near_lo = offset < 0 ? lo : mid + 1, near_hi = offset < 0 ? mid : hi;
+        search_range(index, near_lo, near_hi, x, y, best, best_distance2);
+        if (offset * offset >= *best_distance2) {
+            return;
+        }
+        lo = offset < 0 ? mid + 1 : lo;
+        hi = offset < 0 ? hi : mid;
+    }
+}
+
+// Function to find the live tree slot nearest to a point, -1 when none is left
+static int nearest_slot(const PointIndex* index, float x, float y, float* distance2)
+{
+    int best = -1;
+    float best_distance2 = FLT_MAX;
+    search_range(index, 0, index->num_points, x, y, &best, &best_distance2);
+    if (distance2) {
+        *distance2 = best_distance2;
+    }
+    return best;
+}
+
+// Function to find the point nearest to a query
+int point_index_nearest(const PointIndex* index, float x, float y, float* distance2)
+{
+    int slot = nearest_slot(index, x, y, distance2);
+    return slot < 0 ? -1 : index->ids[slot];
+}
+
+// Function to answer many nearest-point queries
+void point_index_nearest_all(const PointIndex* index, const float* queries_xy, int count, int* nearest,
+                             float* distance2)
+{
+    // Queries only read the tree, so they split freely across threads
+    #pragma omp parallel for schedule(static, 256)
+    for (int i = 0; i < count; i++) {
+        float d2;
+        nearest[i] = point_index_nearest(index, queries_xy[2 * i], queries_xy[2 * i + 1], &d2);
+        if (distance2) {
+            distance2[i] = d2;
+        }
+    }
+}
+
+// Function to remove a point: its slot is marked and every subtree on the way to it counts one less
+void point_index_remove(PointIndex* index, int id)
+{
+    int slot = index->slots[id];
+    if (index->ids[slot] < 0) {
+        return;  // Already removed
+    }
+    index->ids[slot] = -1;
+    int lo = 0, hi = index->num_points;
+    for (;;) {
+        int mid = lo + (hi - lo) / 2;
+        index->live[mid]--;
+        if (mid == slot) {
+            break;
+        }
+        if (slot < mid) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+}
+
+// Function to order match candidates by distance
+static int compare_match_order(const void* a, const void* b)
+{
+    const MatchOrder* first = (const MatchOrder*) a;
+    const MatchOrder* second = (const MatchOrder*) b;
+    if (first->distance2 != second->distance2) {
+        return first->distance2 < second->distance2 ? -1 : 1;
+    }
+    return first->source - second->source;
+}
+
+// Function to pair every source point with its own target point
+int point_match_unique(const float* source_xy, int num_source, const float* target_xy, int num_target, int* match)
+{
+    if (num_source > num_target) {
+        printf("Error: Cannot match %d points one-to-one with %d\n", num_source, num_target);
+        return -1;
+    }
+    PointIndex* index = point_index_build(target_xy, num_target);
+    MatchOrder* order = (MatchOrder*) malloc(((size_t)num_source + 1) * sizeof(MatchOrder));
+    float* distance2 = (float*) malloc(((size_t)num_source + 1) * sizeof(float));
+    if (index == NULL || order == NULL || distance2 == NULL) {
+        printf("Error: Could not allocate the matching of %d points\n", num_source);
+        point_index_destroy(index);
+        free(order);
+        free(distance2);
+        return -1;
+    }
+
+    // The unconstrained nearest targets, found in parallel, decide who chooses first
+    point_index_nearest_all(index, source_xy, num_source, match, distance2);
+    for (int i = 0; i < num_source; i++) {
+        order[i].distance2 = distance2[i];
+        order[i].source = i;
+    }
+    qsort(order, num_source, sizeof(MatchOrder), compare_match_order);
+
+    // Then every source point in turn takes the nearest target still free
+    for (int k = 0; k < num_source; k++) {
+        int i = order[k].source;
+        int target = match[i];
+        if (index->ids[index->slots[target]] < 0) {
+            target = point_index_nearest(index, source_xy[2 * i], source_xy[2 * i + 1], NULL);
+        }
+        match[i] = target;
+        point_index_remove(index, target);
+    }
+    point_index_destroy(index);
+    free(order);
+    free(distance2);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef POINT_INDEX_H
+#define POINT_INDEX_H
+
+// Define a 2-d tree over a point set, stored implicitly: the points are reordered so that every
+// range [lo, hi) is a subtree whose split point sits at its middle, (lo + hi) / 2, with the
+// smaller coordinates on the left. Points can be removed, which one-to-one matching relies on
+typedef struct {
+    int num_points;
+    float* xy;              // points in tree order, interleaved x,y
+    int* ids;               // index of every tree slot in the input
+    unsigned char* axis;    // split axis of the subtree centred on each slot, 0 = x, 1 = y
+    int* live;              // points not yet removed in the subtree centred on each slot
+    int* slots;             // tree slot of every input index
+} PointIndex;
+
+// Build the tree over num_points interleaved x,y points (O(n log n)). Returns NULL on failure
+PointIndex* point_index_build(const float* xy, int num_points);
+
+// Release a tree
+void point_index_destroy(PointIndex* index);
+
+// Find the point nearest to (x, y) that has not been removed. Returns its input index (and its
+// squared distance when distance2 is not NULL), or -1 when no point is left
+int point_index_nearest(const PointIndex* index, float x, float y, float* distance2);
+
+// Answer count nearest-point queries (interleaved x,y) at once, in parallel when built with
+// OpenMP: nearest[i] receives the input index, distance2 (when not NULL) the squared distance
+void point_index_nearest_all(const PointIndex* index, const float* queries_xy, int count, int* nearest,
+                             float* distance2);
+
+// Remove the point with the given input index from later queries
+void point_index_remove(PointIndex* index, int id);
+
+// Pair every source point with a different target point (num_source <= num_target): the pairs
+// that are closest to begin with are settled first, and each source point then takes the nearest
+// target no earlier point has taken. A greedy assignment, not the optimal one, in
+// O(n log n) for well-spread points. match[i] receives the target index of source point i.
+// Returns 0 on success and -1 on failure
+int point_match_unique(const float* source_xy, int num_source, const float* target_xy, int num_target, int* match);
+
+#endif
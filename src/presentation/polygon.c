@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "polygon.h"
+
+// Function to round a vertex count up to whole vectors
+int polygon_padded(int num_vertices)
+{
+    return (num_vertices + POLYGON_LANES - 1) / POLYGON_LANES * POLYGON_LANES;
+}
+
+// Function to allocate both coordinate arrays in one aligned block, y right after the padded x
+int polygon_init(Polygon* polygon, Arena* arena, int num_vertices)
+{
+    int capacity = polygon_padded(num_vertices > 0 ? num_vertices : 1);
+    size_t bytes = (size_t)capacity * 2 * sizeof(float);  // A multiple of POLYGON_ALIGN
+    float* block = arena ? (float*) arena_alloc(arena, bytes) : (float*) aligned_alloc(POLYGON_ALIGN, bytes);
+    if (block == NULL) {
+        printf("Error: Could not allocate a polygon of %d vertices\n", num_vertices);
+        return -1;
+    }
+    if (arena == NULL) {
+        memset(block, 0, bytes);
+    }
+    polygon->num_vertices = num_vertices;
+    polygon->capacity = capacity;
+    polygon->x = block;
+    polygon->y = block + capacity;
+    polygon->arena = arena;
+    return 0;
+}
+
+// Function to release the coordinate block of a heap polygon
+void polygon_free(Polygon* polygon)
+{
+    if (polygon->arena == NULL) {
+        free(polygon->x);
+    }
+    polygon->x = polygon->y = NULL;
+    polygon->num_vertices = polygon->capacity = 0;
+}
+
+// Function to split interleaved points into the two coordinate arrays
+void polygon_load_xy(Polygon* polygon, const float* xy)
+{
+    for (int i = 0; i < polygon->num_vertices; i++) {
+        polygon->x[i] = xy[2 * i];
+        polygon->y[i] = xy[2 * i + 1];
+    }
+}
+
+// Function to interleave the two coordinate arrays into x,y points
+void polygon_store_xy(const Polygon* polygon, float* xy)
+{
+    for (int i = 0; i < polygon->num_vertices; i++) {
+        xy[2 * i] = polygon->x[i];
+        xy[2 * i + 1] = polygon->y[i];
+    }
+}
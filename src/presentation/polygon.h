@@ -0,0 +1,38 @@
+#ifndef POLYGON_H
+#define POLYGON_H
+
+#include "arena.h"
+
+#define POLYGON_ALIGN 64    // Both coordinate arrays start on a cache line
+#define POLYGON_LANES 16    // ... and hold a multiple of this many floats (one 512-bit vector)
+
+// Define an outline as separate x[] and y[] arrays (structure of arrays), so a kernel loads
+// POLYGON_LANES consecutive coordinates of one axis with a single aligned vector load. Both arrays
+// have room for capacity vertices; entries past num_vertices are padding that kernels may
+// compute into but that nothing reads back
+typedef struct {
+    int num_vertices;
+    int capacity;           // num_vertices rounded up to POLYGON_LANES
+    float* x;
+    float* y;
+    Arena* arena;           // owner of the storage, NULL when it came from the heap
+} Polygon;
+
+// Number of floats a coordinate array of num_vertices vertices takes, padding included
+int polygon_padded(int num_vertices);
+
+// Allocate a polygon of num_vertices vertices, all zero, from an arena (the heap when arena is
+// NULL). Returns 0 on success and -1 on failure
+int polygon_init(Polygon* polygon, Arena* arena, int num_vertices);
+
+// Release a heap polygon (an arena polygon goes with its arena)
+void polygon_free(Polygon* polygon);
+
+// Fill the polygon from num_vertices interleaved x,y points
+void polygon_load_xy(Polygon* polygon, const float* xy);
+
+// Interleaved x,y view of the polygon for serialization and the Python side: writes
+// num_vertices points into xy
+void polygon_store_xy(const Polygon* polygon, float* xy);
+
+#endif
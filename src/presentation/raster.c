@@ -0,0 +1,454 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raster.h"
+
+// Function to allocate the pixel buffer for a canvas of the given size
+int framebuffer_init(Framebuffer* fb, int width, int height)
+{
+    fb->width = width;
+    fb->height = height;
+    fb->pixels = (unsigned char*) malloc((size_t)width * height * 4);
+    fb->crossings = NULL;
+    fb->crossings_capacity = 0;
+    if (fb->pixels == NULL) {
+        printf("Error: Could not allocate a %dx%d framebuffer\n", width, height);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to release the memory owned by a framebuffer
+void framebuffer_free(Framebuffer* fb)
+{
+    free(fb->pixels);
+    free(fb->crossings);
+    fb->pixels = NULL;
+    fb->crossings = NULL;
+    fb->crossings_capacity = 0;
+}
+
+// Function to paint the whole canvas with one color
+void framebuffer_clear(Framebuffer* fb, Color color)
+{
+    size_t num_pixels = (size_t)fb->width * fb->height;
+    unsigned char* p = fb->pixels;
+    for (size_t i = 0; i < num_pixels; i++) {
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+        p[3] = color.a;
+        p += 4;
+    }
+}
+
+// Comparison function for qsort on the scanline crossings
+static int compare_floats(const void* a, const void* b)
+{
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Function to sort the crossings of one scanline (insertion sort for the common short case)
+static void sort_crossings(float* values, int count)
+{
+    if (count > 32) {
+        qsort(values, count, sizeof(float), compare_floats);
+        return;
+    }
+    for (int i = 1; i < count; i++) {
+        float v = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+}
+
+// Function to composite one color over another ("source over", in sRGB like SVG renderers)
+Color color_over(Color top, Color bottom)
+{
+    if (top.a == 255) {
+        return top;
+    }
+    int a = top.a;
+    Color result = {
+        (unsigned char)((top.r * a + bottom.r * (255 - a) + 127) / 255),
+        (unsigned char)((top.g * a + bottom.g * (255 - a) + 127) / 255),
+        (unsigned char)((top.b * a + bottom.b * (255 - a) + 127) / 255),
+        (unsigned char)(a + (bottom.a * (255 - a) + 127) / 255)
+    };
+    return result;
+}
+
+// Function to paint the pixels [col_start, col_end] of one row, blending translucent colors
+static void fill_span(unsigned char* line, int col_start, int col_end, Color color)
+{
+    if (color.a == 0) {
+        return;
+    }
+    for (int col = col_start; col <= col_end; col++) {
+        unsigned char* p = line + col * 4;
+        Color below = { p[0], p[1], p[2], p[3] };
+        Color c = color_over(color, below);
+        p[0] = c.r;
+        p[1] = c.g;
+        p[2] = c.b;
+        p[3] = c.a;
+    }
+}
+
+// Function to make sure the scratch buffer holds at least `count` floats
+static int reserve_crossings(Framebuffer* fb, int count)
+{
+    if (fb->crossings_capacity < count) {
+        float* grown = (float*) realloc(fb->crossings, count * sizeof(float));
+        if (grown == NULL) {
+            printf("Error: Could not allocate scanline buffer for %d values\n", count);
+            return -1;
+        }
+        fb->crossings = grown;
+        fb->crossings_capacity = count;
+    }
+    return 0;
+}
+
+// Function to presize the scanline scratch; a stroke needs two crossings per vertex
+int framebuffer_reserve(Framebuffer* fb, int num_points)
+{
+    return reserve_crossings(fb, num_points * 2);
+}
+
+// Function to fill a polygon over the whole canvas
+int raster_fill_polygon(Framebuffer* fb, const float* xs, const float* ys, int num_points, Color color)
+{
+    RasterRect canvas = { 0, 0, fb->width, fb->height };
+    return raster_fill_polygon_clipped(fb, xs, ys, num_points, color, canvas);
+}
+
+// Function to fill a polygon with the even-odd rule, one scanline at a time, inside a clip rectangle
+int raster_fill_polygon_clipped(Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                Color color, RasterRect clip)
+{
+    if (num_points < 3) {
+        return 0;  // Nothing to fill for degenerate shapes
+    }
+
+    // Make sure the scratch buffer can hold one crossing per edge
+    if (reserve_crossings(fb, num_points) == -1) {
+        return -1;
+    }
+
+    // Only the rows covered by the polygon's bounding box need to be visited
+    float min_y = ys[0], max_y = ys[0];
+    for (int i = 1; i < num_points; i++) {
+        if (ys[i] < min_y) min_y = ys[i];
+        if (ys[i] > max_y) max_y = ys[i];
+    }
+    int row_start = (int)ceilf(min_y - 0.5f);
+    int row_end = (int)floorf(max_y - 0.5f);
+    if (row_start < clip.y0) row_start = clip.y0;
+    if (row_end > clip.y1 - 1) row_end = clip.y1 - 1;
+
+    for (int row = row_start; row <= row_end; row++) {
+        float sample_y = row + 0.5f;  // Sample at the pixel center
+        int count = 0;
+
+        // Collect the x positions where the polygon edges cross this scanline
+        for (int i = 0, j = num_points - 1; i < num_points; j = i++) {
+            float y0 = ys[j], y1 = ys[i];
+            if ((y0 <= sample_y) != (y1 <= sample_y)) {
+                float x0 = xs[j], x1 = xs[i];
+                fb->crossings[count++] = x0 + (sample_y - y0) * (x1 - x0) / (y1 - y0);
+            }
+        }
+        sort_crossings(fb->crossings, count);
+
+        // Fill between each pair of crossings
+        unsigned char* line = fb->pixels + (size_t)row * fb->width * 4;
+        for (int k = 0; k + 1 < count; k += 2) {
+            int col_start = (int)ceilf(fb->crossings[k] - 0.5f);
+            int col_end = (int)floorf(fb->crossings[k + 1] - 0.5f);
+            if (col_start < clip.x0) col_start = clip.x0;
+            if (col_end > clip.x1 - 1) col_end = clip.x1 - 1;
+            fill_span(line, col_start, col_end, color);
+        }
+    }
+    return 0;
+}
+
+// Function to compute the pixel rectangle whose centers a polygon grown by `margin` can cover
+static RasterRect polygon_bounds(const Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                 float margin)
+{
+    RasterRect bounds = { 0, 0, 0, 0 };
+    if (num_points < 2) {
+        return bounds;
+    }
+    float min_x = xs[0], max_x = xs[0], min_y = ys[0], max_y = ys[0];
+    for (int i = 1; i < num_points; i++) {
+        if (xs[i] < min_x) min_x = xs[i];
+        if (xs[i] > max_x) max_x = xs[i];
+        if (ys[i] < min_y) min_y = ys[i];
+        if (ys[i] > max_y) max_y = ys[i];
+    }
+    // Same rounding as the scanline fill, so the bounds hold every pixel it can touch
+    bounds.x0 = (int)ceilf(min_x - margin - 0.5f);
+    bounds.y0 = (int)ceilf(min_y - margin - 0.5f);
+    bounds.x1 = (int)floorf(max_x + margin - 0.5f) + 1;
+    bounds.y1 = (int)floorf(max_y + margin - 0.5f) + 1;
+    if (bounds.x0 < 0) bounds.x0 = 0;
+    if (bounds.y0 < 0) bounds.y0 = 0;
+    if (bounds.x1 > fb->width) bounds.x1 = fb->width;
+    if (bounds.y1 > fb->height) bounds.y1 = fb->height;
+    if (bounds.x0 >= bounds.x1 || bounds.y0 >= bounds.y1) {
+        RasterRect empty = { 0, 0, 0, 0 };
+        return empty;
+    }
+    return bounds;
+}
+
+// Function to compute the pixel rectangle whose centers a polygon can cover
+RasterRect raster_polygon_bounds(const Framebuffer* fb, const float* xs, const float* ys, int num_points)
+{
+    if (num_points < 3) {
+        RasterRect empty = { 0, 0, 0, 0 };
+        return empty;
+    }
+    return polygon_bounds(fb, xs, ys, num_points, 0.0f);
+}
+
+// Function to compute the pixel rectangle a polygon outline of the given width can cover
+RasterRect raster_stroke_bounds(const Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                float stroke_width)
+{
+    return polygon_bounds(fb, xs, ys, num_points, stroke_width * 0.5f);
+}
+
+// Function to find where a row crosses the capsule of radius r around the segment (x0,y0)-(x1,y1);
+// the capsule is convex, so the crossing is one interval, returns 0 when the row misses it
+static int capsule_span(float x0, float y0, float x1, float y1, float r, float y, float* left, float* right)
+{
+    float lo = INFINITY, hi = -INFINITY;
+
+    // Round caps at both ends
+    float ends[2][2] = { { x0, y0 }, { x1, y1 } };
+    for (int e = 0; e < 2; e++) {
+        float dy = y - ends[e][1];
+        if (dy * dy <= r * r) {
+            float half = sqrtf(r * r - dy * dy);
+            if (ends[e][0] - half < lo) lo = ends[e][0] - half;
+            if (ends[e][0] + half > hi) hi = ends[e][0] + half;
+        }
+    }
+
+    // The body is the segment offset by r along its normal on both sides
+    float dx = x1 - x0, dy = y1 - y0;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length > 0.0f) {
+        float nx = -dy / length * r, ny = dx / length * r;
+        float qx[4] = { x0 + nx, x1 + nx, x1 - nx, x0 - nx };
+        float qy[4] = { y0 + ny, y1 + ny, y1 - ny, y0 - ny };
+        for (int i = 0, j = 3; i < 4; j = i++) {
+            if ((qy[j] <= y) != (qy[i] <= y)) {
+                float x = qx[j] + (y - qy[j]) * (qx[i] - qx[j]) / (qy[i] - qy[j]);
+                if (x < lo) lo = x;
+                if (x > hi) hi = x;
+            }
+        }
+    }
+
+    *left = lo;
+    *right = hi;
+    return lo <= hi;
+}
+
+// Function to stroke the closed outline of a polygon (round joins) inside a clip rectangle.
+// Each row collects one span per nearby edge and merges them, so overlapping edges blend once
+int raster_stroke_polygon_clipped(Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                  Color color, float stroke_width, RasterRect clip)
+{
+    if (num_points < 2 || stroke_width <= 0.0f || color.a == 0) {
+        return 0;
+    }
+    if (reserve_crossings(fb, num_points * 2) == -1) {
+        return -1;
+    }
+    float r = stroke_width * 0.5f;
+    RasterRect rows = polygon_bounds(fb, xs, ys, num_points, r);
+    if (rows.y0 < clip.y0) rows.y0 = clip.y0;
+    if (rows.y1 > clip.y1) rows.y1 = clip.y1;
+
+    for (int row = rows.y0; row < rows.y1; row++) {
+        float sample_y = row + 0.5f;  // Sample at the pixel center
+        int count = 0;
+        for (int i = 0, j = num_points - 1; i < num_points; j = i++) {
+            float top = ys[j] < ys[i] ? ys[j] : ys[i];
+            float bottom = ys[j] < ys[i] ? ys[i] : ys[j];
+            if (sample_y < top - r || sample_y > bottom + r) {
+                continue;  // This edge is too far from the row
+            }
+            float left, right;
+            if (capsule_span(xs[j], ys[j], xs[i], ys[i], r, sample_y, &left, &right)) {
+                // Insert the span keeping the list ordered by its left end
+                int k = count;
+                while (k > 0 && fb->crossings[(k - 1) * 2] > left) {
+                    fb->crossings[k * 2] = fb->crossings[(k - 1) * 2];
+                    fb->crossings[k * 2 + 1] = fb->crossings[(k - 1) * 2 + 1];
+                    k--;
+                }
+                fb->crossings[k * 2] = left;
+                fb->crossings[k * 2 + 1] = right;
+                count++;
+            }
+        }
+
+        // Merge overlapping spans and paint each merged span once
+        unsigned char* line = fb->pixels + (size_t)row * fb->width * 4;
+        int k = 0;
+        while (k < count) {
+            float left = fb->crossings[k * 2];
+            float right = fb->crossings[k * 2 + 1];
+            for (k++; k < count && fb->crossings[k * 2] <= right; k++) {
+                if (fb->crossings[k * 2 + 1] > right) right = fb->crossings[k * 2 + 1];
+            }
+            int col_start = (int)ceilf(left - 0.5f);
+            int col_end = (int)floorf(right - 0.5f);
+            if (col_start < clip.x0) col_start = clip.x0;
+            if (col_end > clip.x1 - 1) col_end = clip.x1 - 1;
+            fill_span(line, col_start, col_end, color);
+        }
+    }
+    return 0;
+}
+
+// Function to check whether a rectangle contains no pixels
+static int rect_is_empty(RasterRect rect)
+{
+    return rect.x0 >= rect.x1 || rect.y0 >= rect.y1;
+}
+
+// Function to grow a rectangle so that it also holds another one
+static RasterRect rect_union(RasterRect a, RasterRect b)
+{
+    if (rect_is_empty(a)) return b;
+    if (rect_is_empty(b)) return a;
+    RasterRect result = {
+        a.x0 < b.x0 ? a.x0 : b.x0,
+        a.y0 < b.y0 ? a.y0 : b.y0,
+        a.x1 > b.x1 ? a.x1 : b.x1,
+        a.y1 > b.y1 ? a.y1 : b.y1
+    };
+    return result;
+}
+
+// Function to intersect two rectangles
+static RasterRect rect_intersect(RasterRect a, RasterRect b)
+{
+    RasterRect result = {
+        a.x0 > b.x0 ? a.x0 : b.x0,
+        a.y0 > b.y0 ? a.y0 : b.y0,
+        a.x1 < b.x1 ? a.x1 : b.x1,
+        a.y1 < b.y1 ? a.y1 : b.y1
+    };
+    return result;
+}
+
+// Function to set up incremental rendering into a persistent framebuffer
+int dirty_renderer_init(DirtyRenderer* renderer, Framebuffer* fb, Color background, int num_elements)
+{
+    renderer->fb = fb;
+    renderer->background = background;
+    renderer->num_elements = num_elements;
+    renderer->has_previous = 0;
+    renderer->bounds = (RasterRect*) calloc(num_elements, sizeof(RasterRect));
+    if (renderer->bounds == NULL) {
+        printf("Error: Could not allocate bounds for %d elements\n", num_elements);
+        return -1;
+    }
+    RasterRect canvas = { 0, 0, fb->width, fb->height };
+    renderer->dirty = canvas;  // The first frame is drawn in full
+    return 0;
+}
+
+// Function to release the renderer's bookkeeping
+void dirty_renderer_free(DirtyRenderer* renderer)
+{
+    free(renderer->bounds);
+    renderer->bounds = NULL;
+}
+
+// Function to add an element's old and new bounds to this frame's dirty region
+void dirty_renderer_mark(DirtyRenderer* renderer, int index, const float* xs, const float* ys, int num_points,
+                         float stroke_width)
+{
+    RasterRect current = stroke_width > 0.0f ? raster_stroke_bounds(renderer->fb, xs, ys, num_points, stroke_width)
+                                             : raster_polygon_bounds(renderer->fb, xs, ys, num_points);
+    if (renderer->has_previous) {
+        RasterRect previous = renderer->bounds[index];
+        // Unchanged bounds still need a repaint: the shape inside them may have moved
+        renderer->dirty = rect_union(renderer->dirty, rect_union(previous, current));
+    }
+    renderer->bounds[index] = current;
+}
+
+// Function to erase the dirty region before the elements are redrawn
+void dirty_renderer_begin(DirtyRenderer* renderer)
+{
+    RasterRect dirty = renderer->dirty;
+    Framebuffer* fb = renderer->fb;
+    Color c = renderer->background;
+    for (int y = dirty.y0; y < dirty.y1; y++) {
+        unsigned char* p = fb->pixels + ((size_t)y * fb->width + dirty.x0) * 4;
+        for (int x = dirty.x0; x < dirty.x1; x++) {
+            p[0] = c.r;
+            p[1] = c.g;
+            p[2] = c.b;
+            p[3] = c.a;
+            p += 4;
+        }
+    }
+}
+
+// Function to redraw the part of an element that lies inside the dirty region
+int dirty_renderer_fill(DirtyRenderer* renderer, const float* xs, const float* ys, int num_points, Color color)
+{
+    if (rect_is_empty(renderer->dirty)) {
+        return 0;
+    }
+    // Elements that do not reach the dirty region are skipped without scanning
+    RasterRect clip = rect_intersect(renderer->dirty, raster_polygon_bounds(renderer->fb, xs, ys, num_points));
+    if (rect_is_empty(clip)) {
+        return 0;
+    }
+    return raster_fill_polygon_clipped(renderer->fb, xs, ys, num_points, color, clip);
+}
+
+// Function to redraw the part of an element's outline that lies inside the dirty region
+int dirty_renderer_stroke(DirtyRenderer* renderer, const float* xs, const float* ys, int num_points,
+                          Color color, float stroke_width)
+{
+    if (rect_is_empty(renderer->dirty)) {
+        return 0;
+    }
+    RasterRect clip = rect_intersect(renderer->dirty,
+                                     raster_stroke_bounds(renderer->fb, xs, ys, num_points, stroke_width));
+    if (rect_is_empty(clip)) {
+        return 0;
+    }
+    return raster_stroke_polygon_clipped(renderer->fb, xs, ys, num_points, color, stroke_width, clip);
+}
+
+// Function to close the frame and reset the dirty region for the next one
+RasterRect dirty_renderer_end(DirtyRenderer* renderer)
+{
+    RasterRect rendered = renderer->dirty;
+    RasterRect empty = { 0, 0, 0, 0 };
+    renderer->dirty = empty;
+    renderer->has_previous = 1;
+    return rendered;
+}
@@ -0,0 +1,97 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+// Define a structure to represent an 8-bit RGBA color
+typedef struct {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+} Color;
+
+// Define a structure to represent an RGBA pixel buffer the frames are drawn into
+typedef struct {
+    int width;               // canvas width in pixels
+    int height;              // canvas height in pixels
+    unsigned char* pixels;   // width * height * 4 bytes, row-major RGBA
+    float* crossings;        // scratch buffer for scanline edge crossings
+    int crossings_capacity;  // number of floats the scratch buffer can hold
+} Framebuffer;
+
+// Define a pixel rectangle [x0, x1) x [y0, y1); empty when x0 >= x1 or y0 >= y1
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} RasterRect;
+
+// Define the state that lets consecutive frames re-render only what moved
+typedef struct {
+    Framebuffer* fb;            // persistent framebuffer kept between frames
+    Color background;
+    int num_elements;           // elements drawn per frame, in paint order
+    RasterRect* bounds;         // pixel bounds of each element in the last frame
+    int has_previous;           // 0 until the first frame has been drawn
+    RasterRect dirty;           // union of previous and current bounds for this frame
+} DirtyRenderer;
+
+// Allocate a framebuffer of the given size, returns 0 on success and -1 on failure
+int framebuffer_init(Framebuffer* fb, int width, int height);
+
+// Size the scanline scratch for filling and stroking polygons of up to num_points vertices, so
+// drawing them never allocates. Returns 0 on success and -1 on failure
+int framebuffer_reserve(Framebuffer* fb, int num_points);
+
+// Release the pixel and scratch memory owned by the framebuffer
+void framebuffer_free(Framebuffer* fb);
+
+// Fill every pixel of the framebuffer with one color
+void framebuffer_clear(Framebuffer* fb, Color color);
+
+// Composite a translucent color over another
+Color color_over(Color top, Color bottom);
+
+// Fill a closed polygon (even-odd rule, sampled at pixel centers); translucent colors are blended
+int raster_fill_polygon(Framebuffer* fb, const float* xs, const float* ys, int num_points, Color color);
+
+// Same as raster_fill_polygon but only touches pixels inside the clip rectangle
+int raster_fill_polygon_clipped(Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                Color color, RasterRect clip);
+
+// Pixel bounds of the samples a polygon covers, clamped to the canvas
+RasterRect raster_polygon_bounds(const Framebuffer* fb, const float* xs, const float* ys, int num_points);
+
+// Stroke the closed outline of a polygon with round joins, only inside the clip rectangle
+int raster_stroke_polygon_clipped(Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                  Color color, float stroke_width, RasterRect clip);
+
+// Pixel bounds of the samples a polygon outline of the given width covers, clamped to the canvas
+RasterRect raster_stroke_bounds(const Framebuffer* fb, const float* xs, const float* ys, int num_points,
+                                float stroke_width);
+
+// Prepare incremental rendering of num_elements shapes into a persistent framebuffer
+int dirty_renderer_init(DirtyRenderer* renderer, Framebuffer* fb, Color background, int num_elements);
+
+// Release the per-element bounds
+void dirty_renderer_free(DirtyRenderer* renderer);
+
+// Record where element `index` is in the new frame and grow the dirty region accordingly;
+// stroke_width is the element's outline width, 0 when it is only filled
+void dirty_renderer_mark(DirtyRenderer* renderer, int index, const float* xs, const float* ys, int num_points,
+                         float stroke_width);
+
+// Clear the dirty region to the background; call after every element has been marked
+void dirty_renderer_begin(DirtyRenderer* renderer);
+
+// Redraw one element (in paint order) inside the dirty region
+int dirty_renderer_fill(DirtyRenderer* renderer, const float* xs, const float* ys, int num_points, Color color);
+
+// Redraw one element's outline (after its fill) inside the dirty region
+int dirty_renderer_stroke(DirtyRenderer* renderer, const float* xs, const float* ys, int num_points,
+                          Color color, float stroke_width);
+
+// Finish the frame and return the region that was re-rendered
+RasterRect dirty_renderer_end(DirtyRenderer* renderer);
+
+#endif
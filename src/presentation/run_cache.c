@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/fs.h>    // FICLONE
+#endif
+#include "run_cache.h"
+
+#define COMPLETE_MARKER "COMPLETE"   // Written last, so only finished runs are ever reused
+
+// Define the size and last use of one cache entry, for LRU eviction
+typedef struct {
+    char name[256];
+    long long bytes;
+    time_t last_used;
+} CacheEntryInfo;
+
+// Function to start a key with two different FNV-1a offset bases
+void run_key_init(RunKey* key)
+{
+    key->lanes[0] = 0xcbf29ce484222325ULL;
+    key->lanes[1] = 0x84222325cbf29ce4ULL;
+}
+
+// Function to mix bytes into both lanes of the key
+void run_key_add(RunKey* key, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*) data;
+    uint64_t a = key->lanes[0], b = key->lanes[1];
+    for (size_t i = 0; i < length; i++) {
+        a = (a ^ bytes[i]) * 0x100000001b3ULL;
+        b = (b ^ bytes[i]) * 0x100000001b3ULL;
+        b ^= b >> 29;  // Extra mixing keeps the second lane independent of the first
+    }
+    key->lanes[0] = a;
+    key->lanes[1] = b;
+}
+
+// Function to mix one formatted parameter (and a terminator, so fields cannot run together)
+void run_key_add_param(RunKey* key, const char* format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) {
+        length = 0;
+    } else if ((size_t)length >= sizeof(text)) {
+        length = sizeof(text) - 1;
+    }
+    run_key_add(key, text, length + 1);
+}
+
+// Function to mix a file's bytes into the key
+int run_key_add_file(RunKey* key, const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Error: Could not open %s for hashing\n", path);
+        return -1;
+    }
+    unsigned char buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        run_key_add(key, buffer, count);
+    }
+    int failed = ferror(file);
+    fclose(file);
+    run_key_add_param(key, "file-end");
+    return failed ? -1 : 0;
+}
+
+// Function to write a key as hex digits
+void run_key_format(const RunKey* key, char text[33])
+{
+    snprintf(text, 33, "%016llx%016llx", (unsigned long long)key->lanes[0], (unsigned long long)key->lanes[1]);
+}
+
+// Function to create a directory unless it exists already
+static int make_directory(const char* path)
+{
+    if (mkdir(path, 0700) == -1 && errno != EEXIST) {
+        printf("Error: Could not create directory %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// Function to open the cache entry that belongs to a key
+int run_cache_open(RunCache* cache, const char* root, const RunKey* key, long long max_bytes)
+{
+    memset(cache, 0, sizeof(RunCache));
+    snprintf(cache->root, sizeof(cache->root), "%s", root);
+    run_key_format(key, cache->key);
+    snprintf(cache->entry, sizeof(cache->entry), "%s/%s", cache->root, cache->key);
+    cache->max_bytes = max_bytes;
+    if (make_directory(cache->root) == -1) {
+        return -1;
+    }
+
+    char marker[700];
+    snprintf(marker, sizeof(marker), "%s/%s", cache->entry, COMPLETE_MARKER);
+    struct stat st;
+    if (stat(marker, &st) == 0) {
+        cache->hit = 1;
+        return 0;
+    }
+    cache->partial = (stat(cache->entry, &st) == 0);
+    return make_directory(cache->entry);
+}
+
+// Function to build the path of a frame inside the entry
+void run_cache_frame_path(const RunCache* cache, const char* name, char* path, size_t size)
+{
+    snprintf(path, size, "%s/%s", cache->entry, name);
+}
+
+// Function to check whether a frame was already written by an interrupted run. The frame writer
+// renames a frame into place only once it is complete (a cut-off frame stays a hidden temporary
+// file), so a frame under its own name is a finished one
+int run_cache_has_frame(const RunCache* cache, const char* name)
+{
+    if (!cache->partial) {
+        return 0;
+    }
+    char path[1024];
+    run_cache_frame_path(cache, name, path, sizeof(path));
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+// Function to measure an entry: total bytes, and when it was last used
+static int measure_entry(const char* root, const char* name, CacheEntryInfo* info)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+    snprintf(info->name, sizeof(info->name), "%s", name);
+    info->bytes = 0;
+    time_t newest_frame = 0, marker_time = 0;
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL) {
+        char file[1400];
+        struct stat st;
+        snprintf(file, sizeof(file), "%s/%s", path, item->d_name);
+        if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0 || stat(file, &st) == -1) {
+            continue;
+        }
+        info->bytes += (long long)st.st_blocks * 512;  // What the entry really occupies on disk
+        if (strcmp(item->d_name, COMPLETE_MARKER) == 0) {
+            marker_time = st.st_mtime;
+        } else if (st.st_mtime > newest_frame) {
+            newest_frame = st.st_mtime;
+        }
+    }
+    closedir(dir);
+    // The marker is touched on every use; unfinished entries age from their newest frame
+    info->last_used = marker_time ? marker_time : newest_frame;
+    return 0;
+}
+
+// Function to delete an entry and everything in it
+static void remove_entry(const char* root, const char* name)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL) {
+        if (strcmp(item->d_name, ".") != 0 && strcmp(item->d_name, "..") != 0) {  // Leftover temporaries too
+            char file[1400];
+            snprintf(file, sizeof(file), "%s/%s", path, item->d_name);
+            unlink(file);
+        }
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+// Comparison function for qsort: least recently used first
+static int compare_last_used(const void* a, const void* b)
+{
+    time_t ta = ((const CacheEntryInfo*)a)->last_used;
+    time_t tb = ((const CacheEntryInfo*)b)->last_used;
+    return (ta > tb) - (ta < tb);
+}
+
+// Function to evict the least recently used entries until the cache fits its budget
+static void evict_entries(const RunCache* cache)
+{
+    DIR* dir = opendir(cache->root);
+    if (dir == NULL) {
+        return;
+    }
+    int count = 0, capacity = 16;
+    CacheEntryInfo* entries = (CacheEntryInfo*) malloc(capacity * sizeof(CacheEntryInfo));
+    long long total = 0;
+    struct dirent* item;
+    while (entries && (item = readdir(dir)) != NULL) {
+        if (item->d_name[0] == '.') {
+            continue;
+        }
+        if (count == capacity) {
+            CacheEntryInfo* grown = (CacheEntryInfo*) realloc(entries, capacity * 2 * sizeof(CacheEntryInfo));
+            if (grown == NULL) {
+                break;
+            }
+            entries = grown;
+            capacity *= 2;
+        }
+        if (measure_entry(cache->root, item->d_name, &entries[count]) == 0) {
+            total += entries[count].bytes;
+            count++;
+        }
+    }
+    closedir(dir);
+    if (entries == NULL) {
+        return;
+    }
+
+    qsort(entries, count, sizeof(CacheEntryInfo), compare_last_used);
+    for (int i = 0; i < count && total > cache->max_bytes; i++) {
+        if (strcmp(entries[i].name, cache->key) == 0) {
+            continue;  // Never evict the run that was just produced
+        }
+        printf("Cache: evicting %s (%lld bytes)\n", entries[i].name, entries[i].bytes);
+        remove_entry(cache->root, entries[i].name);
+        total -= entries[i].bytes;
+    }
+    free(entries);
+}
+
+// Function to mark the entry as complete, then trim the cache
+int run_cache_commit(RunCache* cache)
+{
+    char marker[700];
+    snprintf(marker, sizeof(marker), "%s/%s", cache->entry, COMPLETE_MARKER);
+    FILE* file = fopen(marker, "w");
+    if (file == NULL) {
+        printf("Error: Could not complete cache entry %s\n", cache->entry);
+        return -1;
+    }
+    fprintf(file, "%s\n", cache->key);
+    if (fclose(file) != 0) {
+        // A marker that never reached the disk must not make the entry look complete
+        printf("Error: Could not complete cache entry %s\n", cache->entry);
+        unlink(marker);
+        return -1;
+    }
+    cache->hit = 1;
+    evict_entries(cache);
+    return 0;
+}
+
+// Function to copy a file, sharing its blocks (a reflink) where the file system can
+static int copy_file(const char* from, const char* to)
+{
+    FILE* in = fopen(from, "rb");
+    FILE* out = in ? fopen(to, "wb") : NULL;
+    if (out == NULL) {
+        if (in) {
+            fclose(in);
+        }
+        printf("Error: Could not copy %s to %s\n", from, to);
+        return -1;
+    }
+#ifdef FICLONE
+    if (ioctl(fileno(out), FICLONE, fileno(in)) == 0) {
+        fclose(in);
+        return fclose(out) == 0 ? 0 : -1;
+    }
+#endif
+    char buffer[65536];
+    size_t count;
+    int status = 0;
+    while ((count = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, count, out) != count) {
+            status = -1;
+            break;
+        }
+    }
+    fclose(in);
+    if (fclose(out) != 0 || status == -1) {
+        printf("Error: Could not copy %s to %s\n", from, to);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to place every cached frame in the output directory
+int run_cache_export(RunCache* cache, const char* output_dir)
+{
+    if (make_directory(output_dir) == -1) {
+        return -1;
+    }
+    DIR* dir = opendir(cache->entry);
+    if (dir == NULL) {
+        printf("Error: Could not read cache entry %s\n", cache->entry);
+        return -1;
+    }
+    int status = 0, count = 0;
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL && status == 0) {
+        if (item->d_name[0] == '.' || strcmp(item->d_name, COMPLETE_MARKER) == 0) {
+            continue;
+        }
+        char from[1400], to[1400];
+        snprintf(from, sizeof(from), "%s/%s", cache->entry, item->d_name);
+        snprintf(to, sizeof(to), "%s/%s", output_dir, item->d_name);
+        // A copy, not a hard link: whatever later writes to the output directory must never
+        // reach the cached frames
+        unlink(to);
+        status = copy_file(from, to);
+        count++;
+    }
+    closedir(dir);
+
+    // Using an entry makes it the most recently used one
+    char marker[700];
+    snprintf(marker, sizeof(marker), "%s/%s", cache->entry, COMPLETE_MARKER);
+    utime(marker, NULL);
+    if (status == 0) {
+        printf("Cache: %d frames of run %s placed in %s\n", count, cache->key, output_dir);
+    }
+    return status;
+}
@@ -0,0 +1,54 @@
+#ifndef RUN_CACHE_H
+#define RUN_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Define a running 128-bit content hash (two independent 64-bit FNV-1a lanes)
+typedef struct {
+    uint64_t lanes[2];
+} RunKey;
+
+// Define one cache entry: a directory of finished frames named after the run's key
+typedef struct {
+    char root[512];          // cache directory shared by all runs
+    char entry[600];         // root/<key>
+    char key[33];            // hex digest of the inputs and parameters
+    long long max_bytes;     // total size the cache may keep after eviction
+    int hit;                 // 1 when a complete entry for this key already exists
+    int partial;             // 1 when an interrupted run left some frames behind
+} RunCache;
+
+// Start a key; everything that changes the output must be added to it
+void run_key_init(RunKey* key);
+
+// Mix raw bytes into the key
+void run_key_add(RunKey* key, const void* data, size_t length);
+
+// Mix a labelled parameter into the key, e.g. run_key_add_param(&key, "frames=%d", n)
+void run_key_add_param(RunKey* key, const char* format, ...);
+
+// Mix the whole contents of a file into the key, returns 0 on success and -1 on failure
+int run_key_add_file(RunKey* key, const char* path);
+
+// Write the key as 32 hex digits (and a terminator)
+void run_key_format(const RunKey* key, char text[33]);
+
+// Open (creating if needed) the entry for a finished key under the cache root
+int run_cache_open(RunCache* cache, const char* root, const RunKey* key, long long max_bytes);
+
+// Path of one frame file inside the entry
+void run_cache_frame_path(const RunCache* cache, const char* name, char* path, size_t size);
+
+// Whether an interrupted run already finished this frame in the entry (frames are renamed into
+// place once complete, so a cut-off frame does not count)
+int run_cache_has_frame(const RunCache* cache, const char* name);
+
+// Mark the entry complete and evict least recently used entries beyond max_bytes
+int run_cache_commit(RunCache* cache);
+
+// Copy every frame of the entry into output_dir (a reflink where the file system supports it)
+// and refresh its LRU time
+int run_cache_export(RunCache* cache, const char* output_dir);
+
+#endif
@@ -5,7 +5,7 @@ echo "Project 1: Team Image Tweening"
 sleep 3
 echo "Compiling and running the sequential version..."
 sleep 5
-gcc -o morph_animation_s circle-to-triangle.c $(xml2-config --cflags --libs) -lm
+gcc -o morph_animation_s circle-to-triangle.c morph_engine.c svg_scan.c chunked_morph.c shard.c paint.c easing.c svg_format.c frame_writer.c run_cache.c raster.c anim_writer.c stream_writer.c simplify.c curve_fit.c arena.c polygon.c spsc_ring.c pipeline.c logger.c -lz -lm -lpthread
 if [ $? -eq 0 ]; then
     echo "Sequential version compiled successfully. Running..."
 	sleep 4
@@ -21,7 +21,7 @@ fi
 # Compile and execute the parallel version
 echo "Compiling and running the parallel version..."
 sleep 4
-gcc -o morph_animation_p morph_c_to_tr_para_2.c -fopenmp $(xml2-config --cflags --libs) -lm
+gcc -o morph_animation_p morph_c_to_tr_para_2.c svg_format.c -fopenmp $(xml2-config --cflags --libs) -lm
 if [ $? -eq 0 ]; then
     echo "Parallel version compiled successfully. Running..."
 	sleep 2
@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>      // CRC-32, and gzread reads plain and compressed frames alike
+#include "shard.h"
+
+#define MANIFEST_HEADER "morph-shard v1"
+
+// Function to parse "i/N"
+int shard_parse(const char* text, ShardSpec* shard)
+{
+    char extra;
+    if (sscanf(text, "%d/%d%c", &shard->index, &shard->count, &extra) != 2 ||
+        shard->count < 1 || shard->index < 0 || shard->index >= shard->count) {
+        printf("Error: --shard expects i/N with 0 <= i < N, got '%s'\n", text);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to compute a shard's frame interval; the same split is recomputed when merging
+void shard_range(const ShardSpec* shard, int total_frames, int* first, int* end)
+{
+    *first = (int)((long long)total_frames * shard->index / shard->count);
+    *end = (int)((long long)total_frames * (shard->index + 1) / shard->count);
+}
+
+// Function to build the path of a shard's stream part
+void shard_part_path(const char* stream_path, const ShardSpec* shard, char* path, size_t size)
+{
+    snprintf(path, size, "%s.part-%d-of-%d", stream_path, shard->index, shard->count);
+}
+
+// Function to build the path of a shard's manifest
+static void manifest_path(const char* directory, int index, int count, char* path, size_t size)
+{
+    snprintf(path, size, "%s/shard_%d_of_%d.txt", directory, index, count);
+}
+
+// Function to start a shard manifest
+int shard_manifest_open(ShardManifest* manifest, const char* directory, const ShardSpec* shard,
+                        const char* key, int total_frames, int first, int end, const char* output)
+{
+    memset(manifest, 0, sizeof(ShardManifest));
+    if (mkdir(directory, 0700) == -1 && errno != EEXIST) {
+        printf("Error: Could not create directory %s\n", directory);
+        return -1;
+    }
+    manifest_path(directory, shard->index, shard->count, manifest->final_path, sizeof(manifest->final_path));
+    snprintf(manifest->path, sizeof(manifest->path), "%s.tmp", manifest->final_path);
+    manifest->file = fopen(manifest->path, "w");
+    if (manifest->file == NULL) {
+        printf("Error: Could not open file %s for writing\n", manifest->path);
+        return -1;
+    }
+    fprintf(manifest->file, "%s\nkey %s\nshard %d %d\nframes %d\nrange %d %d\noutput %s\n", MANIFEST_HEADER,
+            key, shard->index, shard->count, total_frames, first, end, output);
+    return 0;
+}
+
+// Function to record one frame document
+void shard_manifest_frame(ShardManifest* manifest, int frame, const void* data, size_t length)
+{
+    unsigned long crc = crc32(0L, (const Bytef*) data, (uInt)length);
+    fprintf(manifest->file, "frame %d %zu %08lx\n", frame, length, crc);
+}
+
+// Function to finish a manifest; only a renamed manifest counts as a finished shard
+int shard_manifest_close(ShardManifest* manifest)
+{
+    fprintf(manifest->file, "end\n");
+    if (fclose(manifest->file) != 0 || rename(manifest->path, manifest->final_path) == -1) {
+        printf("Error: Could not write file %s\n", manifest->final_path);
+        return -1;
+    }
+    printf("Shard manifest %s written\n", manifest->final_path);
+    return 0;
+}
+
+// Function to read `length` bytes of a frame and compare them with the recorded CRC
+static int verify_frame(gzFile input, size_t length, unsigned long expected, unsigned char** buffer,
+                        size_t* capacity)
+{
+    if (*capacity < length + 1) {
+        unsigned char* grown = (unsigned char*) realloc(*buffer, length + 1);
+        if (grown == NULL) {
+            return -1;
+        }
+        *buffer = grown;
+        *capacity = length + 1;
+    }
+    if (gzread(input, *buffer, (unsigned)length) != (int)length) {
+        return -1;
+    }
+    return crc32(0L, *buffer, (uInt)length) == expected ? 0 : -1;
+}
+
+// Function to check one shard: its manifest, and every frame it recorded
+static int verify_shard(const char* directory, int index, int num_shards, const char* key, int total_frames,
+                        const char* extension, const char* stream_path, unsigned char** buffer, size_t* capacity)
+{
+    char path[1024];
+    manifest_path(directory, index, num_shards, path, sizeof(path));
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Merge: shard %d/%d has not finished (no %s)\n", index, num_shards, path);
+        return -1;
+    }
+
+    ShardSpec shard = { index, num_shards };
+    int first, end;
+    shard_range(&shard, total_frames, &first, &end);
+    char line[256], text[128];
+    int values[3], status = 0;
+    const char* output = stream_path ? "stream" : extension;
+    if (!fgets(line, sizeof(line), file) || strncmp(line, MANIFEST_HEADER, strlen(MANIFEST_HEADER)) != 0 ||
+        !fgets(line, sizeof(line), file) || sscanf(line, "key %127s", text) != 1 || strcmp(text, key) != 0) {
+        printf("Merge: %s belongs to a different run (inputs or options differ)\n", path);
+        status = -1;
+    } else if (!fgets(line, sizeof(line), file) || sscanf(line, "shard %d %d", &values[0], &values[1]) != 2 ||
+               values[0] != index || values[1] != num_shards ||
+               !fgets(line, sizeof(line), file) || sscanf(line, "frames %d", &values[2]) != 1 ||
+               values[2] != total_frames ||
+               !fgets(line, sizeof(line), file) || sscanf(line, "range %d %d", &values[0], &values[1]) != 2 ||
+               values[0] != first || values[1] != end ||
+               !fgets(line, sizeof(line), file) || sscanf(line, "output %127s", text) != 1 ||
+               strcmp(text, output) != 0) {
+        printf("Merge: %s does not describe shard %d/%d of this run\n", path, index, num_shards);
+        status = -1;
+    }
+
+    // A stream shard's frames are consecutive gzip members of its part; gzread walks them in order
+    gzFile input = NULL;
+    char frame_file[1024];
+    if (status == 0 && stream_path) {
+        shard_part_path(stream_path, &shard, frame_file, sizeof(frame_file));
+        if ((input = gzopen(frame_file, "rb")) == NULL) {
+            printf("Merge: stream part %s is missing\n", frame_file);
+            status = -1;
+        }
+    }
+    int expected = first, finished = 0;
+    while (status == 0 && fgets(line, sizeof(line), file)) {
+        int frame;
+        size_t length;
+        unsigned long crc;
+        if (strcmp(line, "end\n") == 0) {
+            finished = 1;
+            break;
+        }
+        if (sscanf(line, "frame %d %zu %lx", &frame, &length, &crc) != 3 || frame != expected) {
+            printf("Merge: %s is damaged near frame %d\n", path, expected);
+            status = -1;
+            break;
+        }
+        if (!stream_path) {
+            snprintf(frame_file, sizeof(frame_file), "%s/frame_%03d.%s", directory, frame, extension);
+            if ((input = gzopen(frame_file, "rb")) == NULL) {
+                printf("Merge: frame %d is missing (%s)\n", frame, frame_file);
+                status = -1;
+                break;
+            }
+        }
+        unsigned char probe;
+        int valid = verify_frame(input, length, crc, buffer, capacity) == 0 &&
+                    (stream_path || gzread(input, &probe, 1) == 0);  // A frame file holds nothing else
+        if (!stream_path) {
+            gzclose(input);
+            input = NULL;
+        }
+        if (!valid) {
+            printf("Merge: frame %d does not match its checksum\n", frame);
+            status = -1;
+        }
+        expected++;
+    }
+    if (input) {
+        gzclose(input);
+    }
+    fclose(file);
+    if (status == 0 && (!finished || expected != end)) {
+        printf("Merge: %s is incomplete (%d of %d frames)\n", path, expected - first, end - first);
+        status = -1;
+    }
+    return status;
+}
+
+// Function to append one file to another
+static int append_file(FILE* out, const char* path)
+{
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) {
+        return -1;
+    }
+    char buffer[65536];
+    size_t count;
+    int status = 0;
+    while ((count = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, count, out) != count) {
+            status = -1;
+            break;
+        }
+    }
+    if (ferror(in)) {
+        status = -1;
+    }
+    fclose(in);
+    return status;
+}
+
+// Function to verify every shard of a run and assemble a sharded stream
+int shard_merge(const char* directory, int num_shards, const char* key, int total_frames,
+                const char* extension, const char* stream_path)
+{
+    unsigned char* buffer = NULL;
+    size_t capacity = 0;
+    int failed = 0;
+    for (int s = 0; s < num_shards; s++) {
+        // Every shard is checked, so one run reports everything that needs redoing
+        if (verify_shard(directory, s, num_shards, key, total_frames, extension, stream_path,
+                         &buffer, &capacity) == -1) {
+            failed++;
+        }
+    }
+    free(buffer);
+    if (failed) {
+        printf("Merge: %d of %d shards are missing or invalid\n", failed, num_shards);
+        return -1;
+    }
+
+    // Concatenated gzip members are themselves a valid gzip file, in shard (= frame) order
+    if (stream_path) {
+        char path[1024], part[1024];
+        snprintf(path, sizeof(path), "%s.tmp", stream_path);
+        FILE* out = fopen(path, "wb");
+        int status = (out == NULL) ? -1 : 0;
+        for (int s = 0; s < num_shards && status == 0; s++) {
+            ShardSpec shard = { s, num_shards };
+            shard_part_path(stream_path, &shard, part, sizeof(part));
+            status = append_file(out, part);
+        }
+        if (out && fclose(out) != 0) {
+            status = -1;
+        }
+        if (status == -1 || rename(path, stream_path) == -1) {
+            printf("Error: Could not assemble %s\n", stream_path);
+            unlink(path);
+            return -1;
+        }
+        for (int s = 0; s < num_shards; s++) {
+            ShardSpec shard = { s, num_shards };
+            shard_part_path(stream_path, &shard, part, sizeof(part));
+            unlink(part);
+        }
+    }
+    printf("Merge: %d shards, all %d frames verified%s%s\n", num_shards, total_frames,
+           stream_path ? ", stream written to " : "", stream_path ? stream_path : "");
+    return 0;
+}
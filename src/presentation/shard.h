@@ -0,0 +1,47 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Define which part of the frame range one process computes
+typedef struct {
+    int index;    // 0-based shard number
+    int count;    // total number of shards
+} ShardSpec;
+
+// Define the record a shard writes next to its frames: the run it belongs to, its frame range and
+// a length and CRC-32 per frame document, so a merge can prove the sequence complete
+typedef struct {
+    FILE* file;
+    char path[608];         // written under a temporary name...
+    char final_path[600];   // ...and renamed here once the shard has finished
+} ShardManifest;
+
+// Parse "i/N" (0 <= i < N), returns 0 on success and -1 on a malformed value
+int shard_parse(const char* text, ShardSpec* shard);
+
+// Frames [*first, *end) of total_frames belong to the shard; every frame to exactly one shard
+void shard_range(const ShardSpec* shard, int total_frames, int* first, int* end);
+
+// Path of the stream part a shard writes instead of the whole --svgz-stream file
+void shard_part_path(const char* stream_path, const ShardSpec* shard, char* path, size_t size);
+
+// Start the manifest of a shard in directory; key identifies the run (inputs and options)
+int shard_manifest_open(ShardManifest* manifest, const char* directory, const ShardSpec* shard,
+                        const char* key, int total_frames, int first, int end, const char* output);
+
+// Record one frame document
+void shard_manifest_frame(ShardManifest* manifest, int frame, const void* data, size_t length);
+
+// Finish the manifest and move it into place, returns 0 on success and -1 on failure
+int shard_manifest_close(ShardManifest* manifest);
+
+// Check that the num_shards manifests in directory belong to the run `key` and cover every frame,
+// verify every frame (in its own plain or gzip file, or in order inside a stream part) against its
+// recorded length and CRC, and for a stream concatenate the verified parts in order into stream_path.
+// Returns 0 when the run is complete and valid
+int shard_merge(const char* directory, int num_shards, const char* key, int total_frames,
+                const char* extension, const char* stream_path);
+
+#endif
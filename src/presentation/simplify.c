@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "simplify.h"
+
+#define POSITION_PINNED -1
+#define POSITION_REMOVED -2
+
+// Function to prepare empty scratch buffers
+void simplify_scratch_init(SimplifyScratch* scratch)
+{
+    scratch->capacity = 0;
+    scratch->prev = scratch->next = scratch->heap = scratch->position = NULL;
+    scratch->key = scratch->error = NULL;
+}
+
+// Function to release the scratch buffers
+void simplify_scratch_free(SimplifyScratch* scratch)
+{
+    free(scratch->prev);
+    free(scratch->next);
+    free(scratch->key);
+    free(scratch->error);
+    free(scratch->heap);
+    free(scratch->position);
+    simplify_scratch_init(scratch);
+}
+
+// Function to grow the scratch buffers to at least num_points vertices
+static int scratch_reserve(SimplifyScratch* scratch, int num_points)
+{
+    if (num_points <= scratch->capacity) {
+        return 0;
+    }
+    simplify_scratch_free(scratch);
+    scratch->prev = (int*) malloc(num_points * sizeof(int));
+    scratch->next = (int*) malloc(num_points * sizeof(int));
+    scratch->key = (float*) malloc(num_points * sizeof(float));
+    scratch->error = (float*) malloc(num_points * sizeof(float));
+    scratch->heap = (int*) malloc(num_points * sizeof(int));
+    scratch->position = (int*) malloc(num_points * sizeof(int));
+    if (!scratch->prev || !scratch->next || !scratch->key || !scratch->error || !scratch->heap ||
+        !scratch->position) {
+        printf("Error: Could not allocate simplification buffers for %d points\n", num_points);
+        simplify_scratch_free(scratch);
+        return -1;
+    }
+    scratch->capacity = num_points;
+    return 0;
+}
+
+// Function to measure the distance from a point to the segment a-b
+static float segment_distance(float px, float py, float ax, float ay, float bx, float by)
+{
+    float dx = bx - ax, dy = by - ay;
+    float length2 = dx * dx + dy * dy;
+    float s = length2 > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / length2 : 0.0f;
+    s = s < 0.0f ? 0.0f : s > 1.0f ? 1.0f : s;
+    return hypotf(px - ax - s * dx, py - ay - s * dy);
+}
+
+// Function to bound the error of removing vertex v: the segments prev-v and v-next lie within
+// v's distance of the replacing segment, and the points already removed lie within their own
+// bound of those segments
+static float removal_error(const SimplifyScratch* scratch, const float* xs, const float* ys, int v)
+{
+    int p = scratch->prev[v], n = scratch->next[v];
+    float inherited = scratch->error[p] > scratch->error[v] ? scratch->error[p] : scratch->error[v];
+    return segment_distance(xs[v], ys[v], xs[p], ys[p], xs[n], ys[n]) + inherited;
+}
+
+// Function to swap two heap slots and keep the positions in step
+static void heap_swap(SimplifyScratch* scratch, int a, int b)
+{
+    int va = scratch->heap[a], vb = scratch->heap[b];
+    scratch->heap[a] = vb;
+    scratch->heap[b] = va;
+    scratch->position[vb] = a;
+    scratch->position[va] = b;
+}
+
+// Function to restore the heap order around one slot after its key changed
+static void heap_fix(SimplifyScratch* scratch, int size, int slot)
+{
+    while (slot > 0 && scratch->key[scratch->heap[slot]] < scratch->key[scratch->heap[(slot - 1) / 2]]) {
+        heap_swap(scratch, slot, (slot - 1) / 2);
+        slot = (slot - 1) / 2;
+    }
+    for (;;) {
+        int smallest = slot, left = 2 * slot + 1, right = left + 1;
+        if (left < size && scratch->key[scratch->heap[left]] < scratch->key[scratch->heap[smallest]]) {
+            smallest = left;
+        }
+        if (right < size && scratch->key[scratch->heap[right]] < scratch->key[scratch->heap[smallest]]) {
+            smallest = right;
+        }
+        if (smallest == slot) {
+            break;
+        }
+        heap_swap(scratch, slot, smallest);
+        slot = smallest;
+    }
+}
+
+// Function to simplify an outline in place within a distance tolerance
+int simplify_outline(SimplifyScratch* scratch, float* xs, float* ys, int num_points, int closed,
+                     float tolerance)
+{
+    int min_points = closed ? 3 : 2;
+    if (num_points <= min_points || tolerance <= 0.0f) {
+        return num_points;
+    }
+    if (scratch_reserve(scratch, num_points) == -1) {
+        return -1;
+    }
+
+    // Link the vertices; the end points of an open outline are pinned and never queued
+    int size = 0;
+    for (int i = 0; i < num_points; i++) {
+        scratch->prev[i] = (i == 0) ? num_points - 1 : i - 1;
+        scratch->next[i] = (i == num_points - 1) ? 0 : i + 1;
+        scratch->error[i] = 0.0f;
+        scratch->position[i] = POSITION_PINNED;
+    }
+    for (int i = 0; i < num_points; i++) {
+        if (closed || (i > 0 && i < num_points - 1)) {
+            scratch->key[i] = removal_error(scratch, xs, ys, i);
+            scratch->heap[size] = i;
+            scratch->position[i] = size++;
+        }
+    }
+    for (int slot = size / 2 - 1; slot >= 0; slot--) {
+        heap_fix(scratch, size, slot);
+    }
+
+    // Remove the least significant vertex while the bound allows, then re-rate its neighbours
+    int remaining = num_points;
+    while (size > 0 && remaining > min_points && scratch->key[scratch->heap[0]] <= tolerance) {
+        int v = scratch->heap[0];
+        heap_swap(scratch, 0, --size);
+        heap_fix(scratch, size, 0);
+        scratch->position[v] = POSITION_REMOVED;
+        remaining--;
+
+        int p = scratch->prev[v], n = scratch->next[v];
+        scratch->error[p] = scratch->key[v];
+        scratch->next[p] = n;
+        scratch->prev[n] = p;
+        if (scratch->position[p] >= 0) {
+            scratch->key[p] = removal_error(scratch, xs, ys, p);
+            heap_fix(scratch, size, scratch->position[p]);
+        }
+        if (scratch->position[n] >= 0) {
+            scratch->key[n] = removal_error(scratch, xs, ys, n);
+            heap_fix(scratch, size, scratch->position[n]);
+        }
+    }
+
+    // Compact the kept vertices in their original order
+    int count = 0;
+    for (int i = 0; i < num_points; i++) {
+        if (scratch->position[i] != POSITION_REMOVED) {
+            xs[count] = xs[i];
+            ys[count] = ys[i];
+            count++;
+        }
+    }
+    return count;
+}
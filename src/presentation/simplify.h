@@ -0,0 +1,29 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+// Define the working memory of the simplifier. It grows to the largest outline seen and is
+// reused from frame to frame; it is not shared, so every thread keeps its own
+typedef struct {
+    int capacity;
+    int* prev;          // neighbours in the outline as it shrinks
+    int* next;
+    float* key;         // error bound if the vertex were removed now
+    float* error;       // error bound of the removed points between a vertex and its next one
+    int* heap;          // min-heap of vertex indices on key
+    int* position;      // heap slot of each vertex, -1 when pinned, -2 once removed
+} SimplifyScratch;
+
+// Prepare empty scratch buffers
+void simplify_scratch_init(SimplifyScratch* scratch);
+
+// Release the scratch buffers
+void simplify_scratch_free(SimplifyScratch* scratch);
+
+// Remove vertices from an outline (Visvalingam-Whyatt order, least significant first, on a heap:
+// O(n log n)) while every original point stays within tolerance of the simplified outline.
+// A closed outline keeps at least 3 vertices; an open one keeps both end points. The kept points
+// are compacted in place, in their original order. Returns the new count, or -1 if out of memory
+int simplify_outline(SimplifyScratch* scratch, float* xs, float* ys, int num_points, int closed,
+                     float tolerance);
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "spsc_ring.h"
+
+// Function to allocate the slots of a ring
+int spsc_ring_init(SpscRing* ring, size_t capacity, size_t slot_size)
+{
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+    ring->slot_size = (slot_size + 63) / 64 * 64;  // Neighbouring slots do not share a cache line
+    ring->capacity = rounded;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->slots = (unsigned char*) aligned_alloc(64, ring->capacity * ring->slot_size);
+    if (ring->slots == NULL) {
+        printf("Error: Could not allocate a ring of %zu slots of %zu bytes\n", ring->capacity, ring->slot_size);
+        return -1;
+    }
+    return 0;
+}
+
+// Function to release the slots of a ring
+void spsc_ring_free(SpscRing* ring)
+{
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+// Function to find the producer's next slot; only the producer writes head
+void* spsc_ring_claim(SpscRing* ring)
+{
+    size_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == ring->capacity) {
+        return NULL;
+    }
+    return ring->slots + (head & (ring->capacity - 1)) * ring->slot_size;
+}
+
+// Function to publish the claimed slot; the release store makes its contents visible first
+void spsc_ring_publish(SpscRing* ring)
+{
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+// Function to find the consumer's next slot; only the consumer writes tail
+void* spsc_ring_peek(SpscRing* ring)
+{
+    size_t tail = ring->tail;
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return NULL;
+    }
+    return ring->slots + (tail & (ring->capacity - 1)) * ring->slot_size;
+}
+
+// Function to hand the consumed slot back to the producer
+void spsc_ring_release(SpscRing* ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+// Function to wait a little longer each round without taking a lock
+void spsc_ring_wait(int* round)
+{
+    (*round)++;
+    if (*round < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();  // Lets the other hyperthread run while spinning
+#endif
+    } else if (*round < 128) {
+        sched_yield();
+    } else {
+        struct timespec pause = { 0, 50000 };  // 50 us: a stalled stage costs no CPU
+        nanosleep(&pause, NULL);
+    }
+}
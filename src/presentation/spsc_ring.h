@@ -0,0 +1,41 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+
+// Define a bounded ring of fixed-size slots between exactly one producer thread and one consumer
+// thread. Neither side takes a lock: each owns one counter, reads the other's with acquire
+// ordering and publishes its own with release ordering. The counters sit on separate cache lines
+// so the two threads do not keep stealing one line from each other
+typedef struct {
+    unsigned char* slots;
+    size_t slot_size;
+    size_t capacity;                        // a power of two
+    _Alignas(64) size_t head;               // slots published by the producer
+    _Alignas(64) size_t tail;               // slots released by the consumer
+} SpscRing;
+
+// Allocate a ring of capacity slots (rounded up to a power of two) of slot_size bytes each.
+// Returns 0 on success and -1 on failure
+int spsc_ring_init(SpscRing* ring, size_t capacity, size_t slot_size);
+
+// Release the slots
+void spsc_ring_free(SpscRing* ring);
+
+// Producer: the next free slot to fill, or NULL while the ring is full
+void* spsc_ring_claim(SpscRing* ring);
+
+// Producer: hand the claimed slot to the consumer
+void spsc_ring_publish(SpscRing* ring);
+
+// Consumer: the oldest published slot, or NULL while the ring is empty
+void* spsc_ring_peek(SpscRing* ring);
+
+// Consumer: give the peeked slot back to the producer
+void spsc_ring_release(SpscRing* ring);
+
+// Back off while waiting on a ring: spin briefly, then yield, then sleep. round counts the
+// attempts so far and is reset by the caller once the ring moves
+void spsc_ring_wait(int* round);
+
+#endif
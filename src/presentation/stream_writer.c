@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>   // Frames are written by a separate thread
+#include "stream_writer.h"
+
+struct StreamWriter {
+    FILE* file;
+    StreamFormat format;
+    int width;
+    int height;
+
+    unsigned char* slots;   // queue_frames RGBA frames, used as a ring buffer
+    int queue_frames;
+    int head;               // Next frame the writer thread takes
+    int count;              // Frames waiting in the queue
+    int closing;
+    int failed;
+
+    unsigned char* yuv;     // Conversion buffer owned by the writer thread
+    size_t yuv_size;
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    pthread_t thread;
+};
+
+// Function to clamp a converted value to one byte
+static unsigned char clamp_byte(int value)
+{
+    return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Function to convert an RGBA frame to planar 4:2:0 YUV (BT.601, studio range)
+static void rgba_to_yuv420(const unsigned char* rgba, int width, int height, unsigned char* yuv)
+{
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    unsigned char* plane_y = yuv;
+    unsigned char* plane_u = yuv + (size_t)width * height;
+    unsigned char* plane_v = plane_u + (size_t)chroma_width * chroma_height;
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* p = rgba + (size_t)y * width * 4;
+        for (int x = 0; x < width; x++, p += 4) {
+            plane_y[(size_t)y * width + x] = clamp_byte(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+        }
+    }
+
+    // Each chroma sample averages a 2x2 block of pixels
+    for (int cy = 0; cy < chroma_height; cy++) {
+        for (int cx = 0; cx < chroma_width; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    int x = cx * 2 + dx, y = cy * 2 + dy;
+                    if (x < width && y < height) {
+                        const unsigned char* p = rgba + ((size_t)y * width + x) * 4;
+                        r += p[0];
+                        g += p[1];
+                        b += p[2];
+                        n++;
+                    }
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            plane_u[(size_t)cy * chroma_width + cx] = clamp_byte(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            plane_v[(size_t)cy * chroma_width + cx] = clamp_byte(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+// Function to write a whole buffer, returns -1 when the consumer went away
+static int write_all(FILE* file, const void* data, size_t length)
+{
+    return fwrite(data, 1, length, file) == length ? 0 : -1;
+}
+
+// Writer thread: takes frames in queue order, converts them and writes them out
+static void* writer_thread(void* arg)
+{
+    StreamWriter* writer = (StreamWriter*) arg;
+    size_t frame_bytes = (size_t)writer->width * writer->height * 4;
+
+    for (;;) {
+        pthread_mutex_lock(&writer->lock);
+        while (writer->count == 0 && !writer->closing) {
+            pthread_cond_wait(&writer->not_empty, &writer->lock);
+        }
+        if (writer->count == 0) {
+            pthread_mutex_unlock(&writer->lock);
+            break;  // Closing and fully drained
+        }
+        unsigned char* frame = writer->slots + writer->head * frame_bytes;
+        pthread_mutex_unlock(&writer->lock);
+
+        // Convert outside the lock so the frame loop keeps producing meanwhile
+        const void* data = frame;
+        size_t length = frame_bytes;
+        if (writer->format == STREAM_Y4M) {
+            rgba_to_yuv420(frame, writer->width, writer->height, writer->yuv);
+            data = writer->yuv;
+            length = writer->yuv_size;
+        }
+
+        // The slot can be reused as soon as its pixels have been converted
+        int release_now = (writer->format == STREAM_Y4M);
+        if (release_now) {
+            pthread_mutex_lock(&writer->lock);
+            writer->head = (writer->head + 1) % writer->queue_frames;
+            writer->count--;
+            pthread_cond_signal(&writer->not_full);
+            pthread_mutex_unlock(&writer->lock);
+        }
+
+        int status = 0;
+        if (writer->format == STREAM_Y4M) {
+            status = write_all(writer->file, "FRAME\n", 6);
+        }
+        if (status == 0) {
+            status = write_all(writer->file, data, length);
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        if (!release_now) {
+            writer->head = (writer->head + 1) % writer->queue_frames;
+            writer->count--;
+            pthread_cond_signal(&writer->not_full);
+        }
+        if (status == -1) {
+            writer->failed = 1;
+            pthread_cond_broadcast(&writer->not_full);
+            pthread_mutex_unlock(&writer->lock);
+            fprintf(stderr, "Error: Could not write video stream: %s\n", strerror(errno));
+            break;
+        }
+        pthread_mutex_unlock(&writer->lock);
+    }
+    return NULL;
+}
+
+// Function to open the output and start the writer thread
+StreamWriter* stream_writer_open(const char* path, StreamFormat format, int width, int height,
+                                 int fps, int queue_frames)
+{
+    if (queue_frames < 1) {
+        queue_frames = 1;
+    }
+    StreamWriter* writer = (StreamWriter*) calloc(1, sizeof(StreamWriter));
+    if (writer == NULL) {
+        fprintf(stderr, "Error: Could not allocate stream writer\n");
+        return NULL;
+    }
+    writer->format = format;
+    writer->width = width;
+    writer->height = height;
+    writer->queue_frames = queue_frames;
+    writer->yuv_size = (size_t)width * height + 2 * (size_t)((width + 1) / 2) * ((height + 1) / 2);
+    writer->slots = (unsigned char*) malloc((size_t)width * height * 4 * queue_frames);
+    writer->yuv = (unsigned char*) malloc(writer->yuv_size);
+    if (writer->slots == NULL || writer->yuv == NULL) {
+        fprintf(stderr, "Error: Could not allocate %d stream frame slots\n", queue_frames);
+        free(writer->slots);
+        free(writer->yuv);
+        free(writer);
+        return NULL;
+    }
+
+    // A reader that exits early should turn into a write error, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+
+    if (strcmp(path, "-") == 0) {
+        // Keep the real stdout for the video and send everything else printed to stderr
+        fflush(stdout);
+        int video_fd = dup(STDOUT_FILENO);
+        if (video_fd != -1) {
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+            writer->file = fdopen(video_fd, "wb");
+        }
+    } else {
+        writer->file = fopen(path, "wb");  // Blocks until a reader opens a FIFO
+    }
+    if (writer->file == NULL) {
+        fprintf(stderr, "Error: Could not open %s for streaming: %s\n", path, strerror(errno));
+        free(writer->slots);
+        free(writer->yuv);
+        free(writer);
+        return NULL;
+    }
+    setvbuf(writer->file, NULL, _IOFBF, 1 << 20);
+
+    if (format == STREAM_Y4M) {
+        fprintf(writer->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->not_empty, NULL);
+    pthread_cond_init(&writer->not_full, NULL);
+    if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0) {
+        fprintf(stderr, "Error: Could not start the stream writer thread\n");
+        fclose(writer->file);
+        free(writer->slots);
+        free(writer->yuv);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+// Function to hand one frame to the writer thread, waiting for a free slot if needed
+int stream_writer_push(StreamWriter* writer, const unsigned char* rgba)
+{
+    size_t frame_bytes = (size_t)writer->width * writer->height * 4;
+
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count == writer->queue_frames && !writer->failed) {
+        pthread_cond_wait(&writer->not_full, &writer->lock);
+    }
+    if (writer->failed) {
+        pthread_mutex_unlock(&writer->lock);
+        return -1;
+    }
+    int tail = (writer->head + writer->count) % writer->queue_frames;
+    pthread_mutex_unlock(&writer->lock);
+
+    // Only this thread fills the tail slot, so the copy needs no lock
+    memcpy(writer->slots + tail * frame_bytes, rgba, frame_bytes);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->count++;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+    return 0;
+}
+
+// Function to drain the queue, join the writer thread and close the output
+int stream_writer_close(StreamWriter* writer)
+{
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = 1;
+    pthread_cond_signal(&writer->not_empty);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+
+    int status = writer->failed ? -1 : 0;
+    if (fclose(writer->file) != 0) {
+        status = -1;
+    }
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->not_empty);
+    pthread_cond_destroy(&writer->not_full);
+    free(writer->slots);
+    free(writer->yuv);
+    free(writer);
+    return status;
+}
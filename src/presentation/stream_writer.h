@@ -0,0 +1,26 @@
+#ifndef STREAM_WRITER_H
+#define STREAM_WRITER_H
+
+// Raw video formats that can be piped into an encoder
+typedef enum {
+    STREAM_Y4M,   // YUV4MPEG2, 4:2:0 BT.601 (what ffmpeg/x264 read with -f yuv4mpegpipe)
+    STREAM_RGBA   // Headerless packed RGBA frames (ffmpeg -f rawvideo -pix_fmt rgba)
+} StreamFormat;
+
+// Opaque writer state (frame queue and writer thread)
+typedef struct StreamWriter StreamWriter;
+
+// Open a stream to a file or FIFO, or to stdout when path is "-". Writing to stdout
+// moves the process's own stdout to stderr so status messages cannot corrupt the video.
+// queue_frames bounds how many frames may wait for the writer thread.
+StreamWriter* stream_writer_open(const char* path, StreamFormat format, int width, int height,
+                                 int fps, int queue_frames);
+
+// Queue one RGBA frame (width * height * 4 bytes). Blocks while the queue is full, so a
+// slow consumer slows down frame generation instead of growing memory.
+int stream_writer_push(StreamWriter* writer, const unsigned char* rgba);
+
+// Write the remaining frames, stop the writer thread and close the stream
+int stream_writer_close(StreamWriter* writer);
+
+#endif
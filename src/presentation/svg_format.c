@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "svg_format.h"
+
+#define MAX_DECIMALS 6
+#define MAX_NUMBER_LENGTH 32  // Longest number format_number writes, with the terminator
+
+static const long long powers_of_ten[MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+// Function to validate a coordinate format and derive its precision from the grid
+int coord_format_init(CoordFormat* format, int decimals, float grid)
+{
+    if (decimals > MAX_DECIMALS || grid < 0.0f) {
+        printf("Error: Precision must be at most %d decimals and the grid must be positive\n", MAX_DECIMALS);
+        return -1;
+    }
+    if (grid > 0.0f && decimals < 0) {
+        // Use the fewest decimals that represent every multiple of the grid exactly
+        decimals = 0;
+        while (decimals < MAX_DECIMALS) {
+            double scaled = grid * powers_of_ten[decimals];
+            if (fabs(scaled - floor(scaled + 0.5)) < 1e-4) {
+                break;
+            }
+            decimals++;
+        }
+    }
+    format->decimals = decimals;
+    format->grid = grid;
+    return 0;
+}
+
+// Function to write the digits of a positive integer, returns the number of digits
+static int write_digits(char* out, unsigned long long value)
+{
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < count; i++) {
+        out[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+// Function to write a number with an integer formatter after quantizing it
+int format_number(char* out, float value, const CoordFormat* format)
+{
+    if (format->decimals < 0) {
+        return snprintf(out, MAX_NUMBER_LENGTH, "%f", value);
+    }
+    double v = value;
+    if (format->grid > 0.0f) {
+        v = floor(v / format->grid + 0.5) * format->grid;
+    }
+
+    // All the work happens on one scaled integer
+    long long scale = powers_of_ten[format->decimals];
+    long long q = llrint(v * scale);
+    int length = 0;
+    if (q < 0) {
+        out[length++] = '-';
+        q = -q;
+    }
+    unsigned long long whole = (unsigned long long)(q / scale);
+    unsigned long long fraction = (unsigned long long)(q % scale);
+    if (whole != 0 || fraction == 0) {
+        length += write_digits(out + length, whole);  // "0.5" is written ".5"
+    }
+    if (fraction != 0) {
+        int digits = format->decimals;
+        while (fraction % 10 == 0) {  // Strip trailing zeros
+            fraction /= 10;
+            digits--;
+        }
+        out[length++] = '.';
+        char buffer[24];
+        int count = write_digits(buffer, fraction);
+        for (int i = count; i < digits; i++) {
+            out[length++] = '0';  // Leading zeros of the fraction
+        }
+        memcpy(out + length, buffer, count);
+        length += count;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+// Function to write a points list, dropping separators where a minus sign already separates
+static int format_point_list(char* out, size_t size, const float* xs, const float* ys, int num_points,
+                             const CoordFormat* format, int continued)
+{
+    size_t length = 0;
+    char number[MAX_NUMBER_LENGTH];
+    for (int i = 0; i < num_points; i++) {
+        for (int k = 0; k < 2; k++) {
+            int count = format_number(number, k == 0 ? xs[i] : ys[i], format);
+            int first = (i == 0 && k == 0 && !continued);
+            // The classic output keeps its "x,y x,y" layout exactly
+            int separator = !first && (format->decimals < 0 || number[0] != '-');
+            if (length + separator + count + 1 > size) {
+                return -1;
+            }
+            if (separator) {
+                out[length++] = (k == 0) ? ' ' : ',';
+            }
+            memcpy(out + length, number, count);
+            length += count;
+        }
+    }
+    out[length] = '\0';
+    return (int)length;
+}
+
+// Function to write a complete points list
+int format_points(char* out, size_t size, const float* xs, const float* ys, int num_points,
+                  const CoordFormat* format)
+{
+    return format_point_list(out, size, xs, ys, num_points, format, 0);
+}
+
+// Function to write the next chunk of a points list
+int format_points_continued(char* out, size_t size, const float* xs, const float* ys, int num_points,
+                            const CoordFormat* format)
+{
+    return format_point_list(out, size, xs, ys, num_points, format, 1);
+}
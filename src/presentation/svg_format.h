@@ -0,0 +1,29 @@
+#ifndef SVG_FORMAT_H
+#define SVG_FORMAT_H
+
+#include <stddef.h>
+
+// Define how coordinates are written to the SVG files
+typedef struct {
+    int decimals;   // digits kept after the point (0-6); -1 keeps the classic "%f" output
+    float grid;     // snap coordinates to multiples of this step first, 0 for no grid
+} CoordFormat;
+
+// Set up a coordinate format. With a grid and decimals < 0 the decimals the grid needs are used;
+// with neither the output stays "%f". Returns 0 on success and -1 for invalid values
+int coord_format_init(CoordFormat* format, int decimals, float grid);
+
+// Write one quantized number (no trailing zeros, no leading "0."), returns its length
+int format_number(char* out, float value, const CoordFormat* format);
+
+// Write "x,y x,y ..." for a list of points with the shortest valid separators.
+// Returns the number of characters written, or -1 if the buffer is too small
+int format_points(char* out, size_t size, const float* xs, const float* ys, int num_points,
+                  const CoordFormat* format);
+
+// Same as format_points for a list that continues earlier output, so it starts with a separator
+// when one is needed; lets a long list be written one chunk at a time
+int format_points_continued(char* out, size_t size, const float* xs, const float* ys, int num_points,
+                            const CoordFormat* format);
+
+#endif
@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "svg_outline.h"
+
+#define CURVE_PIECES 16     // straight pieces per Bézier segment
+#define CIRCLE_PIECES 64    // straight pieces per circle
+#define ARC_PIECE_ANGLE (M_PI / 16)
+
+// Define a polyline that grows while a path is flattened
+typedef struct {
+    float* xy;
+    unsigned char* move;
+    int count;
+    int capacity;
+} Polyline;
+
+// Function to append one point to a polyline, growing it when needed
+static int polyline_add(Polyline* line, double x, double y, int move)
+{
+    if (line->count == line->capacity) {
+        int capacity = line->capacity ? line->capacity * 2 : 256;
+        float* xy = (float*) realloc(line->xy, (size_t)capacity * 2 * sizeof(float));
+        if (xy == NULL) {
+            return -1;
+        }
+        line->xy = xy;
+        unsigned char* moves = (unsigned char*) realloc(line->move, capacity);
+        if (moves == NULL) {
+            return -1;
+        }
+        line->move = moves;
+        line->capacity = capacity;
+    }
+    line->xy[2 * line->count] = (float)x;
+    line->xy[2 * line->count + 1] = (float)y;
+    line->move[line->count++] = (unsigned char)move;
+    return 0;
+}
+
+// Function to flatten a cubic Bézier from (x0, y0) into a polyline
+static int polyline_cubic(Polyline* line, double x0, double y0, double x1, double y1, double x2, double y2,
+                          double x3, double y3)
+{
+    for (int k = 1; k <= CURVE_PIECES; k++) {
+        double s = (double)k / CURVE_PIECES, r = 1.0 - s;
+        double a = r * r * r, b = 3 * r * r * s, c = 3 * r * s * s, e = s * s * s;
+        if (polyline_add(line, a * x0 + b * x1 + c * x2 + e * x3, a * y0 + b * y1 + c * y2 + e * y3, 0) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Function to flatten an elliptical arc from (x1, y1) to (x2, y2), converted from the SVG endpoint
+// form to its center form (SVG 1.1, appendix F.6.5)
+static int polyline_arc(Polyline* line, double x1, double y1, double rx, double ry, double rotation,
+                        int large_arc, int sweep, double x2, double y2)
+{
+    rx = fabs(rx);
+    ry = fabs(ry);
+    if (rx == 0.0 || ry == 0.0 || (x1 == x2 && y1 == y2)) {
+        return polyline_add(line, x2, y2, 0);
+    }
+    double phi = rotation * M_PI / 180.0, cos_phi = cos(phi), sin_phi = sin(phi);
+    double dx = (x1 - x2) / 2, dy = (y1 - y2) / 2;
+    double xp = cos_phi * dx + sin_phi * dy, yp = -sin_phi * dx + cos_phi * dy;
+    double lambda = (xp * xp) / (rx * rx) + (yp * yp) / (ry * ry);
+    if (lambda > 1.0) {
+        rx *= sqrt(lambda);  // Radii too small to reach the end point are scaled up
+        ry *= sqrt(lambda);
+    }
+    double numerator = rx * rx * ry * ry - rx * rx * yp * yp - ry * ry * xp * xp;
+    double denominator = rx * rx * yp * yp + ry * ry * xp * xp;
+    double coefficient = sqrt(fmax(0.0, numerator / denominator)) * (large_arc == sweep ? -1.0 : 1.0);
+    double cxp = coefficient * rx * yp / ry, cyp = -coefficient * ry * xp / rx;
+    double cx = cos_phi * cxp - sin_phi * cyp + (x1 + x2) / 2;
+    double cy = sin_phi * cxp + cos_phi * cyp + (y1 + y2) / 2;
+    double theta = atan2((yp - cyp) / ry, (xp - cxp) / rx);
+    double delta = atan2((-yp - cyp) / ry, (-xp - cxp) / rx) - theta;
+    if (!sweep && delta > 0) {
+        delta -= 2 * M_PI;
+    } else if (sweep && delta < 0) {
+        delta += 2 * M_PI;
+    }
+
+    int pieces = (int) ceil(fabs(delta) / ARC_PIECE_ANGLE);
+    for (int k = 1; k < pieces; k++) {
+        double angle = theta + delta * k / pieces;
+        double ex = rx * cos(angle), ey = ry * sin(angle);
+        if (polyline_add(line, cx + ex * cos_phi - ey * sin_phi, cy + ex * sin_phi + ey * cos_phi, 0) == -1) {
+            return -1;
+        }
+    }
+    return polyline_add(line, x2, y2, 0);  // The end point exactly, not as computed
+}
+
+// Function to read an arc flag, which may be written without a separator ("a1,1 0 01 5,5")
+static int parse_flag(const char** cursor, const char* end, int* flag)
+{
+    const char* p = *cursor;
+    while (p < end && (isspace((unsigned char)*p) || *p == ',')) {
+        p++;
+    }
+    if (p == end || (*p != '0' && *p != '1')) {
+        return -1;
+    }
+    *flag = (*p == '1');
+    *cursor = p + 1;
+    return 0;
+}
+
+// Function to read count numbers of one path command
+static int parse_numbers(const char** cursor, const char* end, double* numbers, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (svg_parse_number(cursor, end, &numbers[i]) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Function to flatten the path data of a d attribute into a polyline
+int svg_path_flatten(const SvgSpan* d, float** xy, unsigned char** move)
+{
+    const char* p = d->start;
+    const char* end = d->start + d->length;
+    Polyline line = { NULL, NULL, 0, 0 };
+    double x = 0, y = 0;                  // current point
+    double start_x = 0, start_y = 0;      // start of the current subpath
+    double control_x = 0, control_y = 0;  // last control point, reflected by S and T
+    char command = 0, previous = 0;
+    int status = 0;
+    while (status == 0) {
+        while (p < end && (isspace((unsigned char)*p) || *p == ',')) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+        if (isalpha((unsigned char)*p)) {
+            command = *p++;
+        } else if (command == 0 || command == 'Z' || command == 'z') {
+            status = -1;  // Numbers need a command to belong to
+            break;
+        }
+        int relative = islower((unsigned char)command);
+        double base_x = relative ? x : 0, base_y = relative ? y : 0;
+        double n[7];
+        int a_large, a_sweep;
+        switch (toupper((unsigned char)command)) {
+        case 'M':
+            if ((status = parse_numbers(&p, end, n, 2)) == 0) {
+                x = start_x = base_x + n[0];
+                y = start_y = base_y + n[1];
+                status = polyline_add(&line, x, y, 1);
+                command = relative ? 'l' : 'L';  // Further pairs are line-to's
+            }
+            break;
+        case 'L':
+            if ((status = parse_numbers(&p, end, n, 2)) == 0) {
+                x = base_x + n[0];
+                y = base_y + n[1];
+                status = polyline_add(&line, x, y, 0);
+            }
+            break;
+        case 'H':
+            if ((status = parse_numbers(&p, end, n, 1)) == 0) {
+                x = base_x + n[0];
+                status = polyline_add(&line, x, y, 0);
+            }
+            break;
+        case 'V':
+            if ((status = parse_numbers(&p, end, n, 1)) == 0) {
+                y = base_y + n[0];
+                status = polyline_add(&line, x, y, 0);
+            }
+            break;
+        case 'C':
+        case 'S':
+            if (toupper((unsigned char)command) == 'C') {
+                status = parse_numbers(&p, end, n, 6);
+                n[0] += base_x;
+                n[1] += base_y;
+            } else {
+                status = parse_numbers(&p, end, n + 2, 4);
+                int smooth = (previous == 'C' || previous == 'S');
+                n[0] = smooth ? 2 * x - control_x : x;
+                n[1] = smooth ? 2 * y - control_y : y;
+            }
+            if (status == 0) {
+                double x2 = base_x + n[2], y2 = base_y + n[3], x3 = base_x + n[4], y3 = base_y + n[5];
+                status = polyline_cubic(&line, x, y, n[0], n[1], x2, y2, x3, y3);
+                control_x = x2;
+                control_y = y2;
+                x = x3;
+                y = y3;
+            }
+            break;
+        case 'Q':
+        case 'T':
+            if (toupper((unsigned char)command) == 'Q') {
+                status = parse_numbers(&p, end, n, 4);
+                n[0] += base_x;
+                n[1] += base_y;
+            } else {
+                status = parse_numbers(&p, end, n + 2, 2);
+                int smooth = (previous == 'Q' || previous == 'T');
+                n[0] = smooth ? 2 * x - control_x : x;
+                n[1] = smooth ? 2 * y - control_y : y;
+            }
+            if (status == 0) {
+                // A quadratic is the cubic with controls two thirds of the way to its control point
+                double x3 = base_x + n[2], y3 = base_y + n[3];
+                status = polyline_cubic(&line, x, y, x + 2.0 / 3 * (n[0] - x), y + 2.0 / 3 * (n[1] - y),
+                                        x3 + 2.0 / 3 * (n[0] - x3), y3 + 2.0 / 3 * (n[1] - y3), x3, y3);
+                control_x = n[0];
+                control_y = n[1];
+                x = x3;
+                y = y3;
+            }
+            break;
+        case 'A':
+            if ((status = parse_numbers(&p, end, n, 3)) == 0 && (status = parse_flag(&p, end, &a_large)) == 0 &&
+                (status = parse_flag(&p, end, &a_sweep)) == 0 && (status = parse_numbers(&p, end, n + 3, 2)) == 0) {
+                double x2 = base_x + n[3], y2 = base_y + n[4];
+                status = polyline_arc(&line, x, y, n[0], n[1], n[2], a_large, a_sweep, x2, y2);
+                x = x2;
+                y = y2;
+            }
+            break;
+        case 'Z':
+            x = start_x;
+            y = start_y;
+            status = polyline_add(&line, x, y, 0);
+            break;
+        default:
+            status = -1;
+            break;
+        }
+        previous = (char) toupper((unsigned char)command);
+    }
+    if (status == -1) {
+        printf("Error: Malformed path data near \"%.20s\"\n", p);
+        free(line.xy);
+        free(line.move);
+        return -1;
+    }
+    *xy = line.xy;
+    *move = line.move;
+    return line.count;
+}
+
+// Function to sample a polyline at num_samples points spread evenly along its drawn length
+// (the jumps between subpaths do not count) into the outlines
+static void sample_polyline(const float* xy, const unsigned char* move, int count, int num_samples,
+                            SvgOutlines* outlines)
+{
+    double length = 0.0;
+    for (int i = 1; i < count; i++) {
+        if (!move[i]) {
+            length += hypot(xy[2 * i] - xy[2 * i - 2], xy[2 * i + 1] - xy[2 * i - 1]);
+        }
+    }
+    double covered = 0.0;  // drawn length up to point i
+    int i = 0, subpath = 0, last_subpath = -1;
+    for (int k = 0; k < num_samples; k++) {
+        double target = length * k / num_samples;
+        double piece = 0.0;
+        // Move to the segment i..i+1 that holds the target distance
+        while (i + 1 < count) {
+            piece = move[i + 1] ? 0.0 : hypot(xy[2 * i + 2] - xy[2 * i], xy[2 * i + 3] - xy[2 * i + 1]);
+            if (piece > 0.0 && covered + piece > target) {
+                break;
+            }
+            covered += piece;
+            i++;
+            subpath += move[i];
+        }
+        float* out = outlines->xy + 2 * outlines->num_points;
+        if (i + 1 < count && piece > 0.0) {
+            double s = (target - covered) / piece;
+            out[0] = (float)(xy[2 * i] + s * (xy[2 * i + 2] - xy[2 * i]));
+            out[1] = (float)(xy[2 * i + 1] + s * (xy[2 * i + 3] - xy[2 * i + 1]));
+        } else {
+            out[0] = xy[2 * i];
+            out[1] = xy[2 * i + 1];
+        }
+        outlines->move[outlines->num_points++] = (subpath != last_subpath);
+        last_subpath = subpath;
+    }
+}
+
+// Function to add one shape's polyline to the outlines as samples_per_shape points
+static int add_shape(SvgOutlines* outlines, const float* xy, const unsigned char* move, int count,
+                     int samples_per_shape)
+{
+    if (count < 1) {
+        return 0;  // Nothing drawn
+    }
+    int num_points = outlines->num_points + samples_per_shape;
+    float* grown_xy = (float*) realloc(outlines->xy, (size_t)num_points * 2 * sizeof(float));
+    if (grown_xy) {
+        outlines->xy = grown_xy;
+    }
+    unsigned char* grown_move = (unsigned char*) realloc(outlines->move, num_points);
+    if (grown_move) {
+        outlines->move = grown_move;
+    }
+    int* grown_start = (int*) realloc(outlines->shape_start, (outlines->num_shapes + 2) * sizeof(int));
+    if (grown_start) {
+        outlines->shape_start = grown_start;
+    }
+    if (!grown_xy || !grown_move || !grown_start) {
+        printf("Error: Could not allocate %d outline points\n", num_points);
+        return -1;
+    }
+    sample_polyline(xy, move, count, samples_per_shape, outlines);
+    outlines->shape_start[++outlines->num_shapes] = outlines->num_points;
+    return 0;
+}
+
+// Function to load and sample every shape of an SVG file
+int svg_outlines_load(const char* filename, int samples_per_shape, SvgOutlines* outlines)
+{
+    memset(outlines, 0, sizeof(SvgOutlines));
+    outlines->shape_start = (int*) malloc(sizeof(int));
+    if (outlines->shape_start == NULL || samples_per_shape < 1) {
+        printf("Error: Could not prepare the outlines of %s\n", filename);
+        return -1;
+    }
+    outlines->shape_start[0] = 0;
+    SvgFile file;
+    if (svg_file_map(filename, &file) == -1) {
+        return -1;
+    }
+
+    static const char* elements[] = { "path", "polygon", "circle" };
+    int status = 0;
+    for (int e = 0; e < 3 && status == 0; e++) {
+        size_t offset = 0;
+        SvgSpan tag, value;
+        while (status == 0 && svg_find_element(&file, elements[e], &offset, &tag) == 0) {
+            float* xy = NULL;
+            unsigned char* move = NULL;
+            int count = 0;
+            if (e == 0) {
+                count = svg_attribute(&tag, "d", &value) == 0 ? svg_path_flatten(&value, &xy, &move) : 0;
+            } else if (e == 1) {
+                // A polygon closes back to its first vertex
+                if (svg_attribute(&tag, "points", &value) == 0 && (count = svg_parse_points(&value, &xy)) > 0) {
+                    float* closed = (float*) realloc(xy, (size_t)(count + 1) * 2 * sizeof(float));
+                    move = (unsigned char*) calloc(count + 1, 1);
+                    if (closed == NULL || move == NULL) {
+                        free(closed ? closed : xy);
+                        xy = NULL;
+                        count = -1;
+                    } else {
+                        xy = closed;
+                        xy[2 * count] = xy[0];
+                        xy[2 * count + 1] = xy[1];
+                        move[0] = 1;
+                        count++;
+                    }
+                }
+            } else {
+                float cx, cy, r;
+                if (svg_attribute_float(&tag, "cx", &cx) == 0 && svg_attribute_float(&tag, "cy", &cy) == 0 &&
+                    svg_attribute_float(&tag, "r", &r) == 0) {
+                    xy = (float*) malloc((CIRCLE_PIECES + 1) * 2 * sizeof(float));
+                    move = (unsigned char*) calloc(CIRCLE_PIECES + 1, 1);
+                    count = (xy && move) ? CIRCLE_PIECES + 1 : -1;
+                    for (int k = 0; k < count; k++) {
+                        double angle = 2 * M_PI * k / CIRCLE_PIECES;
+                        xy[2 * k] = (float)(cx + r * cos(angle));
+                        xy[2 * k + 1] = (float)(cy + r * sin(angle));
+                    }
+                    if (count > 0) {
+                        move[0] = 1;
+                    }
+                }
+            }
+            status = (count < 0) ? -1 : add_shape(outlines, xy, move, count, samples_per_shape);
+            free(xy);
+            free(move);
+        }
+    }
+    svg_file_unmap(&file);
+    if (status == 0 && outlines->num_points == 0) {
+        printf("Error: %s has no <path>, <polygon> or <circle> to sample\n", filename);
+        status = -1;
+    }
+    if (status == -1) {
+        svg_outlines_free(outlines);
+    }
+    return status;
+}
+
+// Function to release the outlines
+void svg_outlines_free(SvgOutlines* outlines)
+{
+    free(outlines->xy);
+    free(outlines->move);
+    free(outlines->shape_start);
+    memset(outlines, 0, sizeof(SvgOutlines));
+}
@@ -0,0 +1,30 @@
+#ifndef SVG_OUTLINE_H
+#define SVG_OUTLINE_H
+
+#include "svg_scan.h"
+
+// Define the outlines of the shapes of an SVG file, sampled into points. All points share one
+// interleaved x,y array; every shape element is one run of it, and a run can hold several
+// subpaths (a ring of a donut, the eye of an icon)
+typedef struct {
+    int num_points;
+    float* xy;
+    unsigned char* move;     // 1 where a point starts a new subpath
+    int num_shapes;
+    int* shape_start;        // first point of every shape, plus num_points at the end
+} SvgOutlines;
+
+// Flatten the path data of a d attribute (M, L, H, V, C, S, Q, T, A and Z, absolute or relative)
+// into a malloc'ed polyline: xy holds interleaved points and move (also malloc'ed) marks the start
+// of every subpath. Curves are split into a fixed number of straight pieces. Returns the number
+// of points, or -1 on malformed data
+int svg_path_flatten(const SvgSpan* d, float** xy, unsigned char** move);
+
+// Load every <path>, <polygon> and <circle> of an SVG file (in that order) and sample each of
+// them at samples_per_shape points spread evenly along its length. Returns 0 or -1
+int svg_outlines_load(const char* filename, int samples_per_shape, SvgOutlines* outlines);
+
+// Release the outlines
+void svg_outlines_free(SvgOutlines* outlines);
+
+#endif
@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>  // The input is scanned where it lies, never copied
+#include <sys/stat.h>
+#include "svg_scan.h"
+
+#define MAX_MANTISSA_DIGITS 19   // Digits that always fit in a uint64_t
+#define MAX_EXACT_MANTISSA (1ULL << 53)
+#define MAX_EXACT_POWER 22       // 10^22 is the largest power of ten a double holds exactly
+
+static const double exact_powers[MAX_EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Function to map a file read-only into memory
+int svg_file_map(const char* path, SvgFile* file)
+{
+    memset(file, 0, sizeof(SvgFile));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        printf("Error: Could not open file %s\n", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        printf("Error: Could not parse file %s\n", path);
+        close(fd);
+        return -1;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid without the descriptor
+    if (data == MAP_FAILED) {
+        printf("Error: Could not map file %s\n", path);
+        return -1;
+    }
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    file->data = (const char*) data;
+    file->length = (size_t)st.st_size;
+    return 0;
+}
+
+// Function to unmap a file
+void svg_file_unmap(SvgFile* file)
+{
+    if (file->data) {
+        munmap((void*) file->data, file->length);
+    }
+    memset(file, 0, sizeof(SvgFile));
+}
+
+// Function to test for XML whitespace
+static int is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Function to find a string in a byte range, returns NULL when it does not occur
+static const char* find_text(const char* from, const char* end, const char* text)
+{
+    size_t length = strlen(text);
+    while (from + length <= end) {
+        const char* hit = (const char*) memchr(from, text[0], end - from);
+        if (hit == NULL || hit + length > end) {
+            return NULL;
+        }
+        if (memcmp(hit, text, length) == 0) {
+            return hit;
+        }
+        from = hit + 1;
+    }
+    return NULL;
+}
+
+// Function to find the '>' that closes a tag, stepping over quoted attribute values
+static const char* find_tag_end(const char* p, const char* end)
+{
+    while (p < end) {
+        if (*p == '"' || *p == '\'') {
+            const char* close = (const char*) memchr(p + 1, *p, end - p - 1);
+            if (close == NULL) {
+                return NULL;
+            }
+            p = close + 1;
+        } else if (*p == '>') {
+            return p;
+        } else {
+            p++;
+        }
+    }
+    return NULL;
+}
+
+// Function to find the next start tag with the given name
+int svg_find_element(const SvgFile* file, const char* name, size_t* offset, SvgSpan* tag)
+{
+    const char* end = file->data + file->length;
+    const char* p = file->data + *offset;
+    size_t name_length = strlen(name);
+
+    while (p < end && (p = (const char*) memchr(p, '<', end - p)) != NULL) {
+        const char* skip_to = NULL;
+        if (end - p >= 4 && memcmp(p, "<!--", 4) == 0) {
+            skip_to = find_text(p + 4, end, "-->");
+        } else if (end - p >= 9 && memcmp(p, "<![CDATA[", 9) == 0) {
+            skip_to = find_text(p + 9, end, "]]>");
+        } else if (end - p >= 2 && (p[1] == '?' || p[1] == '!' || p[1] == '/')) {
+            skip_to = (const char*) memchr(p, '>', end - p);
+        } else {
+            const char* close = find_tag_end(p + 1, end);
+            if (close == NULL) {
+                return -1;
+            }
+            const char* after = p + 1 + name_length;
+            if (after <= close && memcmp(p + 1, name, name_length) == 0 &&
+                (after == close || is_space(*after) || *after == '/')) {
+                tag->start = after;
+                tag->length = close - after;
+                *offset = (close + 1) - file->data;
+                return 0;
+            }
+            skip_to = close;
+        }
+        if (skip_to == NULL) {
+            return -1;
+        }
+        p = skip_to + 1;
+    }
+    return -1;
+}
+
+// Function to find an attribute's value inside a start tag
+int svg_attribute(const SvgSpan* tag, const char* name, SvgSpan* value)
+{
+    const char* p = tag->start;
+    const char* end = tag->start + tag->length;
+    size_t name_length = strlen(name);
+
+    while (p < end) {
+        while (p < end && (is_space(*p) || *p == '/')) {
+            p++;
+        }
+        const char* attr = p;
+        while (p < end && *p != '=' && !is_space(*p)) {
+            p++;
+        }
+        size_t attr_length = p - attr;
+        while (p < end && is_space(*p)) {
+            p++;
+        }
+        if (p >= end || *p != '=') {
+            continue;  // An attribute without a value (not valid XML, but not fatal either)
+        }
+        p++;
+        while (p < end && is_space(*p)) {
+            p++;
+        }
+        if (p >= end || (*p != '"' && *p != '\'')) {
+            return -1;
+        }
+        const char* close = (const char*) memchr(p + 1, *p, end - p - 1);
+        if (close == NULL) {
+            return -1;
+        }
+        if (attr_length == name_length && memcmp(attr, name, name_length) == 0) {
+            value->start = p + 1;
+            value->length = close - (p + 1);
+            return 0;
+        }
+        p = close + 1;
+    }
+    return -1;
+}
+
+// Function to copy a short attribute value out of the mapping
+int svg_attribute_copy(const SvgSpan* tag, const char* name, char* text, size_t size)
+{
+    SvgSpan value;
+    if (svg_attribute(tag, name, &value) == -1) {
+        return -1;
+    }
+    size_t length = value.length < size - 1 ? value.length : size - 1;
+    memcpy(text, value.start, length);
+    text[length] = '\0';
+    return 0;
+}
+
+// Function to parse one decimal number: the digits are gathered into an integer mantissa and
+// scaled once by an exact power of ten, which gives the correctly rounded double whenever the
+// mantissa and the power are both exact (up to 15 digits and 1e22); rarer inputs fall back
+// to long double scaling, still far finer than the float coordinates it feeds
+int svg_parse_number(const char** cursor, const char* end, double* value)
+{
+    const char* p = *cursor;
+    while (p < end && (is_space(*p) || *p == ',')) {
+        p++;
+    }
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0, seen_digit = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        seen_digit = 1;
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += (mantissa != 0);  // Leading zeros do not use up precision
+        } else {
+            exponent++;  // Digits past what fits only scale the value
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            seen_digit = 1;
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += (mantissa != 0);
+                exponent--;
+            }
+        }
+    }
+    if (!seen_digit) {
+        return -1;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        int exp_negative = 0, exp_value = 0;
+        if (e < end && (*e == '-' || *e == '+')) {
+            exp_negative = (*e == '-');
+            e++;
+        }
+        if (e < end && *e >= '0' && *e <= '9') {  // Otherwise the 'e' belongs to what follows
+            for (; e < end && *e >= '0' && *e <= '9'; e++) {
+                if (exp_value < 100000) {
+                    exp_value = exp_value * 10 + (*e - '0');
+                }
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = e;
+        }
+    }
+
+    double result;
+    if (mantissa == 0) {
+        result = 0.0;
+    } else if (mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        result = exponent < 0 ? (double)mantissa / exact_powers[-exponent]
+                              : (double)mantissa * exact_powers[exponent];
+    } else {
+        result = (double)((long double)mantissa * powl(10.0L, (long double)exponent));
+    }
+    *value = negative ? -result : result;
+    *cursor = p;
+    return 0;
+}
+
+// Function to parse a numeric attribute of a tag
+int svg_attribute_float(const SvgSpan* tag, const char* name, float* value)
+{
+    SvgSpan text;
+    if (svg_attribute(tag, name, &text) == -1) {
+        return -1;
+    }
+    const char* cursor = text.start;
+    double number;
+    if (svg_parse_number(&cursor, text.start + text.length, &number) == -1) {
+        return -1;
+    }
+    *value = (float)number;
+    return 0;
+}
+
+// Function to parse a points list of any length straight into an interleaved x,y array
+int svg_parse_points(const SvgSpan* value, float** xy)
+{
+    const char* cursor = value->start;
+    const char* end = value->start + value->length;
+    // "123.4,56.7 " is about 11 bytes a point; starting near that avoids most regrowth
+    size_t capacity = value->length / 5 + 8;
+    size_t count = 0;
+    float* numbers = (float*) malloc(capacity * sizeof(float));
+    if (numbers == NULL) {
+        printf("Error: Could not allocate %zu coordinates\n", capacity);
+        return -1;
+    }
+
+    for (;;) {
+        double number;
+        if (svg_parse_number(&cursor, end, &number) == -1) {
+            break;
+        }
+        if (count == capacity) {
+            float* grown = (float*) realloc(numbers, capacity * 2 * sizeof(float));
+            if (grown == NULL) {
+                printf("Error: Could not allocate %zu coordinates\n", capacity * 2);
+                free(numbers);
+                return -1;
+            }
+            numbers = grown;
+            capacity *= 2;
+        }
+        numbers[count++] = (float)number;
+    }
+    while (cursor < end && (is_space(*cursor) || *cursor == ',')) {
+        cursor++;
+    }
+    if (cursor != end) {
+        printf("Error: Invalid number in points list at offset %zu\n", (size_t)(cursor - value->start));
+        free(numbers);
+        return -1;
+    }
+    if (count % 2 != 0 || count / 2 > INT32_MAX) {
+        printf("Error: Points list has %zu coordinates, expected x,y pairs\n", count);
+        free(numbers);
+        return -1;
+    }
+    *xy = numbers;
+    return (int)(count / 2);
+}
+
+// Function to start reading a points list
+void svg_points_begin(const SvgSpan* value, SvgPointReader* reader)
+{
+    reader->start = value->start;
+    reader->cursor = value->start;
+    reader->end = value->start + value->length;
+}
+
+// Function to read the next point of a list
+int svg_points_next(SvgPointReader* reader, float* x, float* y)
+{
+    double px, py;
+    if (svg_parse_number(&reader->cursor, reader->end, &px) == -1) {
+        while (reader->cursor < reader->end && (is_space(*reader->cursor) || *reader->cursor == ',')) {
+            reader->cursor++;
+        }
+        if (reader->cursor == reader->end) {
+            return 0;
+        }
+        printf("Error: Invalid number in points list at offset %zu\n", (size_t)(reader->cursor - reader->start));
+        return -1;
+    }
+    if (svg_parse_number(&reader->cursor, reader->end, &py) == -1) {
+        printf("Error: Points list has an x without a y at offset %zu\n", (size_t)(reader->cursor - reader->start));
+        return -1;
+    }
+    *x = (float)px;
+    *y = (float)py;
+    return 1;
+}
+
+// Function to count the points of a list
+long long svg_count_points(const SvgSpan* value)
+{
+    SvgPointReader reader;
+    svg_points_begin(value, &reader);
+    long long count = 0;
+    float x, y;
+    int status;
+    while ((status = svg_points_next(&reader, &x, &y)) == 1) {
+        count++;
+    }
+    return status == 0 ? count : -1;
+}
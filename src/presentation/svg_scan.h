@@ -0,0 +1,63 @@
+#ifndef SVG_SCAN_H
+#define SVG_SCAN_H
+
+#include <stddef.h>
+
+// Define a memory-mapped SVG file; nothing is copied out of it while scanning
+typedef struct {
+    const char* data;
+    size_t length;
+} SvgFile;
+
+// Define a piece of the mapped file (a tag or an attribute value), not NUL-terminated
+typedef struct {
+    const char* start;
+    size_t length;
+} SvgSpan;
+
+// Define a cursor that walks a points list one point at a time, storing nothing
+typedef struct {
+    const char* start;
+    const char* cursor;
+    const char* end;
+} SvgPointReader;
+
+// Map a file read-only, returns 0 on success and -1 on failure
+int svg_file_map(const char* path, SvgFile* file);
+
+// Unmap a file
+void svg_file_unmap(SvgFile* file);
+
+// Find the next <name ...> start tag at or after *offset (comments and CDATA are skipped).
+// tag receives the text between the name and the closing '>'; *offset moves past the tag.
+// Returns 0 when found and -1 otherwise
+int svg_find_element(const SvgFile* file, const char* name, size_t* offset, SvgSpan* tag);
+
+// Find an attribute in a tag found by svg_find_element, returns 0 when present and -1 otherwise
+int svg_attribute(const SvgSpan* tag, const char* name, SvgSpan* value);
+
+// Copy a short attribute value into a NUL-terminated string (truncated to size - 1 characters).
+// Returns 0 when the attribute is present and -1 otherwise
+int svg_attribute_copy(const SvgSpan* tag, const char* name, char* text, size_t size);
+
+// Parse one number (locale independent, exact for the common short decimals) at *cursor,
+// skipping leading whitespace and commas; *cursor moves past it. Returns 0 or -1 if none
+int svg_parse_number(const char** cursor, const char* end, double* value);
+
+// Parse a numeric attribute, returns 0 on success and -1 when it is missing or not a number
+int svg_attribute_float(const SvgSpan* tag, const char* name, float* value);
+
+// Parse a whole "x,y x,y ..." list of any length into a malloc'ed interleaved array.
+// Returns the number of points, or -1 on failure (odd number count or out of memory)
+int svg_parse_points(const SvgSpan* value, float** xy);
+
+// Start reading a points list from its first point
+void svg_points_begin(const SvgSpan* value, SvgPointReader* reader);
+
+// Read the next point, returns 1 when a point was read, 0 at the end of the list and -1 if it is malformed
+int svg_points_next(SvgPointReader* reader, float* x, float* y);
+
+// Count the points of a list without storing them, returns -1 if it is malformed
+long long svg_count_points(const SvgSpan* value);
+
+#endif
@@ -3,6 +3,12 @@ from scipy.spatial import Delaunay
 from svgpathtools import svg2paths2, wsvg
 import os
 
+# Use the C morph engine when libmorph_engine.so has been built, NumPy otherwise
+try:
+    from morph_engine import MorphEngine
+except (ImportError, OSError):
+    MorphEngine = None
+
 # Function to extract critical points from an SVG
 def extract_points_from_svg(svg_filename, num_points=20):
     """Extract meaningful points from an SVG by sampling along the path."""
@@ -43,10 +49,9 @@ def interpolate_points(source_points, target_points, alpha):
     return (1 - alpha) * source_points + alpha * target_points
 
 # Generate intermediate SVG frames
-def generate_intermediate_svg(alpha, frame_number, output_dir, source_points, target_points, triangles):
-    """Generate and save intermediate SVG for a given alpha (0 to 1)."""
-    interpolated_points = interpolate_points(source_points, target_points, alpha)
-    
+def generate_intermediate_svg(frame_number, output_dir, interpolated_points, triangles):
+    """Generate and save intermediate SVG for one frame's interpolated points."""
+
     # Open an SVG file for writing
     frame_filename = os.path.join(output_dir, f'frame_{frame_number:03d}.svg')
     with open(frame_filename, 'w') as f:
@@ -82,9 +87,15 @@ def morph_images(chef_svg_file, donut_svg_file, steps=30, output_dir='./morph_fr
     if not os.path.exists(output_dir):
         os.makedirs(output_dir)
     
+    # Interpolate every frame up front, in C when the engine is available
+    if MorphEngine is not None:
+        frames = MorphEngine(chef_points, donut_points).frames(steps)
+    else:
+        frames = [interpolate_points(chef_points, donut_points, alpha) for alpha in np.linspace(0, 1, num=steps)]
+
     # Generate and save frames
-    for i, alpha in enumerate(np.linspace(0, 1, num=steps)):
-        generate_intermediate_svg(alpha, i, output_dir, chef_points, donut_points, tri.simplices)
+    for i, interpolated_points in enumerate(frames):
+        generate_intermediate_svg(i, output_dir, interpolated_points, tri.simplices)
 
 # Paths to SVG files
 chef_svg_file = '../../svg/chef.svg'
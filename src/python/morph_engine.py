@@ -0,0 +1,160 @@
+import ctypes
+import os
+import weakref
+import numpy as np
+
+# Python binding for the C morph engine (src/presentation/morph_engine.c).
+# Build the shared library once from src/presentation:
+#   gcc -O2 -fPIC -shared -fopenmp -o libmorph_engine.so morph_engine.c svg_scan.c point_index.c arena.c polygon.c -lm
+# ctypes drops the GIL for the duration of every call into the library, so other
+# Python threads keep running while frames are being computed.
+
+_float_p = ctypes.POINTER(ctypes.c_float)
+_int_p = ctypes.POINTER(ctypes.c_int)
+
+
+# Function to find and load libmorph_engine.so (override with MORPH_ENGINE_LIB)
+def _load_library():
+    path = os.environ.get('MORPH_ENGINE_LIB')
+    if path is None:
+        script_dir = os.path.dirname(os.path.abspath(__file__))
+        path = os.path.join(script_dir, '..', 'presentation', 'libmorph_engine.so')
+    lib = ctypes.CDLL(os.path.abspath(path))
+
+    lib.morph_plan_create.restype = ctypes.c_void_p
+    lib.morph_plan_create.argtypes = [ctypes.c_int, _float_p, _float_p, _float_p]
+    lib.morph_plan_circle_to_triangle.restype = ctypes.c_void_p
+    lib.morph_plan_circle_to_triangle.argtypes = [ctypes.c_float, ctypes.c_float, ctypes.c_float,
+                                                  ctypes.c_float * 2 * 3, ctypes.c_int]
+    lib.morph_plan_destroy.restype = None
+    lib.morph_plan_destroy.argtypes = [ctypes.c_void_p]
+    lib.morph_plan_evaluate.restype = None
+    lib.morph_plan_evaluate.argtypes = [ctypes.c_void_p, ctypes.c_float, _float_p, _float_p]
+    lib.morph_frames_alloc.restype = ctypes.c_void_p
+    lib.morph_frames_alloc.argtypes = [ctypes.c_int, ctypes.c_int]
+    lib.morph_frames_free.restype = None
+    lib.morph_frames_free.argtypes = [ctypes.c_void_p]
+    lib.morph_plan_render.restype = ctypes.c_int
+    lib.morph_plan_render.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+    lib.extract_circle_info.restype = ctypes.c_int
+    lib.extract_circle_info.argtypes = [ctypes.c_char_p, _float_p, _float_p, _float_p]
+    lib.extract_triangle_info.restype = ctypes.c_int
+    lib.extract_triangle_info.argtypes = [ctypes.c_char_p, ctypes.c_float * 2 * 3]
+    lib.point_index_build.restype = ctypes.c_void_p
+    lib.point_index_build.argtypes = [_float_p, ctypes.c_int]
+    lib.point_index_destroy.restype = None
+    lib.point_index_destroy.argtypes = [ctypes.c_void_p]
+    lib.point_index_nearest_all.restype = None
+    lib.point_index_nearest_all.argtypes = [ctypes.c_void_p, _float_p, ctypes.c_int, _int_p, _float_p]
+    lib.point_match_unique.restype = ctypes.c_int
+    lib.point_match_unique.argtypes = [_float_p, ctypes.c_int, _float_p, ctypes.c_int, _int_p]
+    return lib
+
+
+_lib = _load_library()
+
+
+# Function to turn an (N, 2) array-like into a contiguous float32 array and its pointer
+def _as_points(points):
+    array = np.ascontiguousarray(points, dtype=np.float32).reshape(-1, 2)
+    return array, array.ctypes.data_as(_float_p)
+
+
+class MorphEngine:
+    """A morph plan living in the C engine: each point follows a quadratic Bézier curve
+    from its source to its target position (a straight line when no controls are given)."""
+
+    def __init__(self, source_points, target_points, control_points=None, _plan=None, _num_points=None):
+        if _plan is not None:
+            self._plan = _plan
+            self.num_points = _num_points
+        else:
+            source, source_p = _as_points(source_points)
+            target, target_p = _as_points(target_points)
+            if len(source) != len(target):
+                raise ValueError("source and target need the same number of points")
+            control_p = None
+            if control_points is not None:
+                control, control_p = _as_points(control_points)
+                if len(control) != len(source):
+                    raise ValueError("control points must match the number of source points")
+            self.num_points = len(source)
+            self._plan = _lib.morph_plan_create(self.num_points, source_p, control_p, target_p)
+        if not self._plan:
+            raise MemoryError("could not create morph plan")
+        self._finalizer = weakref.finalize(self, _lib.morph_plan_destroy, self._plan)
+
+    @classmethod
+    def circle_to_triangle(cls, circle_svg, triangle_svg, num_points=30):
+        """Same morph as circle-to-triangle.c, loaded from the two SVG files."""
+        cx, cy, r = ctypes.c_float(), ctypes.c_float(), ctypes.c_float()
+        triangle = (ctypes.c_float * 2 * 3)()
+        if _lib.extract_circle_info(circle_svg.encode(), ctypes.byref(cx), ctypes.byref(cy), ctypes.byref(r)) != 0:
+            raise ValueError(f"Could not extract circle info from {circle_svg}")
+        if _lib.extract_triangle_info(triangle_svg.encode(), triangle) != 0:
+            raise ValueError(f"Could not extract triangle info from {triangle_svg}")
+        plan = _lib.morph_plan_circle_to_triangle(cx, cy, r, triangle, num_points)
+        return cls(None, None, _plan=plan, _num_points=num_points)
+
+    def frame(self, t, out=None):
+        """Points of the shape at factor t as an (N, 2) array written directly by the engine.
+
+        The array is a transposed view of x and y rows. Pass the array an earlier call returned
+        as out to reuse it, so a frame loop allocates nothing per frame; a contiguous (2, N)
+        float32 array of rows is taken as well."""
+        if out is None:
+            out = np.empty((2, self.num_points), dtype=np.float32)
+        elif out.shape == (self.num_points, 2) and out.flags.f_contiguous:
+            out = out.T  # An earlier result: back to its x and y rows
+        if out.shape != (2, self.num_points) or out.dtype != np.float32 or not out.flags.c_contiguous:
+            raise ValueError("out must be an earlier frame() result or a contiguous (2, N) float32 array")
+        _lib.morph_plan_evaluate(self._plan, t, out[0].ctypes.data_as(_float_p), out[1].ctypes.data_as(_float_p))
+        return out.T
+
+    def frames(self, total_frames, first=0, count=None):
+        """Frames [first, first + count) of a total_frames animation as a (count, N, 2) array.
+
+        The array is a view of memory allocated by the engine; no copy is made. The engine
+        buffer is released when the last array referring to it is garbage collected."""
+        if count is None:
+            count = total_frames - first
+        if total_frames < 2 or first < 0 or count <= 0 or first + count > total_frames:
+            raise ValueError(f"frames {first} to {first + count - 1} are outside {total_frames} frames")
+        address = _lib.morph_frames_alloc(count, self.num_points)
+        if not address:
+            raise MemoryError(f"could not allocate {count} frames")
+        holder = (ctypes.c_float * (count * self.num_points * 2)).from_address(address)
+        weakref.finalize(holder, _lib.morph_frames_free, address)
+        if _lib.morph_plan_render(self._plan, first, count, total_frames, address) != 0:
+            raise ValueError("invalid frame range")
+        return np.frombuffer(holder, dtype=np.float32).reshape(count, self.num_points, 2)
+
+    def close(self):
+        self._finalizer()
+
+
+def nearest_points(reference_points, query_points):
+    """Index of the nearest reference point for every query point, and the distances,
+    answered by a k-d tree in the engine (queries run in parallel)."""
+    reference, reference_p = _as_points(reference_points)
+    queries, queries_p = _as_points(query_points)
+    index = _lib.point_index_build(reference_p, len(reference))
+    if not index:
+        raise MemoryError("could not build the point index")
+    nearest = np.empty(len(queries), dtype=np.int32)
+    distance2 = np.empty(len(queries), dtype=np.float32)
+    _lib.point_index_nearest_all(index, queries_p, len(queries), nearest.ctypes.data_as(_int_p),
+                                 distance2.ctypes.data_as(_float_p))
+    _lib.point_index_destroy(index)
+    return nearest, np.sqrt(distance2)
+
+
+def match_points(source_points, target_points):
+    """Pair every source point with a different target point (len(source) <= len(target)),
+    nearest pairs first; returns the target index of each source point."""
+    source, source_p = _as_points(source_points)
+    target, target_p = _as_points(target_points)
+    match = np.empty(len(source), dtype=np.int32)
+    if _lib.point_match_unique(source_p, len(source), target_p, len(target), match.ctypes.data_as(_int_p)) != 0:
+        raise ValueError("source has more points than target")
+    return match